@@ -0,0 +1,673 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <afina/metrics/Histogram.h>
+
+#include "ZipfGenerator.h"
+
+using Afina::Bench::ZipfGenerator;
+using Afina::Metrics::Histogram;
+
+namespace {
+
+// Time to wait for responses to requests sent before the end of the run
+const uint64_t drain_ns = 1000000000;
+
+// Parsed part of the input buffer is cut off once it grows that large
+const std::size_t compact_size = 64 << 10;
+
+uint64_t Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Inclusive range of sizes, parsed from "<size>" or "<min>-<max>"
+struct SizeRange {
+    std::size_t min;
+    std::size_t max;
+
+    static SizeRange Parse(const std::string &text, const char *name) {
+        SizeRange range;
+        char tail;
+        int n = sscanf(text.c_str(), "%zu-%zu%c", &range.min, &range.max, &tail);
+        if (n == 1) {
+            range.max = range.min;
+        } else if (n != 2 || range.min > range.max) {
+            throw std::runtime_error(std::string("Bad ") + name + ": " + text);
+        }
+        return range;
+    }
+};
+
+struct Config {
+    struct addrinfo *address;
+
+    unsigned threads;
+    unsigned connections;
+    unsigned pipeline;
+
+    // Requests per second over all threads, 0 for closed loop
+    double rate;
+
+    double warmup;
+    double duration;
+
+    std::size_t keys;
+    double zipf;
+    SizeRange key_size;
+    SizeRange value_size;
+    int get_percent;
+    bool prefill;
+};
+
+// Results of the single thread, merged once threads are done
+struct Result {
+    Histogram get;
+    Histogram set;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t errors = 0;
+
+    // Requests of open loop schedule that never were sent since all connections were busy
+    uint64_t unsent = 0;
+
+    // Requests left without response when the run is over
+    uint64_t unanswered = 0;
+
+    // Connections lost in the middle of the run
+    uint64_t broken = 0;
+};
+
+/**
+ * # Load generator thread
+ * Owns its share of connections and serves them with epoll. Each connection keeps up to pipeline requests in
+ * flight, responses are matched with requests in order.
+ *
+ * Closed loop: new request is sent as soon as previous one completes, so the rate is whatever server sustains.
+ *
+ * Open loop: requests are scheduled at fixed intervals regardless of responses. Latency is measured from the time
+ * request was scheduled, not sent: if all connections are busy, request waits and waiting counts. Otherwise stalled
+ * server would hold back the generator and hide its own stall (coordinated omission)
+ */
+class Worker {
+public:
+    Worker(const Config &config, unsigned index, unsigned connections)
+        : _config(config), _index(index), _rng(index + 1), _zipf(config.keys, config.zipf > 0 ? config.zipf : 0.5),
+          _value(config.value_size.max, 'x'), _epoll(-1), _inflight(0), _measure_from(0), _end(0) {
+        _epoll = epoll_create1(0);
+        if (_epoll < 0) {
+            throw std::runtime_error("Failed to create epoll: " + std::string(strerror(errno)));
+        }
+
+        for (unsigned i = 0; i < connections; i++) {
+            Connect();
+        }
+    }
+
+    ~Worker() {
+        for (auto &conn : _connections) {
+            if (conn.fd >= 0) {
+                close(conn.fd);
+            }
+        }
+        close(_epoll);
+    }
+
+    /**
+     * Sets every key of the share of this worker
+     */
+    void Prefill() {
+        std::size_t next = _index;
+        while (next < _config.keys || _inflight > 0) {
+            for (auto &conn : _connections) {
+                while (conn.fd >= 0 && conn.inflight.size() < _config.pipeline && next < _config.keys) {
+                    Send(conn, false, next, 0);
+                    next += _config.threads;
+                }
+            }
+
+            if (!Poll(100) && _inflight == 0 && next < _config.keys) {
+                throw std::runtime_error("All connections are lost");
+            }
+        }
+    }
+
+    /**
+     * Runs load starting at the given time
+     */
+    void Run(uint64_t start) {
+        _measure_from = start + uint64_t(_config.warmup * 1e9);
+        _end = _measure_from + uint64_t(_config.duration * 1e9);
+
+        // Requests scheduled and sent so far by open loop, intended start of request k is start + k * interval
+        uint64_t interval = _config.rate > 0 ? uint64_t(1e9 * _config.threads / _config.rate) : 0;
+        uint64_t scheduled = 0, sent = 0;
+        std::size_t next_conn = 0;
+
+        uint64_t now = Now();
+        while (now < _end || (_inflight > 0 && now < _end + drain_ns)) {
+            int timeout = 100;
+            if (interval == 0) {
+                for (auto &conn : _connections) {
+                    while (now < _end && conn.fd >= 0 && conn.inflight.size() < _config.pipeline) {
+                        Send(conn, now);
+                    }
+                }
+            } else {
+                while (now < _end && start + scheduled * interval <= now) {
+                    scheduled++;
+                }
+
+                // Round robin over connections having free slots
+                for (std::size_t checked = 0; sent < scheduled && checked < _connections.size();) {
+                    Connection &conn = _connections[next_conn];
+                    if (conn.fd >= 0 && conn.inflight.size() < _config.pipeline) {
+                        Send(conn, start + sent * interval);
+                        sent++;
+                        checked = 0;
+                    } else {
+                        checked++;
+                    }
+                    next_conn = (next_conn + 1) % _connections.size();
+                }
+
+                if (now < _end) {
+                    timeout = std::min<uint64_t>(timeout, (start + scheduled * interval - now) / 1000000);
+                }
+            }
+
+            if (!Poll(timeout) && _inflight == 0) {
+                break;
+            }
+            now = Now();
+        }
+
+        // Requests scheduled for measured window but not sent at all
+        for (uint64_t k = sent; k < scheduled; k++) {
+            if (start + k * interval >= _measure_from) {
+                _result.unsent++;
+            }
+        }
+
+        for (auto &conn : _connections) {
+            for (const Request &request : conn.inflight) {
+                if (request.start >= _measure_from && request.start < _end) {
+                    _result.unanswered++;
+                }
+            }
+        }
+    }
+
+    Result &result() { return _result; }
+
+private:
+    struct Request {
+        bool get;
+        uint64_t start;
+    };
+
+    struct Connection {
+        int fd;
+
+        // Requests not written yet and position of the first unwritten byte
+        std::string out;
+        std::size_t written;
+
+        // Responses read and position of the first unparsed byte
+        std::string in;
+        std::size_t parsed;
+
+        // Get response seen value block already
+        bool found;
+
+        bool want_out;
+        std::deque<Request> inflight;
+    };
+
+    void Connect() {
+        int fd = socket(_config.address->ai_family, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+        }
+
+        if (connect(fd, _config.address->ai_addr, _config.address->ai_addrlen) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Failed to connect: " + std::string(strerror(error)));
+        }
+
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Failed to make socket non blocking: " + std::string(strerror(error)));
+        }
+
+        _connections.emplace_back();
+        Connection &conn = _connections.back();
+        conn.fd = fd;
+        conn.written = 0;
+        conn.parsed = 0;
+        conn.found = false;
+        conn.want_out = false;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = _connections.size() - 1;
+        if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            throw std::runtime_error("Failed to add socket to epoll: " + std::string(strerror(errno)));
+        }
+    }
+
+    // Sends request of the configured mix
+    void Send(Connection &conn, uint64_t start) {
+        bool get = std::uniform_int_distribution<int>(0, 99)(_rng) < _config.get_percent;
+        std::size_t key;
+        if (_config.zipf > 0) {
+            key = _zipf.Scramble(_zipf(_rng));
+        } else {
+            key = std::uniform_int_distribution<std::size_t>(0, _config.keys - 1)(_rng);
+        }
+        Send(conn, get, key, start);
+    }
+
+    void Send(Connection &conn, bool get, std::size_t key, uint64_t start) {
+        // Key length is derived from the key itself, so the same key always looks the same
+        char name[256];
+        std::size_t spread = _config.key_size.max - _config.key_size.min + 1;
+        std::size_t key_len = _config.key_size.min + (key * 0x9E3779B97F4A7C15ull >> 32) % spread;
+        int digits = snprintf(name, sizeof(name), "%0*zu", int(key_len), key);
+
+        if (get) {
+            conn.out.append("get ").append(name, digits).append("\r\n");
+        } else {
+            std::size_t size = std::uniform_int_distribution<std::size_t>(_config.value_size.min,
+                                                                          _config.value_size.max)(_rng);
+            conn.out.append("set ").append(name, digits).append(" 0 0 ").append(std::to_string(size)).append("\r\n");
+            conn.out.append(_value, 0, size).append("\r\n");
+        }
+
+        conn.inflight.push_back(Request{get, start});
+        _inflight++;
+        Write(conn);
+    }
+
+    // Waits for events up to timeout ms and handles them. Returns false if there are no live connections
+    bool Poll(int timeout) {
+        struct epoll_event events[64];
+        int n = epoll_wait(_epoll, events, 64, timeout);
+        if (n < 0 && errno != EINTR) {
+            throw std::runtime_error("Failed to wait for events: " + std::string(strerror(errno)));
+        }
+
+        for (int i = 0; i < n; i++) {
+            Connection &conn = _connections[events[i].data.u64];
+            if (conn.fd >= 0 && (events[i].events & EPOLLOUT)) {
+                Write(conn);
+            }
+            if (conn.fd >= 0 && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                Read(conn);
+            }
+        }
+
+        return std::any_of(_connections.begin(), _connections.end(), [](const Connection &c) { return c.fd >= 0; });
+    }
+
+    void Write(Connection &conn) {
+        while (conn.written < conn.out.size()) {
+            ssize_t n = send(conn.fd, conn.out.data() + conn.written, conn.out.size() - conn.written, MSG_NOSIGNAL);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (n < 0) {
+                Break(conn);
+                return;
+            }
+            conn.written += n;
+        }
+
+        if (conn.written == conn.out.size()) {
+            conn.out.clear();
+            conn.written = 0;
+        }
+
+        bool want_out = !conn.out.empty();
+        if (want_out != conn.want_out) {
+            struct epoll_event ev;
+            ev.events = EPOLLIN | (want_out ? uint32_t(EPOLLOUT) : 0u);
+            ev.data.u64 = &conn - _connections.data();
+            epoll_ctl(_epoll, EPOLL_CTL_MOD, conn.fd, &ev);
+            conn.want_out = want_out;
+        }
+    }
+
+    void Read(Connection &conn) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                conn.in.append(buffer, n);
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                Parse(conn);
+                Break(conn);
+                return;
+            }
+        }
+        Parse(conn);
+    }
+
+    // Matches complete responses with requests in flight
+    void Parse(Connection &conn) {
+        while (!conn.inflight.empty()) {
+            std::size_t eol = conn.in.find("\r\n", conn.parsed);
+            if (eol == std::string::npos) {
+                break;
+            }
+
+            const char *line = conn.in.data() + conn.parsed;
+            std::size_t len = eol - conn.parsed;
+            const Request &request = conn.inflight.front();
+            if (request.get && len > 6 && memcmp(line, "VALUE ", 6) == 0) {
+                // Value block follows the header line, wait until it is here completely
+                const char *size = static_cast<const char *>(memrchr(line, ' ', len)) + 1;
+                std::size_t next = eol + 2 + strtoull(size, nullptr, 10) + 2;
+                if (next > conn.in.size()) {
+                    break;
+                }
+                conn.parsed = next;
+                conn.found = true;
+                continue;
+            }
+
+            bool ok;
+            if (request.get) {
+                ok = len == 3 && memcmp(line, "END", 3) == 0;
+            } else {
+                ok = len == 6 && memcmp(line, "STORED", 6) == 0;
+            }
+            conn.parsed = eol + 2;
+            Complete(request, ok, conn.found);
+            conn.found = false;
+            conn.inflight.pop_front();
+            _inflight--;
+        }
+
+        if (conn.parsed == conn.in.size()) {
+            conn.in.clear();
+            conn.parsed = 0;
+        } else if (conn.parsed > compact_size) {
+            conn.in.erase(0, conn.parsed);
+            conn.parsed = 0;
+        }
+    }
+
+    void Complete(const Request &request, bool ok, bool found) {
+        if (request.start < _measure_from || request.start >= _end) {
+            return;
+        }
+
+        uint64_t latency = Now() - request.start;
+        if (!ok) {
+            _result.errors++;
+        } else if (request.get) {
+            _result.get.Record(latency);
+            (found ? _result.hits : _result.misses)++;
+        } else {
+            _result.set.Record(latency);
+        }
+    }
+
+    // Drops connection, requests in flight are counted as errors
+    void Break(Connection &conn) {
+        for (const Request &request : conn.inflight) {
+            Complete(request, false, false);
+        }
+        _inflight -= conn.inflight.size();
+        conn.inflight.clear();
+
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, conn.fd, nullptr);
+        close(conn.fd);
+        conn.fd = -1;
+        _result.broken++;
+    }
+
+    const Config &_config;
+    const unsigned _index;
+
+    std::mt19937_64 _rng;
+    ZipfGenerator _zipf;
+
+    // Source of value bytes
+    const std::string _value;
+
+    int _epoll;
+    std::vector<Connection> _connections;
+    std::size_t _inflight;
+
+    // Requests started within [_measure_from, _end) are measured
+    uint64_t _measure_from;
+    uint64_t _end;
+
+    Result _result;
+};
+
+void PrintLatency(const char *name, const Histogram &h) {
+    if (h.Count() == 0) {
+        return;
+    }
+
+    printf("%-8s %10llu %10.1f", name, (unsigned long long)h.Count(), h.Mean() / 1000);
+    for (double p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+        printf(" %10.1f", h.Percentile(p) / 1000.0);
+    }
+    printf(" %10.1f\n", h.Max() / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("afina-bench", "Load generator for memcached protocol servers");
+    try {
+        options.add_options()("host", "Server host", cxxopts::value<std::string>()->default_value("127.0.0.1"));
+        options.add_options()("port", "Server port", cxxopts::value<std::string>()->default_value("8080"));
+        options.add_options()("t,threads", "Number of threads", cxxopts::value<unsigned>()->default_value("1"));
+        options.add_options()("c,connections", "Number of connections over all threads",
+                              cxxopts::value<unsigned>()->default_value("1"));
+        options.add_options()("pipeline", "Requests in flight per connection",
+                              cxxopts::value<unsigned>()->default_value("1"));
+        options.add_options()("rate", "Requests per second for open loop, closed loop if not given",
+                              cxxopts::value<double>()->default_value("0"));
+        options.add_options()("warmup", "Seconds of load before measurement",
+                              cxxopts::value<double>()->default_value("1"));
+        options.add_options()("d,duration", "Seconds of measured load", cxxopts::value<double>()->default_value("10"));
+        options.add_options()("keys", "Number of distinct keys", cxxopts::value<std::size_t>()->default_value("10000"));
+        options.add_options()("zipf", "Skew of zipfian key popularity in (0, 1), uniform if not given",
+                              cxxopts::value<double>()->default_value("0"));
+        options.add_options()("key-size", "Key size: <size> or <min>-<max>",
+                              cxxopts::value<std::string>()->default_value("16"));
+        options.add_options()("value-size", "Value size: <size> or <min>-<max>",
+                              cxxopts::value<std::string>()->default_value("32"));
+        options.add_options()("get", "Percent of get requests, the rest are sets",
+                              cxxopts::value<int>()->default_value("90"));
+        options.add_options()("prefill", "Set every key once before the load");
+        options.add_options()("h,help", "Print usage info");
+        options.parse(argc, argv);
+
+        if (options.count("help") > 0) {
+            std::cerr << options.help() << std::endl;
+            return 0;
+        }
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    Config config;
+    std::unique_ptr<struct addrinfo, void (*)(struct addrinfo *)> address(nullptr, freeaddrinfo);
+    try {
+        config.threads = options["threads"].as<unsigned>();
+        config.connections = options["connections"].as<unsigned>();
+        config.pipeline = options["pipeline"].as<unsigned>();
+        config.rate = options["rate"].as<double>();
+        config.warmup = options["warmup"].as<double>();
+        config.duration = options["duration"].as<double>();
+        config.keys = options["keys"].as<std::size_t>();
+        config.zipf = options["zipf"].as<double>();
+        config.key_size = SizeRange::Parse(options["key-size"].as<std::string>(), "key size");
+        config.value_size = SizeRange::Parse(options["value-size"].as<std::string>(), "value size");
+        config.get_percent = options["get"].as<int>();
+        config.prefill = options.count("prefill") > 0;
+
+        if (config.threads == 0 || config.connections < config.threads || config.pipeline == 0) {
+            throw std::runtime_error("Each thread needs at least one connection and pipeline depth at least 1");
+        } else if (config.keys == 0 || config.zipf < 0 || config.zipf >= 1) {
+            throw std::runtime_error("Key space must be non empty and zipf skew in [0, 1)");
+        } else if (config.key_size.min == 0 || config.key_size.max > 250) {
+            throw std::runtime_error("Key size must be in [1, 250]");
+        } else if (config.get_percent < 0 || config.get_percent > 100 || config.rate < 0 || config.duration <= 0) {
+            throw std::runtime_error("Get percent must be in [0, 100], rate and duration positive");
+        }
+
+        struct addrinfo hints, *result;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        std::string host = options["host"].as<std::string>();
+        int error = getaddrinfo(host.c_str(), options["port"].as<std::string>().c_str(), &hints, &result);
+        if (error != 0) {
+            throw std::runtime_error("Failed to resolve " + host + ": " + gai_strerror(error));
+        }
+        address.reset(result);
+        config.address = result;
+    } catch (std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    // Connections are split between threads as evenly as possible
+    std::vector<std::unique_ptr<Worker>> workers;
+    try {
+        for (unsigned i = 0; i < config.threads; i++) {
+            unsigned connections = config.connections / config.threads + (i < config.connections % config.threads);
+            workers.emplace_back(new Worker(config, i, connections));
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    // Threads prefill their shares and start load at the same moment once everybody is done
+    std::atomic<unsigned> ready(0);
+    std::atomic<uint64_t> start(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    for (auto &worker : workers) {
+        Worker *w = worker.get();
+        threads.emplace_back([w, &config, &ready, &start, &failed]() {
+            try {
+                if (config.prefill) {
+                    w->Prefill();
+                }
+            } catch (std::exception &ex) {
+                std::cerr << "Error: " << ex.what() << std::endl;
+                failed = true;
+            }
+
+            if (++ready == config.threads) {
+                start = Now();
+            }
+            while (start.load() == 0) {
+                std::this_thread::yield();
+            }
+
+            try {
+                if (!failed) {
+                    w->Run(start.load());
+                }
+            } catch (std::exception &ex) {
+                std::cerr << "Error: " << ex.what() << std::endl;
+                failed = true;
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    if (failed) {
+        return 1;
+    }
+
+    Result total;
+    for (auto &worker : workers) {
+        Result &r = worker->result();
+        total.get.Merge(r.get);
+        total.set.Merge(r.set);
+        total.hits += r.hits;
+        total.misses += r.misses;
+        total.errors += r.errors;
+        total.unsent += r.unsent;
+        total.unanswered += r.unanswered;
+        total.broken += r.broken;
+    }
+    Histogram all;
+    all.Merge(total.get);
+    all.Merge(total.set);
+
+    printf("%u threads, %u connections, pipeline %u, ", config.threads, config.connections, config.pipeline);
+    if (config.rate > 0) {
+        printf("open loop at %.0f requests/s, ", config.rate);
+    } else {
+        printf("closed loop, ");
+    }
+    printf("%.1fs measured after %.1fs warmup\n\n", config.duration, config.warmup);
+
+    printf("throughput   %.0f requests/s\n", all.Count() / config.duration);
+    if (total.hits + total.misses > 0) {
+        printf("hit rate     %.4f\n", double(total.hits) / (total.hits + total.misses));
+    }
+    printf("errors       %llu\n", (unsigned long long)total.errors);
+    if (config.rate > 0) {
+        printf("unsent       %llu\n", (unsigned long long)total.unsent);
+    }
+    if (total.unanswered > 0) {
+        printf("unanswered   %llu\n", (unsigned long long)total.unanswered);
+    }
+    if (total.broken > 0) {
+        printf("broken       %llu connections\n", (unsigned long long)total.broken);
+    }
+
+    printf("\n%-8s %10s %10s %10s %10s %10s %10s %10s %10s\n", "us", "count", "mean", "p50", "p90", "p99", "p99.9",
+           "p99.99", "max");
+    PrintLatency("get", total.get);
+    PrintLatency("set", total.set);
+    PrintLatency("all", all);
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <afina/Storage.h>
+
+#include "storage/ClockCache.h"
+#include "storage/EpochHashCache.h"
+#include "storage/FlatCombineLRU.h"
+#include "storage/MmapStorage.h"
+#include "storage/RWLockLRU.h"
+#include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+#include "ZipfGenerator.h"
+
+using namespace Afina::Backend;
+using Afina::Bench::ZipfGenerator;
+
+namespace {
+
+// Command line settings, see Usage()
+std::size_t key_space = 100000;
+double zipf_theta = 0.99;
+unsigned max_threads = 0;
+
+// Share of operations in scan mixed load which go over the key space sequentially
+const int scan_percent = 10;
+
+enum class Distribution { Uniform, Zipf, ScanMixed };
+
+struct Backend {
+    const char *name;
+    std::function<std::shared_ptr<Afina::Storage>(std::size_t capacity)> make;
+
+    // Backend allows concurrent access
+    bool concurrent;
+};
+
+std::string MmapPath() { return "/dev/shm/afina_bench_" + std::to_string(getpid()); }
+
+std::vector<Backend> Backends() {
+    return {
+        {"st_lru", [](std::size_t size) { return std::make_shared<SimpleLRU>(size); }, false},
+        {"mt_lru", [](std::size_t size) { return std::make_shared<ThreadSafeSimplLRU>(size); }, true},
+        {"fc_lru", [](std::size_t size) { return std::make_shared<FlatCombineLRU>(size); }, true},
+        {"rw_lru", [](std::size_t size) { return std::make_shared<RWLockLRU>(size); }, true},
+        {"mt_clock", [](std::size_t size) { return std::make_shared<ClockCache>(size); }, true},
+        {"mt_epoch", [](std::size_t size) { return std::make_shared<EpochHashCache>(size); }, true},
+        {"mmap",
+         [](std::size_t size) {
+             // File left by the previous run would be reused with all its contents. Extra room is for the header
+             // and partially filled pages
+             unlink(MmapPath().c_str());
+             return std::make_shared<MmapStorage>(MmapPath(), size + (2 << 20));
+         },
+         true},
+    };
+}
+
+// Keys are formatted once, so that benchmark measures storage and not snprintf
+const std::vector<std::string> &Keys() {
+    static std::vector<std::string> keys;
+    if (keys.empty()) {
+        char buf[32];
+        for (std::size_t i = 0; i < key_space; i++) {
+            snprintf(buf, sizeof(buf), "key:%010zu", i);
+            keys.emplace_back(buf);
+        }
+    }
+    return keys;
+}
+
+// Storage shared by threads of the current run, created and destroyed by thread 0
+std::shared_ptr<Afina::Storage> storage;
+
+/**
+ * Runs one operation per iteration, arguments are value size and percent of reads. Read miss is followed by
+ * write of the key, as cache-aside client would do, so hit rate reflects how well eviction fits distribution
+ */
+void Run(benchmark::State &state, const Backend &backend, Distribution distribution) {
+    const std::size_t value_size = state.range(0);
+    const int read_percent = state.range(1);
+    const std::vector<std::string> &keys = Keys();
+
+    if (state.thread_index() == 0) {
+        // Cache holds half of the key space, the rest has to be evicted
+        std::size_t capacity = key_space * (keys[0].size() + value_size) / 2;
+        storage = backend.make(capacity);
+        storage->Start();
+
+        std::string value(value_size, 'v');
+        for (std::size_t i = 0; i < key_space; i++) {
+            storage->Put(keys[i], value);
+        }
+    }
+
+    std::mt19937_64 rng(state.thread_index() + 1);
+    std::uniform_int_distribution<std::size_t> uniform(0, key_space - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    ZipfGenerator zipf(key_space, zipf_theta);
+    std::size_t cursor = state.thread_index() * (key_space / std::max(1, state.threads()));
+
+    std::string value(value_size, 'w'), out;
+    uint64_t reads = 0, hits = 0;
+    for (auto _ : state) {
+        std::size_t i;
+        if (distribution == Distribution::Uniform) {
+            i = uniform(rng);
+        } else if (distribution == Distribution::ScanMixed && percent(rng) < scan_percent) {
+            i = cursor++ % key_space;
+        } else {
+            // Hot keys are spread over the key space as in real life
+            i = zipf.Scramble(zipf(rng));
+        }
+
+        if (percent(rng) < read_percent) {
+            reads++;
+            if (storage->Get(keys[i], out)) {
+                hits++;
+            } else {
+                storage->Put(keys[i], value);
+            }
+        } else {
+            storage->Put(keys[i], value);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hit_rate"] = benchmark::Counter(reads > 0 ? double(hits) / reads : 0,
+                                                    benchmark::Counter::kAvgThreads);
+
+    if (state.thread_index() == 0) {
+        storage->Stop();
+        storage.reset();
+    }
+}
+
+void Usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [--key_space=N] [--zipf_theta=X] [--max_threads=N] [google benchmark flags]\n"
+            "  --key_space    number of distinct keys, cache holds half of them (default 100000)\n"
+            "  --zipf_theta   skew of zipfian distribution, 0 < X < 1 (default 0.99)\n"
+            "  --max_threads  upper bound of thread counts (default number of cores)\n"
+            "Names are <backend>/<distribution>/value:<size>/read:<percent>/real_time/threads:<N>, filter them with\n"
+            "--benchmark_filter, e.g. --benchmark_filter='mt_.*/zipf/value:64/read:90'\n",
+            name);
+}
+
+bool ParseFlag(const char *arg, const char *name, std::string &value) {
+    std::size_t len = strlen(name);
+    if (strncmp(arg, name, len) != 0 || arg[len] != '=') {
+        return false;
+    }
+    value = arg + len + 1;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+
+    // Google benchmark leaves flags it doesn't know
+    std::string value;
+    for (int i = 1; i < argc; i++) {
+        if (ParseFlag(argv[i], "--key_space", value)) {
+            key_space = std::stoul(value);
+        } else if (ParseFlag(argv[i], "--zipf_theta", value)) {
+            zipf_theta = std::stod(value);
+        } else if (ParseFlag(argv[i], "--max_threads", value)) {
+            max_threads = std::stoul(value);
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (key_space < 2 || zipf_theta <= 0 || zipf_theta >= 1) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (max_threads == 0) {
+        max_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    static const std::vector<Backend> backends = Backends();
+    const std::pair<Distribution, const char *> distributions[] = {
+        {Distribution::Uniform, "uniform"}, {Distribution::Zipf, "zipf"}, {Distribution::ScanMixed, "scan"}};
+
+    for (const Backend &backend : backends) {
+        for (auto &distribution : distributions) {
+            std::string name = std::string(backend.name) + "/" + distribution.second;
+            Distribution kind = distribution.first;
+            auto *bench = benchmark::RegisterBenchmark(name.c_str(), [&backend, kind](benchmark::State &state) {
+                Run(state, backend, kind);
+            });
+
+            bench->ArgNames({"value", "read"})->ArgsProduct({{64, 1024, 16384}, {50, 90, 99}})->UseRealTime();
+            if (backend.concurrent) {
+                bench->ThreadRange(1, max_threads);
+            }
+        }
+    }
+
+    Keys();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    unlink(MmapPath().c_str());
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef AFINA_BENCH_ZIPF_GENERATOR_H
+#define AFINA_BENCH_ZIPF_GENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+namespace Afina {
+namespace Bench {
+
+/**
+ * # Zipfian generator
+ * Algorithm from Gray et al. "Quickly generating billion-record synthetic databases", same as YCSB uses: after
+ * O(n) setup each number costs a few floating point operations. Rank 0 is the most popular one, callers scramble
+ * ranks so that hot keys don't sit next to each other
+ */
+class ZipfGenerator {
+public:
+    ZipfGenerator(std::size_t n, double theta) : _n(n), _theta(theta) {
+        double zeta2 = 0;
+        _zetan = 0;
+        for (std::size_t i = 1; i <= n; i++) {
+            _zetan += 1 / std::pow(double(i), theta);
+            if (i == 2) {
+                zeta2 = _zetan;
+            }
+        }
+        _alpha = 1 / (1 - theta);
+        _eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta2 / _zetan);
+    }
+
+    template <typename Rng> std::size_t operator()(Rng &rng) {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        double uz = u * _zetan;
+        if (uz < 1) {
+            return 0;
+        } else if (uz < 1 + std::pow(0.5, _theta)) {
+            return 1;
+        }
+        return std::min(_n - 1, std::size_t(_n * std::pow(_eta * u - _eta + 1, _alpha)));
+    }
+
+    /**
+     * Spreads rank over [0, n), so that popular items are scattered the same way on every run
+     */
+    std::size_t Scramble(std::size_t rank) const { return (rank * 0x9E3779B97F4A7C15ull) % _n; }
+
+private:
+    std::size_t _n;
+    double _theta;
+    double _zetan;
+    double _alpha;
+    double _eta;
+};
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_ZIPF_GENERATOR_H
@@ -0,0 +1,65 @@
+#ifndef AFINA_SNAPSHOT_H
+#define AFINA_SNAPSHOT_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Point in time dumps of the storage
+ * Snapshot file starts with 8 bytes magic and little endian 64 bit number of entries, followed by entries:
+ * varint key length, varint value length, key and value bytes. File is written next to the target and renamed
+ * over it once complete, so readers never see partial snapshot.
+ */
+
+/**
+ * Writes all storage entries into the file at path, returns number of entries written. Storage must not be used
+ * concurrently, see Storage::ForEach. Throws std::runtime_error on failure
+ */
+std::size_t WriteSnapshot(const Afina::Storage &storage, const std::string &path);
+
+/**
+ * Forks process with the frozen copy of storage, child writes snapshot and exits while parent goes on serving
+ * requests. Memory is shared copy-on-write, so only pages changed meanwhile get duplicated.
+ *
+ * Returns false with error description if snapshot can't be started, e.g. previous one is still running.
+ * Child is reaped in background, see SnapshotStats
+ */
+bool ForkSnapshot(Afina::Storage &storage, const std::string &path, std::string &error);
+
+/**
+ * Sets directory snapshots requested by clients are written to, empty one disables such snapshots. Must be called
+ * before storage is shared between threads
+ */
+void SetSnapshotDirectory(const std::string &dir);
+
+/**
+ * Resolves snapshot name given by client into the path inside snapshot directory. Name must be a plain file name:
+ * not empty, no slashes and no leading dot, so client can't write or rename anything outside of the directory.
+ * Returns false with error description if name is rejected or snapshots are disabled
+ */
+bool SnapshotPath(const std::string &name, std::string &path, std::string &error);
+
+/**
+ * Appends state of the forked snapshots to statistics
+ */
+void SnapshotStats(std::vector<std::pair<std::string, std::string>> &stats);
+
+/**
+ * Puts all entries from the snapshot file into storage using given number of threads, 0 means one per core.
+ * Storage which isn't Storage::ThreadSafe gets single thread whatever is asked. Returns number of entries stored.
+ * Throws std::runtime_error if file can't be read or is malformed, entries read before the error could be stored
+ * already
+ */
+std::size_t LoadSnapshot(Afina::Storage &storage, const std::string &path, unsigned threads = 0);
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_SNAPSHOT_H
@@ -1,7 +1,11 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Afina {
 
@@ -10,12 +14,27 @@ namespace Afina {
  */
 class Storage {
 public:
+    // Receives values found by MultiGet: index of the key in request and value
+    using found_func = std::function<void(std::size_t index, const std::string &value)>;
+
+    // Receives entries enumerated by ForEach
+    using visit_func = std::function<void(const std::string &key, const std::string &value)>;
+
+    // Receives keys of entries evicted by storage
+    using evicted_func = std::function<void(const std::string &key)>;
+
     Storage() {}
     virtual ~Storage() {}
 
     virtual void Start() {}
     virtual void Stop() {}
 
+    /**
+     * Returns true if methods could be called from several threads at once, otherwise caller must serialize
+     * all calls
+     */
+    virtual bool ThreadSafe() const { return false; }
+
     /**
      * Stores association between given key/value pair.
      * If key is already present in storage then replace existing value by
@@ -84,6 +103,99 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) = 0;
+
+    /**
+     * Retrive values for the set of keys
+     * For each key found method calls callback with index of the key and
+     * its value, in order of keys. Missing keys are skipped.
+     *
+     * Default implementation calls Get for each key, storages override it to
+     * take locks and do lookups once per batch. Callback could be called
+     * under storage locks, so it must not access storage
+     *
+     * @param keys to retrive values for
+     * @param found callback to pass values to
+     */
+    virtual void MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+        std::string value;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (Get(keys[i], value)) {
+                found(i, value);
+            }
+        }
+    }
+
+    /**
+     * Appends storage specific statistics as name/value pairs, those are reported
+     * by "stats" command. Names must not contain spaces
+     *
+     * @param stats output parameter to append statistics to
+     */
+    virtual void Stats(std::vector<std::pair<std::string, std::string>> &stats) {}
+
+    /**
+     * Calls function while no other thread could change the storage, i.e. holding
+     * all storage locks exclusively. Used to fork process with a consistent copy
+     * of the storage, function must not access storage itself
+     *
+     * @param func function to run
+     */
+    virtual void Freeze(const std::function<void()> &func) { func(); }
+
+    /**
+     * Calls visitor for each entry in storage. Doesn't take any locks and doesn't
+     * count as access to entries, so it is safe only if nobody else uses storage:
+     * inside Freeze or in the process forked from there.
+     *
+     * Method returns false if storage can't enumerate its entries
+     *
+     * @param visit callback to pass entries to
+     */
+    virtual bool ForEach(const visit_func &visit) const { return false; }
+
+    /**
+     * Hints that about given number of entries is going to be inserted, so that
+     * storage could size its index once instead of growing it step by step. Must
+     * be called before storage is shared between threads
+     *
+     * @param count number of entries expected
+     */
+    virtual void Reserve(std::size_t count) {}
+
+    /**
+     * Calls visitor for entries which keys start with the given prefix, in order
+     * of keys, until limit entries are visited. Doesn't count as access to entries.
+     * Callback could be called under storage locks, so it must not access storage.
+     *
+     * Method returns false if storage doesn't keep keys ordered
+     *
+     * @param prefix of keys to visit, empty one matches all keys
+     * @param limit maximum number of entries to visit
+     * @param visit callback to pass entries to
+     */
+    virtual bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) { return false; }
+
+    /**
+     * Removes all entries which keys start with the given prefix
+     *
+     * Method returns false if storage doesn't keep keys ordered or failed to
+     * make removal durable
+     *
+     * @param prefix of keys to remove
+     * @param deleted output parameter, number of entries removed
+     */
+    virtual bool DeletePrefix(const std::string &prefix, std::size_t &deleted) { return false; }
+
+    /**
+     * Sets function to call with the key of each entry storage drops on its own to make room for others,
+     * explicit deletes and updates aren't reported. Callback could be called under storage locks, so it must
+     * not access storage. Must be set before storage is shared between threads
+     *
+     * Method returns false if storage can't report evictions
+     *
+     * @param evicted callback to pass keys to
+     */
+    virtual bool WatchEvictions(const evicted_func &evicted) { return false; }
 };
 
 } // namespace Afina
@@ -1,10 +1,116 @@
 #ifndef AFINA_CONCURRENCY_CORE_LOCAL_H
 #define AFINA_CONCURRENCY_CORE_LOCAL_H
 
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class CoreLocal {};
+/**
+ * Returns id of the CPU calling thread is running on. Uses restartable sequences area registered
+ * by glibc when available, which is a plain memory load, and falls back to sched_getcpu(3) otherwise.
+ *
+ * Value is a hint only: thread could be migrated right after the call
+ */
+unsigned current_cpu();
+
+/**
+ * Returns number of CPUs configured in the system, i.e maximum value of current_cpu() + 1
+ */
+std::size_t cpu_count();
+
+/**
+ * # Per CPU instance of T
+ * Keeps one instance of T for each CPU, each in its own cache line(s), so that threads running on
+ * different cores never write to the same line. Typical usage is statistic counters and free lists
+ * which are updated on the hot path and read rarely.
+ *
+ * Note that slot is NOT exclusive to a thread: two threads could be scheduled on the same CPU one
+ * after another or migrated in the middle of update. So T must be safe for concurrent access, for
+ * example std::atomic with relaxed ordering. It is still cheap as contention on the same line is rare
+ */
+template <typename T> class CoreLocal {
+public:
+    // Cache line size, slot size is rounded up to it
+    static const std::size_t cache_line = 64;
+
+    CoreLocal() : _size(cpu_count()), _slots(Allocate(_size)) {
+        for (std::size_t i = 0; i < _size; i++) {
+            new (&_slots[i]) Slot();
+        }
+    }
+
+    explicit CoreLocal(const T &initial) : _size(cpu_count()), _slots(Allocate(_size)) {
+        for (std::size_t i = 0; i < _size; i++) {
+            new (&_slots[i]) Slot(initial);
+        }
+    }
+
+    ~CoreLocal() {
+        for (std::size_t i = 0; i < _size; i++) {
+            _slots[i].~Slot();
+        }
+        free(_slots);
+    }
+
+    CoreLocal(const CoreLocal &) = delete;
+    CoreLocal &operator=(const CoreLocal &) = delete;
+
+    /**
+     * Instance of the CPU calling thread is running on
+     */
+    T &local() { return _slots[current_cpu() % _size].value; }
+
+    /**
+     * Instance of the given CPU
+     */
+    T &operator[](std::size_t cpu) { return _slots[cpu].value; }
+    const T &operator[](std::size_t cpu) const { return _slots[cpu].value; }
+
+    std::size_t size() const { return _size; }
+
+    /**
+     * Calls func(T &) for instance of each CPU
+     */
+    template <typename F> void visit(F func) {
+        for (std::size_t i = 0; i < _size; i++) {
+            func(_slots[i].value);
+        }
+    }
+
+    /**
+     * Folds all instances into single value: result = func(result, instance) for each CPU
+     */
+    template <typename R, typename F> R aggregate(R init, F func) const {
+        for (std::size_t i = 0; i < _size; i++) {
+            init = func(init, _slots[i].value);
+        }
+        return init;
+    }
+
+private:
+    struct alignas(cache_line) Slot {
+        Slot() : value() {}
+        Slot(const T &v) : value(v) {}
+
+        T value;
+    };
+
+    // C++11 operator new doesn't respect over aligned types, so memory is requested explicitly
+    static Slot *Allocate(std::size_t n) {
+        void *p = nullptr;
+        if (posix_memalign(&p, cache_line, n * sizeof(Slot)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<Slot *>(p);
+    }
+
+    const std::size_t _size;
+    Slot *_slots;
+};
 
 } // namespace Concurrency
 } // namespace Afina
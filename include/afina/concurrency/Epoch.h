@@ -0,0 +1,111 @@
+#ifndef AFINA_CONCURRENCY_EPOCH_H
+#define AFINA_CONCURRENCY_EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ThreadLocal.h"
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Epoch based memory reclamation
+ * Lets readers traverse shared structure without locks while writers unlink and retire its nodes. Reader wraps
+ * traversal into Guard, which publishes global epoch it has seen. Writer retires unlinked node instead of deleting
+ * it, node is tagged with epoch of the moment. Node is freed once all threads inside guards have published epoch
+ * greater than its tag: any of them started traversal after node became unreachable.
+ *
+ * Retired nodes are kept in the list of the retiring thread and collected in batches, so reader side costs a single
+ * store with a fence on guard entry and a store on exit. Nodes left by exited threads are collected by others.
+ */
+class EpochManager {
+public:
+    /**
+     * # Read side critical section
+     * Pointers read from the protected structure stay valid until guard is destroyed. Guards could be nested
+     */
+    class Guard {
+    public:
+        explicit Guard(EpochManager &manager) : _manager(manager) { _manager.enter(); }
+        ~Guard() { _manager.leave(); }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        EpochManager &_manager;
+    };
+
+    /**
+     * batch is the number of retired nodes thread accumulates before trying to free them
+     */
+    explicit EpochManager(std::size_t batch = 128);
+
+    /**
+     * Frees everything retired, there must be no readers at this point
+     */
+    ~EpochManager();
+
+    EpochManager(const EpochManager &) = delete;
+    EpochManager &operator=(const EpochManager &) = delete;
+
+    /**
+     * Schedules node already unreachable for new readers for deletion
+     */
+    template <typename T> void retire(T *p) {
+        retire(p, [](void *ptr) { delete static_cast<T *>(ptr); });
+    }
+
+    void retire(void *p, void (*deleter)(void *));
+
+    /**
+     * Advances global epoch and frees nodes of the calling thread (and of exited ones) nobody could reach anymore
+     */
+    void collect();
+
+private:
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+
+    struct Record {
+        Record() : epoch(0), depth(0) {}
+
+        // Epoch published by the thread while inside guard, 0 otherwise. Read by collecting threads
+        std::atomic<uint64_t> epoch;
+
+        // Guards nesting level, owner only
+        unsigned depth;
+
+        // Nodes retired by the thread, owner only
+        std::vector<Retired> retired;
+    };
+
+    void enter();
+    void leave();
+
+    // Frees nodes from the list tagged with epoch less than given one
+    static void Free(std::vector<Retired> &list, uint64_t safe);
+
+    const std::size_t _batch;
+
+    // Global epoch, starts from 1 as 0 means "not in critical section"
+    std::atomic<uint64_t> _epoch;
+
+    // Nodes of exited threads. Declared before records as those merge leftovers in here
+    std::mutex _orphans_lock;
+    std::vector<Retired> _orphans;
+
+    ThreadLocal<Record> _records;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_EPOCH_H
@@ -1,10 +1,209 @@
 #ifndef AFINA_CONCURRENCY_FLAT_COMBINE_H
 #define AFINA_CONCURRENCY_FLAT_COMBINE_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "ThreadLocal.h"
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename Op> class FlatCombine {};
+/**
+ * # Flat combining executor
+ * Serializes operations on some shared structure without making each thread grab the lock. Thread publishes
+ * operation in its own slot and tries to acquire the lock. Whoever wins becomes "combiner": it collects all
+ * published operations and applies them as a single batch, while the others just spin until their slots are
+ * cleared. So the structure mostly stays in the cache of a single core and the lock is taken once per batch
+ * instead of once per operation.
+ *
+ * Op is any type carrying both operation arguments and its result, it is owned by the caller and must stay alive
+ * until execute() returns. Combiner function gets exclusive access to the shared structure for the time of the call.
+ *
+ * Operations of a batch are usually independent, so combiner function should catch failure of each operation and
+ * report it through the operation itself, leaving the rest of the batch unaffected. If combiner function throws
+ * anyway, the exception is rethrown from execute() of every operation of that batch, some of which may have been
+ * applied already. Lock is released and waiters are let go either way.
+ */
+template <typename Op> class FlatCombine {
+public:
+    // Applies batch of operations, results should be written into the operations themselves
+    using combiner_func = std::function<void(Op *const *ops, std::size_t count)>;
+
+    // Cache line size, slots never share it
+    static const std::size_t cache_line = 64;
+
+    FlatCombine(combiner_func combiner, std::size_t max_threads = 128)
+        : _combiner(combiner), _size(max_threads), _used(0), _slots(Allocate(max_threads), free),
+          _thread_slot(ReleaseSlot) {
+        for (std::size_t i = 0; i < _size; i++) {
+            new (&_slots[i]) Slot();
+        }
+        _batch.reserve(_size + 1);
+        _batch_slots.reserve(_size);
+    }
+
+    FlatCombine(const FlatCombine &) = delete;
+    FlatCombine &operator=(const FlatCombine &) = delete;
+
+    /**
+     * Applies given operation. Method returns once operation is executed either by the calling thread or by
+     * some other one that happened to be combiner at the moment
+     */
+    void execute(Op &op) {
+        Slot *slot = ThreadSlot();
+        if (slot == nullptr) {
+            // No free slots (too many threads), apply it along with published ones
+            std::lock_guard<std::mutex> lock(_lock);
+            std::exception_ptr error = Combine(&op);
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return;
+        }
+
+        slot->op.store(&op, std::memory_order_release);
+        for (int spins = 0; slot->op.load(std::memory_order_acquire) != nullptr; spins++) {
+            std::unique_lock<std::mutex> lock(_lock, std::try_to_lock);
+            if (lock.owns_lock()) {
+                Combine(nullptr);
+            } else if (spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+
+        // Published along with slot reset, so it is visible once op is seen cleared
+        if (slot->error) {
+            std::exception_ptr error;
+            std::swap(error, slot->error);
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct alignas(cache_line) Slot {
+        Slot() : op(nullptr), in_use(false) {}
+
+        // Operation waiting to be applied, combiner resets it to nullptr once done
+        std::atomic<Op *> op;
+
+        // True if slot belongs to some thread
+        std::atomic<bool> in_use;
+
+        // Exception thrown by combiner while applying the operation, set before op is reset
+        std::exception_ptr error;
+    };
+
+    // Per thread reference on owned slot
+    struct SlotRef {
+        SlotRef() : slot(nullptr) {}
+        Slot *slot;
+    };
+
+    // C++11 operator new doesn't respect over aligned types, so memory is requested explicitly
+    static Slot *Allocate(std::size_t n) {
+        void *p = nullptr;
+        if (posix_memalign(&p, cache_line, n * sizeof(Slot)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<Slot *>(p);
+    }
+
+    // Merge function of ThreadLocal is called once thread exits, that is time to give slot back
+    static void ReleaseSlot(SlotRef &, const SlotRef &exited) {
+        if (exited.slot != nullptr) {
+            exited.slot->in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    // Returns slot of the calling thread, claims free one on the first call. nullptr if there are no free slots
+    Slot *ThreadSlot() {
+        SlotRef &ref = _thread_slot.get();
+        if (ref.slot != nullptr) {
+            return ref.slot;
+        }
+
+        for (std::size_t i = 0; i < _size; i++) {
+            bool expected = false;
+            if (_slots[i].in_use.compare_exchange_strong(expected, true)) {
+                ref.slot = &_slots[i];
+
+                std::size_t used = _used.load();
+                while (used < i + 1 && !_used.compare_exchange_weak(used, i + 1)) {
+                }
+                return ref.slot;
+            }
+        }
+        return nullptr;
+    }
+
+    // Must be called under lock: collects all published operations, plus the given one if any, and applies them.
+    // Returns exception thrown by combiner, if any, it is passed to the owners of published operations as well
+    std::exception_ptr Combine(Op *own) {
+        _batch.clear();
+        _batch_slots.clear();
+
+        std::size_t used = _used.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < used; i++) {
+            Op *op = _slots[i].op.load(std::memory_order_acquire);
+            if (op != nullptr) {
+                _batch.push_back(op);
+                _batch_slots.push_back(&_slots[i]);
+            }
+        }
+
+        if (own != nullptr) {
+            _batch.push_back(own);
+        }
+
+        if (_batch.empty()) {
+            return nullptr;
+        }
+
+        std::exception_ptr error;
+        try {
+            _combiner(_batch.data(), _batch.size());
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // Release waiters, results are published along with slot reset
+        for (Slot *slot : _batch_slots) {
+            slot->error = error;
+            slot->op.store(nullptr, std::memory_order_release);
+        }
+        return error;
+    }
+
+    // Applies batches of operations
+    combiner_func _combiner;
+
+    // Number of slots and number of slots ever claimed, combiner scans only the latter
+    const std::size_t _size;
+    std::atomic<std::size_t> _used;
+
+    // Publication slots, one per thread. Declared before _thread_slot, so that memory is released only
+    // once exiting threads can't reach it anymore
+    std::unique_ptr<Slot[], void (*)(void *)> _slots;
+
+    // Slot owned by the calling thread
+    ThreadLocal<SlotRef> _thread_slot;
+
+    // Combiner lock
+    std::mutex _lock;
+
+    // Batch being applied and slots it was collected from, accessed only under lock
+    std::vector<Op *> _batch;
+    std::vector<Slot *> _batch_slots;
+};
 
 } // namespace Concurrency
 } // namespace Afina
@@ -0,0 +1,57 @@
+#ifndef AFINA_CONCURRENCY_SHARED_MUTEX_H
+#define AFINA_CONCURRENCY_SHARED_MUTEX_H
+
+#include <pthread.h>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Mutex supporting both exclusive (write) and shared (read) ownership
+ * C++11 has no std::shared_mutex, so this is a thin wrapper over pthread rwlock. Lock prefers writers: once writer
+ * is waiting new readers are queued, otherwise steady read traffic starves writers forever.
+ *
+ * Satisfies Lockable requirements, so std::lock_guard/std::unique_lock work for exclusive ownership and
+ * SharedLock below for the shared one
+ */
+class SharedMutex {
+public:
+    SharedMutex();
+    ~SharedMutex();
+
+    SharedMutex(const SharedMutex &) = delete;
+    SharedMutex &operator=(const SharedMutex &) = delete;
+
+    // Exclusive ownership
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    // Shared ownership
+    void lock_shared();
+    bool try_lock_shared();
+    void unlock_shared();
+
+private:
+    pthread_rwlock_t _lock;
+};
+
+/**
+ * # RAII wrapper for shared ownership, counterpart of std::lock_guard
+ */
+template <typename Mutex> class SharedLock {
+public:
+    explicit SharedLock(Mutex &m) : _m(m) { _m.lock_shared(); }
+    ~SharedLock() { _m.unlock_shared(); }
+
+    SharedLock(const SharedLock &) = delete;
+    SharedLock &operator=(const SharedLock &) = delete;
+
+private:
+    Mutex &_m;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_SHARED_MUTEX_H
@@ -1,10 +1,171 @@
 #ifndef AFINA_CONCURRENCY_THREAD_LOCAL_H
 #define AFINA_CONCURRENCY_THREAD_LOCAL_H
 
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class ThreadLocal {};
+/**
+ * # Type independent part of ThreadLocal
+ * Each ThreadLocal object gets unique index, each thread keeps vector of its own instances indexed by it.
+ * All instances of the same ThreadLocal object are linked together so that reader could enumerate them.
+ *
+ * Single process wide mutex protects links and indexes. It is taken when thread touches ThreadLocal object for
+ * the first time, on thread exit, on ThreadLocal object destruction and by readers, but never on access to
+ * already existing instance
+ */
+class ThreadLocalBase {
+protected:
+    struct Entry {
+        Entry(ThreadLocalBase *o) : owner(o), prev(nullptr), next(nullptr) {}
+        virtual ~Entry() {}
+
+        // ThreadLocal object instance belongs to, nullptr once object is destroyed
+        ThreadLocalBase *owner;
+
+        // Siblings from the other threads
+        Entry *prev;
+        Entry *next;
+    };
+
+    ThreadLocalBase();
+    virtual ~ThreadLocalBase();
+
+    /**
+     * Returns instance of the calling thread or nullptr if it wasn't created yet
+     */
+    Entry *Find() const {
+        const std::vector<Entry *> &slots = Slots();
+        if (_index < slots.size()) {
+            Entry *e = slots[_index];
+            if (e != nullptr && e->owner == this) {
+                return e;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Makes given entry instance of the calling thread
+     */
+    void Register(Entry *entry);
+
+    /**
+     * Called under lock when thread owning entry exits, entry must be unlinked and deleted
+     */
+    virtual void Retire(Entry *entry) = 0;
+
+    /**
+     * Removes entry from the list of live instances
+     */
+    void Unlink(Entry *entry);
+
+    /**
+     * Orphans all live instances, must be called by derived class destructor so that exiting threads
+     * never call Retire() on partially destroyed object
+     */
+    void Detach();
+
+    /**
+     * Lock protecting all the lists, see above
+     */
+    static std::mutex &Lock();
+
+    // Live instances
+    Entry *_entries;
+
+private:
+    friend struct ThreadSlots;
+
+    // Instances of the calling thread indexed by ThreadLocal object index
+    static std::vector<Entry *> &Slots();
+
+    // Position of this object instances in ThreadSlots vector
+    std::size_t _index;
+};
+
+/**
+ * # Thread local instance of T with enumeration
+ * Like thread_local variable, but each object has its own set of instances (so it could be a class member) and all
+ * instances could be visited by any thread, for example to aggregate per thread statistics.
+ *
+ * Instance is created lazily on the first access from the thread. Once thread exits its instance gets folded into
+ * the "retired" value using merge function given to constructor, so that aggregated values doesn't go back in time.
+ * If no merge function given then values of exited threads are just dropped.
+ *
+ * Access to own instance is just a couple of memory loads without any locks or atomics. Note that reader sees values
+ * while owners keep updating them without synchronization. That is fine for word sized counters on the platforms we
+ * care about, but T must not have invariants spread across several fields that reader relies on
+ */
+template <typename T> class ThreadLocal : public ThreadLocalBase {
+public:
+    using merge_func = std::function<void(T &into, const T &from)>;
+
+    explicit ThreadLocal(merge_func merge = merge_func()) : _merge(merge), _retired() {}
+    ~ThreadLocal() { Detach(); }
+
+    ThreadLocal(const ThreadLocal &) = delete;
+    ThreadLocal &operator=(const ThreadLocal &) = delete;
+
+    /**
+     * Instance of the calling thread, created on the first call
+     */
+    T &get() {
+        Entry *e = Find();
+        if (e == nullptr) {
+            e = new Node(this);
+            Register(e);
+        }
+        return static_cast<Node *>(e)->value;
+    }
+
+    T &operator*() { return get(); }
+    T *operator->() { return &get(); }
+
+    /**
+     * Calls func(const T &) for instance of each live thread and then for the value folded from exited threads
+     */
+    template <typename F> void visit(F func) const {
+        std::lock_guard<std::mutex> lock(Lock());
+        for (Entry *e = _entries; e != nullptr; e = e->next) {
+            func(static_cast<const Node *>(e)->value);
+        }
+        func(_retired);
+    }
+
+    /**
+     * Folds all instances into single value: result = func(result, instance)
+     */
+    template <typename R, typename F> R aggregate(R init, F func) const {
+        visit([&init, &func](const T &v) { init = func(init, v); });
+        return init;
+    }
+
+protected:
+    struct Node : public Entry {
+        Node(ThreadLocalBase *o) : Entry(o), value() {}
+        T value;
+    };
+
+    // See ThreadLocalBase
+    void Retire(Entry *entry) override {
+        Unlink(entry);
+        if (_merge) {
+            _merge(_retired, static_cast<Node *>(entry)->value);
+        }
+        delete entry;
+    }
+
+private:
+    merge_func _merge;
+
+    // Values of exited threads
+    T _retired;
+};
 
 } // namespace Concurrency
 } // namespace Afina
@@ -0,0 +1,136 @@
+#ifndef AFINA_COROUTINE_CHANNEL_H
+#define AFINA_COROUTINE_CHANNEL_H
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+#include "Engine.h"
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Queue to pass values between coroutines of the same engine
+ * Sender blocks while channel is full, receiver blocks while channel is empty. Blocked coroutines are parked in the
+ * engine "blocked" list, so no OS thread ever sleeps on a channel. Not threadsafe, same as Engine itself.
+ *
+ * Channel with capacity 0 is unbounded, send never blocks then.
+ */
+template <typename T> class Channel {
+public:
+    Channel(Engine &engine, std::size_t capacity = 0) : _engine(engine), _capacity(capacity), _closed(false) {}
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    /**
+     * Puts value into the channel, suspends current coroutine while there is no room for it. Returns false if
+     * channel is closed (before the call or while waiting), value is dropped in a such case
+     */
+    bool send(T value) {
+        while (!_closed && full()) {
+            wait(_senders);
+        }
+
+        if (_closed) {
+            return false;
+        }
+
+        _buffer.push_back(std::move(value));
+        wake(_receivers);
+        return true;
+    }
+
+    /**
+     * Moves next value from the channel into output parameter, suspends current coroutine until value arrives.
+     * Returns false if channel is closed and there are no more values to read
+     */
+    bool recv(T &value) {
+        while (_buffer.empty() && !_closed) {
+            wait(_receivers);
+        }
+
+        if (_buffer.empty()) {
+            return false;
+        }
+
+        value = std::move(_buffer.front());
+        _buffer.pop_front();
+        wake(_senders);
+        return true;
+    }
+
+    /**
+     * Non blocking versions of send/recv, return false instead of waiting
+     */
+    bool try_send(T value) {
+        if (_closed || full()) {
+            return false;
+        }
+
+        _buffer.push_back(std::move(value));
+        wake(_receivers);
+        return true;
+    }
+
+    bool try_recv(T &value) {
+        if (_buffer.empty()) {
+            return false;
+        }
+
+        value = std::move(_buffer.front());
+        _buffer.pop_front();
+        wake(_senders);
+        return true;
+    }
+
+    /**
+     * Forbids further sends and wakes up everybody waiting on the channel. Values already in the channel are still
+     * could be received
+     */
+    void close() {
+        _closed = true;
+        while (!_senders.empty()) {
+            wake(_senders);
+        }
+        while (!_receivers.empty()) {
+            wake(_receivers);
+        }
+    }
+
+    bool closed() const { return _closed; }
+    bool full() const { return _capacity > 0 && _buffer.size() >= _capacity; }
+    std::size_t size() const { return _buffer.size(); }
+
+private:
+    void wait(std::deque<void *> &queue) {
+        queue.push_back(_engine.current());
+        _engine.block();
+    }
+
+    void wake(std::deque<void *> &queue) {
+        if (!queue.empty()) {
+            _engine.unblock(queue.front());
+            queue.pop_front();
+        }
+    }
+
+    Engine &_engine;
+
+    // Maximum number of values buffered, 0 means no limit
+    const std::size_t _capacity;
+
+    // Values sent but not received yet
+    std::deque<T> _buffer;
+
+    // Coroutines waiting for the room in buffer/for the value to arrive, in order of arrival
+    std::deque<void *> _senders;
+    std::deque<void *> _receivers;
+
+    bool _closed;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CHANNEL_H
@@ -0,0 +1,57 @@
+#ifndef AFINA_COROUTINE_CONDITION_VARIABLE_H
+#define AFINA_COROUTINE_CONDITION_VARIABLE_H
+
+#include <deque>
+
+namespace Afina {
+namespace Coroutine {
+
+// Forward declaration, see Engine.h
+class Engine;
+class Mutex;
+
+/**
+ * # Condition variable for coroutines of the same engine
+ * Waiting coroutine is parked in the engine "blocked" list, notify moves it back to the alive one.
+ * There are no spurious wakeups, but as usual condition should be rechecked in a loop since
+ * another coroutine could get the mutex first. Not threadsafe, same as Engine itself.
+ */
+class ConditionVariable {
+public:
+    ConditionVariable(Engine &engine) : _engine(engine) {}
+    ConditionVariable(const ConditionVariable &) = delete;
+    ConditionVariable &operator=(const ConditionVariable &) = delete;
+
+    /**
+     * Releases given mutex and suspends current coroutine until notified, mutex is
+     * acquired back before method returns
+     */
+    void wait(Mutex &mutex);
+
+    template <typename Predicate> void wait(Mutex &mutex, Predicate pred) {
+        while (!pred()) {
+            wait(mutex);
+        }
+    }
+
+    /**
+     * Wakes up the longest waiting coroutine, if any
+     */
+    void notify_one();
+
+    /**
+     * Wakes up all waiting coroutines
+     */
+    void notify_all();
+
+private:
+    Engine &_engine;
+
+    // Coroutines waiting for notification
+    std::deque<void *> _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CONDITION_VARIABLE_H
@@ -1,6 +1,7 @@
 #ifndef AFINA_COROUTINE_ENGINE_H
 #define AFINA_COROUTINE_ENGINE_H
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iostream>
@@ -39,6 +40,9 @@ private:
         // Saved coroutine context (registers)
         jmp_buf Environment;
 
+        // True if routine sits in the "blocked" list rather than in the "alive" one
+        bool Blocked = false;
+
         // To include routine in the different lists, such as "alive", "blocked", e.t.c
         struct context *prev = nullptr;
         struct context *next = nullptr;
@@ -55,9 +59,11 @@ private:
     context *cur_routine;
 
     /**
-     * List of routines ready to be scheduled. Note that suspended routine ends up here as well
+     * Run queue: routines ready to be scheduled in FIFO order. Note that suspended routine ends up here as well.
+     * Head and tail are tracked both, so push/pop are O(1)
      */
     context *alive;
+    context *alive_tail;
 
     /**
      * List of corountines that sleep and can't be executed
@@ -69,6 +75,23 @@ private:
      */
     context *idle_ctx;
 
+    /**
+     * Contexts of finished routines kept for reuse along with their stack copy buffers, so that
+     * short-lived coroutines doesn't hit allocator on each run. Single linked by next field
+     */
+    context *free_ctx;
+    std::size_t free_ctx_size;
+
+    /**
+     * Maximum number of contexts to keep in the free list above
+     */
+    static const std::size_t max_free_ctx = 4096;
+
+    /**
+     * Extra stack Restore() takes beyond the region being restored, room for the rest of its own frame
+     */
+    static const std::size_t restore_pad = 1024;
+
     /**
      * Call when all coroutines are blocked
      */
@@ -85,21 +108,60 @@ protected:
      */
     void Restore(context &ctx);
 
+    /**
+     * Second half of Restore: copies stack and jumps into the context. Must run in its own frame, which Restore
+     * places out of the region being overwritten
+     */
+    __attribute__((noinline)) void Jump(context &ctx);
+
+    /**
+     * Unlinks given routine from the list it is currently in, either "alive" or "blocked"
+     */
+    void Unlink(context &ctx);
+
+    /**
+     * Appends routine to the tail of run queue
+     */
+    void PushAlive(context &ctx);
+
+    /**
+     * Adds routine to the list of blocked ones
+     */
+    void PushBlocked(context &ctx);
+
+    /**
+     * Takes context from the free list or allocates a new one
+     */
+    context *Acquire();
+
+    /**
+     * Returns context of the finished routine back to the free list
+     */
+    void Release(context *ctx);
+
+    /**
+     * Suspends current routine and passes control to the first alive one. If there are no alive routines left,
+     * control goes back to the idle context, so that unblocker gets a chance to wake somebody up
+     */
+    void Switch();
+
     static void null_unblocker(Engine &) {}
 
 public:
     Engine(unblocker_func unblocker = null_unblocker)
-        : StackBottom(0), cur_routine(nullptr), alive(nullptr), _unblocker(unblocker) {}
+        : StackBottom(0), cur_routine(nullptr), alive(nullptr), alive_tail(nullptr), blocked(nullptr),
+          idle_ctx(nullptr), free_ctx(nullptr), free_ctx_size(0), _unblocker(unblocker) {}
     Engine(Engine &&) = delete;
     Engine(const Engine &) = delete;
+    ~Engine();
 
     /**
      * Gives up current routine execution and let engine to schedule other one. It is not defined when
      * routine will get execution back, for example if there are no other coroutines then executing could
      * be trasferred back immediately (yield turns to be noop).
      *
-     * Also there are no guarantee what coroutine will get execution, it could be caller of the current one or
-     * any other which is ready to run
+     * Scheduling is round robin: current routine moves to the tail of run queue and the one from the head
+     * gets execution
      */
     void yield();
 
@@ -125,6 +187,27 @@ public:
      */
     void unblock(void *coro);
 
+    /**
+     * Put all given coroutines back to the tail of alive list in one pass, preserving order. Intended for
+     * event loops waking up many routines on a single epoll_wait
+     */
+    template <typename It> void unblock(It begin, It end) {
+        for (; begin != end; ++begin) {
+            unblock(*begin);
+        }
+    }
+
+    /**
+     * Put all blocked coroutines back to list of alive
+     */
+    void unblock_all();
+
+    /**
+     * Returns currently running coroutine or nullptr if engine isn't running any. Value could be used later as
+     * an argument for sched/block/unblock, that is how synchronization primitives park routines
+     */
+    void *current() const { return cur_routine == idle_ctx ? nullptr : cur_routine; }
+
     /**
      * Entry point into the engine. Prepare all internal mechanics and starts given function which is
      * considered as main.
@@ -144,6 +227,7 @@ public:
         void *pc = run(main, std::forward<Ta>(args)...);
 
         idle_ctx = new context();
+        cur_routine = idle_ctx;
         if (setjmp(idle_ctx->Environment) > 0) {
             if (alive == nullptr) {
                 _unblocker(*this);
@@ -157,7 +241,10 @@ public:
         }
 
         // Shutdown runtime
+        delete[] std::get<0>(idle_ctx->Stack);
         delete idle_ctx;
+        idle_ctx = nullptr;
+        cur_routine = nullptr;
         this->StackBottom = 0;
     }
 
@@ -172,7 +259,7 @@ public:
         }
 
         // New coroutine context that carries around all information enough to call function
-        context *pc = new context();
+        context *pc = Acquire();
 
         // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
         // execution starts here. Note that we have to acquire stack of the current function call to ensure
@@ -188,23 +275,12 @@ public:
             // to pass control after that. We never want to go backward by stack as that would mean to go backward in
             // time. Function run() has already return once (when setjmp returns 0), so return second return from run
             // would looks a bit awkward
-            if (pc->prev != nullptr) {
-                pc->prev->next = pc->next;
-            }
+            Unlink(*pc);
 
-            if (pc->next != nullptr) {
-                pc->next->prev = pc->prev;
-            }
-
-            if (alive == cur_routine) {
-                alive = alive->next;
-            }
-
-            // current coroutine finished, and the pointer is not relevant now
+            // current coroutine finished, and the pointer is not relevant now. Context goes to the free list,
+            // but its stack buffer is untouched until next run(), so we could safely continue here
             cur_routine = nullptr;
-            pc->prev = pc->next = nullptr;
-            delete std::get<0>(pc->Stack);
-            delete pc;
+            Release(pc);
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
             // coroutine to run. As current coroutine is completed and can't be scheduled anymore, it is safe to
@@ -217,13 +293,8 @@ public:
         // save stack.
         Store(*pc);
 
-        // Add routine as alive double-linked list
-        pc->next = alive;
-        alive = pc;
-        if (pc->next != nullptr) {
-            pc->next->prev = pc;
-        }
-
+        // Add routine to the tail of run queue
+        PushAlive(*pc);
         return pc;
     }
 };
@@ -0,0 +1,55 @@
+#ifndef AFINA_COROUTINE_MUTEX_H
+#define AFINA_COROUTINE_MUTEX_H
+
+#include <deque>
+
+namespace Afina {
+namespace Coroutine {
+
+// Forward declaration, see Engine.h
+class Engine;
+
+/**
+ * # Mutual exclusion between coroutines of the same engine
+ * Coroutine that fails to get the lock is parked in the engine "blocked" list until owner releases
+ * it. Ownership is passed to the waiters in FIFO order. Not threadsafe, same as Engine itself.
+ *
+ * Satisfies BasicLockable, so could be used along with std::lock_guard/std::unique_lock
+ */
+class Mutex {
+public:
+    Mutex(Engine &engine) : _engine(engine), _owner(nullptr) {}
+    Mutex(const Mutex &) = delete;
+    Mutex &operator=(const Mutex &) = delete;
+
+    /**
+     * Acquires the lock, suspends current coroutine while it is held by another one
+     */
+    void lock();
+
+    /**
+     * Acquires the lock if it is free, never suspends
+     */
+    bool try_lock();
+
+    /**
+     * Releases the lock and passes it to the first waiter if any
+     */
+    void unlock();
+
+    bool locked() const { return _owner != nullptr; }
+
+private:
+    Engine &_engine;
+
+    // Coroutine holding the lock, nullptr if mutex is free
+    void *_owner;
+
+    // Coroutines waiting for the lock
+    std::deque<void *> _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_MUTEX_H
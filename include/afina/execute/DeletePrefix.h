@@ -0,0 +1,36 @@
+#ifndef AFINA_EXECUTE_DELETE_PREFIX_H
+#define AFINA_EXECUTE_DELETE_PREFIX_H
+
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Remove all keys with the given prefix
+ * delete_prefix <prefix>\r\n
+ *
+ * Command must write result to the output, which could be:
+ * - "DELETED <n>" with number of keys removed, zero if there were none
+ * - "CLIENT_ERROR <reason>" if prefix is empty, that would wipe whole cache
+ * - "SERVER_ERROR <reason>" if storage doesn't keep keys ordered
+ */
+class DeletePrefix : public Command {
+public:
+    DeletePrefix(const std::string &prefix) : _prefix(prefix) {}
+    ~DeletePrefix() {}
+
+    inline const std::string &prefix() const { return _prefix; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::string _prefix;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_DELETE_PREFIX_H
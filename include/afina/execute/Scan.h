@@ -0,0 +1,40 @@
+#ifndef AFINA_EXECUTE_SCAN_H
+#define AFINA_EXECUTE_SCAN_H
+
+#include <cstddef>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Retrive values for keys with the given prefix
+ * scan <prefix> [<limit>]\r\n
+ *
+ * Reply has the same format as reply to get: VALUE item for each key starting with prefix, in order of keys,
+ * at most limit items (default_limit if omitted), then END. "SERVER_ERROR <reason>" is sent if storage doesn't
+ * keep keys ordered
+ */
+class Scan : public Command {
+public:
+    static const std::size_t default_limit = 100;
+
+    Scan(const std::string &prefix, std::size_t limit = default_limit) : _prefix(prefix), _limit(limit) {}
+    ~Scan() {}
+
+    inline const std::string &prefix() const { return _prefix; }
+    inline std::size_t limit() const { return _limit; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::string _prefix;
+    std::size_t _limit;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_SCAN_H
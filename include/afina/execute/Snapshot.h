@@ -0,0 +1,36 @@
+#ifndef AFINA_EXECUTE_SNAPSHOT_H
+#define AFINA_EXECUTE_SNAPSHOT_H
+
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Dump storage into the file
+ * snapshot <name>\r\n
+ *
+ * Server forks, child process writes all entries into the file of the given name inside snapshot directory set
+ * on start, while parent keeps serving requests. Reply is "OK" once child is started, progress is reported by
+ * stats as snapshot_running/snapshots_done. "CLIENT_ERROR <reason>" is sent if name isn't a plain file name or
+ * snapshots are disabled, "SERVER_ERROR <reason>" if snapshot can't be started
+ */
+class Snapshot : public Command {
+public:
+    Snapshot(const std::string &name) : _name(name) {}
+    ~Snapshot() {}
+
+    inline const std::string &name() const { return _name; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::string _name;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_SNAPSHOT_H
@@ -8,11 +8,25 @@
 namespace Afina {
 namespace Execute {
 
+/**
+ * # Report server statistics
+ * stats [<group>]\r\n
+ *
+ * Without group reports storage statistics and server counters: commands, hits, misses, traffic, connections.
+ * "stats latency" reports latency percentiles of each command executed so far. Unknown group is answered with
+ * "CLIENT_ERROR <reason>"
+ */
 class Stats : public Command {
 public:
-    Stats() {}
+    Stats(const std::string &group = std::string()) : _group(group) {}
     ~Stats() {}
+
+    inline const std::string &group() const { return _group; }
+
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::string _group;
 };
 
 } // namespace Execute
@@ -0,0 +1,96 @@
+#ifndef AFINA_METRICS_HISTOGRAM_H
+#define AFINA_METRICS_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Metrics {
+
+/**
+ * # Log-linear histogram of non-negative integer values
+ * Same bucketing as HdrHistogram: values below 2^sub_bits are counted exactly, each next power of two range is split
+ * into 2^(sub_bits - 1) equal buckets. So relative error of any reported value is below 2^(1 - sub_bits), about 1.6%,
+ * while the whole 64 bit range fits into a few thousand counters and recording is a couple of shifts.
+ *
+ * Histogram isn't synchronized: each writer should have its own one, readers merge them. Values reported are the
+ * highest ones equivalent to the bucket, so percentiles are never underestimated
+ */
+class Histogram {
+public:
+    Histogram();
+
+    /**
+     * Counts value count times
+     */
+    void Record(uint64_t value, uint64_t count = 1) {
+        _counts[Index(value)] += count;
+        _total += count;
+        _sum += value * count;
+        if (value < _min) {
+            _min = value;
+        }
+        if (value > _max) {
+            _max = value;
+        }
+    }
+
+    /**
+     * Adds all values counted by other histogram
+     */
+    void Merge(const Histogram &other);
+
+    /**
+     * Forgets all values
+     */
+    void Clear();
+
+    /**
+     * Number of values recorded
+     */
+    uint64_t Count() const { return _total; }
+
+    /**
+     * Exact minimum, maximum and mean of values recorded, 0 if there were none
+     */
+    uint64_t Min() const { return _total > 0 ? _min : 0; }
+    uint64_t Max() const { return _max; }
+    double Mean() const { return _total > 0 ? double(_sum) / _total : 0; }
+
+    /**
+     * Value at the given percentile in [0, 100]: at least that share of values are not above it. Returns 0 if
+     * there are no values
+     */
+    uint64_t Percentile(double percentile) const;
+
+private:
+    // Bits of precision, see above
+    static const unsigned sub_bits = 7;
+    static const uint64_t sub_count = uint64_t(1) << sub_bits;
+    static const uint64_t half_count = sub_count / 2;
+
+    // Bucket of the value
+    static std::size_t Index(uint64_t value) {
+        if (value < sub_count) {
+            return value;
+        }
+
+        // Ranges [2^k, 2^(k+1)) for k >= sub_bits are split into half_count buckets of width 2^(k - sub_bits + 1)
+        unsigned shift = 64 - __builtin_clzll(value) - sub_bits;
+        return sub_count + (shift - 1) * half_count + ((value >> shift) - half_count);
+    }
+
+    // The highest value of the bucket
+    static uint64_t Highest(std::size_t index);
+
+    std::vector<uint64_t> _counts;
+    uint64_t _total;
+    uint64_t _sum;
+    uint64_t _min;
+    uint64_t _max;
+};
+
+} // namespace Metrics
+} // namespace Afina
+
+#endif // AFINA_METRICS_HISTOGRAM_H
@@ -0,0 +1,55 @@
+#ifndef AFINA_METRICS_SERVER_H
+#define AFINA_METRICS_SERVER_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Metrics {
+
+/**
+ * # Process wide server statistics
+ * Network layer reports connections, traffic and time spent on each command, commands report cache hits and
+ * misses. Each thread records into its own instance, so recording costs neither locks nor atomics; readers merge
+ * instances of all threads, values of exited threads are folded and kept.
+ *
+ * Latency is tracked per command name with log-linear histograms, commands not known here are counted as "other"
+ */
+
+/**
+ * Accounts execution of the command with the given name which took given number of nanoseconds
+ */
+void RecordCommand(const std::string &name, uint64_t nanoseconds);
+
+/**
+ * Accounts keys found and not found by a read
+ */
+void RecordHits(uint64_t hits, uint64_t misses);
+
+/**
+ * Accounts bytes received from and sent to clients
+ */
+void RecordTraffic(uint64_t in, uint64_t out);
+
+/**
+ * Accounts connection accepted or closed
+ */
+void ConnectionOpened();
+void ConnectionClosed();
+
+/**
+ * Appends counters: commands by name, hits, misses, traffic and connections
+ */
+void ServerStats(std::vector<std::pair<std::string, std::string>> &stats);
+
+/**
+ * Appends count, mean, percentiles and maximum of latency in microseconds for each command executed at least once
+ */
+void LatencyStats(std::vector<std::pair<std::string, std::string>> &stats);
+
+} // namespace Metrics
+} // namespace Afina
+
+#endif // AFINA_METRICS_SERVER_H
@@ -0,0 +1,44 @@
+#include <afina/concurrency/CoreLocal.h>
+
+#include <sched.h>
+#include <unistd.h>
+
+// Since 2.35 glibc registers rseq area for each thread and exports its location, so that current cpu
+// could be read from memory kernel updates on each migration instead of doing getcpu vDSO call
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35)) &&                      \
+    (defined(__x86_64__) || defined(__aarch64__)) && (defined(__clang__) || __GNUC__ >= 11)
+#include <sys/rseq.h>
+#define AFINA_HAVE_RSEQ 1
+#endif
+
+namespace Afina {
+namespace Concurrency {
+
+// See CoreLocal.h
+unsigned current_cpu() {
+#ifdef AFINA_HAVE_RSEQ
+    if (__rseq_size > 0) {
+        const volatile struct rseq *area =
+            reinterpret_cast<const struct rseq *>(static_cast<char *>(__builtin_thread_pointer()) + __rseq_offset);
+        int cpu = static_cast<int>(area->cpu_id);
+        if (cpu >= 0) {
+            return cpu;
+        }
+    }
+#endif
+
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu;
+}
+
+// See CoreLocal.h
+std::size_t cpu_count() {
+    static const std::size_t count = []() {
+        long n = sysconf(_SC_NPROCESSORS_CONF);
+        return n > 0 ? std::size_t(n) : std::size_t(1);
+    }();
+    return count;
+}
+
+} // namespace Concurrency
+} // namespace Afina
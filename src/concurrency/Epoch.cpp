@@ -0,0 +1,89 @@
+#include <afina/concurrency/Epoch.h>
+
+#include <algorithm>
+
+namespace Afina {
+namespace Concurrency {
+
+// See Epoch.h
+EpochManager::EpochManager(std::size_t batch)
+    : _batch(batch), _epoch(1), _records([this](Record &, const Record &exited) {
+          std::lock_guard<std::mutex> lock(_orphans_lock);
+          _orphans.insert(_orphans.end(), exited.retired.begin(), exited.retired.end());
+      }) {}
+
+// See Epoch.h
+EpochManager::~EpochManager() {
+    _records.visit([](const Record &r) {
+        for (const Retired &node : r.retired) {
+            node.deleter(node.ptr);
+        }
+    });
+
+    // Leftovers of exited threads are merged here rather than into the records folded value
+    for (Retired &node : _orphans) {
+        node.deleter(node.ptr);
+    }
+}
+
+// See Epoch.h
+void EpochManager::enter() {
+    Record &r = _records.get();
+    if (r.depth++ == 0) {
+        // Store followed by full fence: the epoch must be visible to collectors before any pointer of the structure
+        // is read. Store alone, even seq_cst, lets later loads of the structure move ahead of it
+        r.epoch.store(_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+// See Epoch.h
+void EpochManager::leave() {
+    Record &r = _records.get();
+    if (--r.depth == 0) {
+        r.epoch.store(0, std::memory_order_release);
+    }
+}
+
+// See Epoch.h
+void EpochManager::retire(void *p, void (*deleter)(void *)) {
+    Record &r = _records.get();
+    r.retired.push_back(Retired{p, deleter, _epoch.load(std::memory_order_seq_cst)});
+    if (r.retired.size() >= _batch) {
+        collect();
+    }
+}
+
+// See Epoch.h
+void EpochManager::collect() {
+    // Everybody entering critical section from now on publishes new epoch, so old ones could only
+    // be held by threads already inside
+    uint64_t safe = _epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+    // Pairs with the fence in enter(): either reader's epoch is seen below or reader sees structure without
+    // nodes retired before this point
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _records.visit([&safe](const Record &r) {
+        uint64_t e = r.epoch.load(std::memory_order_seq_cst);
+        if (e != 0) {
+            safe = std::min(safe, e);
+        }
+    });
+
+    Free(_records.get().retired, safe);
+
+    std::lock_guard<std::mutex> lock(_orphans_lock);
+    Free(_orphans, safe);
+}
+
+// See Epoch.h
+void EpochManager::Free(std::vector<Retired> &list, uint64_t safe) {
+    auto end = std::partition(list.begin(), list.end(), [safe](const Retired &node) { return node.epoch >= safe; });
+    for (auto it = end; it != list.end(); it++) {
+        it->deleter(it->ptr);
+    }
+    list.erase(end, list.end());
+}
+
+} // namespace Concurrency
+} // namespace Afina
@@ -0,0 +1,57 @@
+#include <afina/concurrency/SharedMutex.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace Afina {
+namespace Concurrency {
+
+// See SharedMutex.h
+SharedMutex::SharedMutex() {
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+
+    int err = pthread_rwlock_init(&_lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    if (err != 0) {
+        throw std::system_error(err, std::system_category(), "Failed to init rwlock");
+    }
+}
+
+// See SharedMutex.h
+SharedMutex::~SharedMutex() { pthread_rwlock_destroy(&_lock); }
+
+// See SharedMutex.h
+void SharedMutex::lock() {
+    int err = pthread_rwlock_wrlock(&_lock);
+    if (err != 0) {
+        throw std::system_error(err, std::system_category(), "Failed to lock rwlock");
+    }
+}
+
+// See SharedMutex.h
+bool SharedMutex::try_lock() { return pthread_rwlock_trywrlock(&_lock) == 0; }
+
+// See SharedMutex.h
+void SharedMutex::unlock() { pthread_rwlock_unlock(&_lock); }
+
+// See SharedMutex.h
+void SharedMutex::lock_shared() {
+    int err;
+    while ((err = pthread_rwlock_rdlock(&_lock)) == EAGAIN) {
+        // Maximum number of readers reached, wait until somebody leaves
+    }
+    if (err != 0) {
+        throw std::system_error(err, std::system_category(), "Failed to lock rwlock");
+    }
+}
+
+// See SharedMutex.h
+bool SharedMutex::try_lock_shared() { return pthread_rwlock_tryrdlock(&_lock) == 0; }
+
+// See SharedMutex.h
+void SharedMutex::unlock_shared() { pthread_rwlock_unlock(&_lock); }
+
+} // namespace Concurrency
+} // namespace Afina
@@ -0,0 +1,118 @@
+#include <afina/concurrency/ThreadLocal.h>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace {
+
+// Indexes of destroyed ThreadLocal objects that could be given to new ones, and the next never used index
+std::vector<std::size_t> free_indexes;
+std::size_t next_index = 0;
+
+} // namespace
+
+/**
+ * Instances of the single thread, once thread exits all of them get retired
+ */
+struct ThreadSlots {
+    ~ThreadSlots() {
+        std::lock_guard<std::mutex> lock(ThreadLocalBase::Lock());
+        for (ThreadLocalBase::Entry *e : slots) {
+            if (e == nullptr) {
+                continue;
+            }
+
+            if (e->owner != nullptr) {
+                e->owner->Retire(e);
+            } else {
+                delete e;
+            }
+        }
+    }
+
+    std::vector<ThreadLocalBase::Entry *> slots;
+};
+
+// See ThreadLocal.h
+std::mutex &ThreadLocalBase::Lock() {
+    static std::mutex lock;
+    return lock;
+}
+
+// See ThreadLocal.h
+std::vector<ThreadLocalBase::Entry *> &ThreadLocalBase::Slots() {
+    static thread_local ThreadSlots thread_slots;
+    return thread_slots.slots;
+}
+
+// See ThreadLocal.h
+ThreadLocalBase::ThreadLocalBase() : _entries(nullptr) {
+    std::lock_guard<std::mutex> lock(Lock());
+    if (free_indexes.empty()) {
+        _index = next_index++;
+    } else {
+        _index = free_indexes.back();
+        free_indexes.pop_back();
+    }
+}
+
+// See ThreadLocal.h
+ThreadLocalBase::~ThreadLocalBase() {
+    Detach();
+
+    std::lock_guard<std::mutex> lock(Lock());
+    free_indexes.push_back(_index);
+}
+
+// See ThreadLocal.h
+void ThreadLocalBase::Detach() {
+    // Entries are still referenced from slots of their threads, so just orphan them here. Each gets deleted
+    // on its thread exit or once slot is reused by another object
+    std::lock_guard<std::mutex> lock(Lock());
+    for (Entry *e = _entries; e != nullptr; e = e->next) {
+        e->owner = nullptr;
+    }
+    _entries = nullptr;
+}
+
+// See ThreadLocal.h
+void ThreadLocalBase::Register(Entry *entry) {
+    std::vector<Entry *> &slots = Slots();
+
+    std::lock_guard<std::mutex> lock(Lock());
+    if (slots.size() <= _index) {
+        slots.resize(_index + 1, nullptr);
+    }
+
+    // Orphan of the destroyed object used the same index before
+    if (slots[_index] != nullptr) {
+        delete slots[_index];
+    }
+    slots[_index] = entry;
+
+    entry->next = _entries;
+    if (_entries != nullptr) {
+        _entries->prev = entry;
+    }
+    _entries = entry;
+}
+
+// See ThreadLocal.h
+void ThreadLocalBase::Unlink(Entry *entry) {
+    if (entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+    }
+
+    if (entry->next != nullptr) {
+        entry->next->prev = entry->prev;
+    }
+
+    if (_entries == entry) {
+        _entries = entry->next;
+    }
+
+    entry->prev = entry->next = nullptr;
+}
+
+} // namespace Concurrency
+} // namespace Afina
@@ -0,0 +1,32 @@
+#include <afina/coroutine/ConditionVariable.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Mutex.h>
+
+namespace Afina {
+namespace Coroutine {
+
+// See ConditionVariable.h
+void ConditionVariable::wait(Mutex &mutex) {
+    _waiters.push_back(_engine.current());
+    mutex.unlock();
+    _engine.block();
+    mutex.lock();
+}
+
+// See ConditionVariable.h
+void ConditionVariable::notify_one() {
+    if (!_waiters.empty()) {
+        _engine.unblock(_waiters.front());
+        _waiters.pop_front();
+    }
+}
+
+// See ConditionVariable.h
+void ConditionVariable::notify_all() {
+    while (!_waiters.empty()) {
+        notify_one();
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
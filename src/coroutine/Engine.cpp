@@ -1,5 +1,6 @@
 #include <afina/coroutine/Engine.h>
 
+#include <alloca.h>
 #include <setjmp.h>
 #include <stdio.h>
 #include <string.h>
@@ -7,13 +8,208 @@
 namespace Afina {
 namespace Coroutine {
 
-void Engine::Store(context &ctx) {}
+Engine::~Engine() {
+    while (free_ctx != nullptr) {
+        context *ctx = free_ctx;
+        free_ctx = ctx->next;
+        delete[] std::get<0>(ctx->Stack);
+        delete ctx;
+    }
+}
 
-void Engine::Restore(context &ctx) {}
+void Engine::Store(context &ctx) {
+    // Stack could grow in both directions, so region to save is between the bottom remembered in start() and
+    // the address of the local variable
+    char StackEndsHere;
+    if (&StackEndsHere < StackBottom) {
+        ctx.Low = &StackEndsHere;
+        ctx.Hight = StackBottom;
+    } else {
+        ctx.Low = StackBottom;
+        ctx.Hight = &StackEndsHere;
+    }
 
-void Engine::yield() {}
+    uint32_t size = ctx.Hight - ctx.Low;
+    if (std::get<1>(ctx.Stack) < size) {
+        delete[] std::get<0>(ctx.Stack);
+        std::get<0>(ctx.Stack) = new char[size];
+        std::get<1>(ctx.Stack) = size;
+    }
 
-void Engine::sched(void *routine_) {}
+    memcpy(std::get<0>(ctx.Stack), ctx.Low, size);
+}
+
+void Engine::Restore(context &ctx) {
+    // Current frame must not overlap with the region we are going to overwrite, otherwise memcpy destroys
+    // its own stack. Grow the stack past the region in one step, so that copy runs in a frame out of the way
+    char StackEndsHere;
+    if (ctx.Low <= &StackEndsHere && &StackEndsHere <= ctx.Hight) {
+        std::size_t distance = (ctx.Hight == StackBottom) ? &StackEndsHere - ctx.Low : ctx.Hight - &StackEndsHere;
+        volatile char *pad = static_cast<char *>(alloca(distance + restore_pad));
+        pad[0] = 0;
+    }
+    Jump(ctx);
+}
+
+void Engine::Jump(context &ctx) {
+    memcpy(ctx.Low, std::get<0>(ctx.Stack), ctx.Hight - ctx.Low);
+    cur_routine = &ctx;
+    longjmp(ctx.Environment, 1);
+}
+
+void Engine::Unlink(context &ctx) {
+    if (ctx.prev != nullptr) {
+        ctx.prev->next = ctx.next;
+    }
+
+    if (ctx.next != nullptr) {
+        ctx.next->prev = ctx.prev;
+    }
+
+    if (alive == &ctx) {
+        alive = ctx.next;
+    }
+
+    if (alive_tail == &ctx) {
+        alive_tail = ctx.prev;
+    }
+
+    if (blocked == &ctx) {
+        blocked = ctx.next;
+    }
+
+    ctx.prev = ctx.next = nullptr;
+}
+
+void Engine::PushAlive(context &ctx) {
+    ctx.Blocked = false;
+    ctx.next = nullptr;
+    ctx.prev = alive_tail;
+    if (alive_tail != nullptr) {
+        alive_tail->next = &ctx;
+    } else {
+        alive = &ctx;
+    }
+    alive_tail = &ctx;
+}
+
+void Engine::PushBlocked(context &ctx) {
+    ctx.Blocked = true;
+    ctx.prev = nullptr;
+    ctx.next = blocked;
+    if (blocked != nullptr) {
+        blocked->prev = &ctx;
+    }
+    blocked = &ctx;
+}
+
+Engine::context *Engine::Acquire() {
+    if (free_ctx == nullptr) {
+        return new context();
+    }
+
+    context *ctx = free_ctx;
+    free_ctx = ctx->next;
+    free_ctx_size--;
+
+    ctx->next = nullptr;
+    ctx->Blocked = false;
+    return ctx;
+}
+
+void Engine::Release(context *ctx) {
+    if (free_ctx_size >= max_free_ctx) {
+        delete[] std::get<0>(ctx->Stack);
+        delete ctx;
+        return;
+    }
+
+    ctx->prev = nullptr;
+    ctx->next = free_ctx;
+    free_ctx = ctx;
+    free_ctx_size++;
+}
+
+void Engine::Switch() {
+    if (alive != nullptr) {
+        sched(alive);
+        return;
+    }
+
+    // Nobody could be run, give control back to the idle context. Current routine resumes here once
+    // somebody unblocks and schedules it
+    if (cur_routine != nullptr && cur_routine != idle_ctx) {
+        if (setjmp(cur_routine->Environment) > 0) {
+            return;
+        }
+        Store(*cur_routine);
+    }
+    Restore(*idle_ctx);
+}
+
+void Engine::yield() {
+    // Current routine goes to the tail of run queue, so that everybody else gets a chance first
+    if (cur_routine != nullptr && cur_routine != idle_ctx && !cur_routine->Blocked) {
+        Unlink(*cur_routine);
+        PushAlive(*cur_routine);
+    }
+
+    if (alive != nullptr && alive != cur_routine) {
+        sched(alive);
+    }
+}
+
+void Engine::sched(void *routine_) {
+    if (routine_ == nullptr) {
+        yield();
+        return;
+    }
+
+    context *routine = static_cast<context *>(routine_);
+    if (routine == cur_routine || routine->Blocked) {
+        return;
+    }
+
+    // Idle context always resumes from the setjmp in start(), so there is nothing to save for it
+    if (cur_routine != nullptr && cur_routine != idle_ctx) {
+        if (setjmp(cur_routine->Environment) > 0) {
+            return;
+        }
+        Store(*cur_routine);
+    }
+    Restore(*routine);
+}
+
+void Engine::block(void *coro) {
+    context *routine = (coro == nullptr) ? cur_routine : static_cast<context *>(coro);
+    if (routine == nullptr || routine == idle_ctx || routine->Blocked) {
+        return;
+    }
+
+    Unlink(*routine);
+    PushBlocked(*routine);
+    if (routine == cur_routine) {
+        Switch();
+    }
+}
+
+void Engine::unblock(void *coro) {
+    context *routine = static_cast<context *>(coro);
+    if (routine == nullptr || !routine->Blocked) {
+        return;
+    }
+
+    Unlink(*routine);
+    PushAlive(*routine);
+}
+
+void Engine::unblock_all() {
+    while (blocked != nullptr) {
+        context *routine = blocked;
+        Unlink(*routine);
+        PushAlive(*routine);
+    }
+}
 
 } // namespace Coroutine
 } // namespace Afina
@@ -0,0 +1,45 @@
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Mutex.h>
+
+namespace Afina {
+namespace Coroutine {
+
+// See Mutex.h
+void Mutex::lock() {
+    void *self = _engine.current();
+    if (_owner == nullptr) {
+        _owner = self;
+        return;
+    }
+
+    // Owner passes the lock directly to the waiter in unlock(), so once we are back the lock is ours
+    _waiters.push_back(self);
+    while (_owner != self) {
+        _engine.block();
+    }
+}
+
+// See Mutex.h
+bool Mutex::try_lock() {
+    if (_owner != nullptr) {
+        return false;
+    }
+
+    _owner = _engine.current();
+    return true;
+}
+
+// See Mutex.h
+void Mutex::unlock() {
+    if (_waiters.empty()) {
+        _owner = nullptr;
+        return;
+    }
+
+    _owner = _waiters.front();
+    _waiters.pop_front();
+    _engine.unblock(_owner);
+}
+
+} // namespace Coroutine
+} // namespace Afina
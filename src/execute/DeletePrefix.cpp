@@ -0,0 +1,23 @@
+#include <afina/Storage.h>
+#include <afina/execute/DeletePrefix.h>
+
+namespace Afina {
+namespace Execute {
+
+// See DeletePrefix.h
+void DeletePrefix::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (_prefix.empty()) {
+        out = "CLIENT_ERROR prefix expected";
+        return;
+    }
+
+    std::size_t deleted = 0;
+    if (storage.DeletePrefix(_prefix, deleted)) {
+        out = "DELETED " + std::to_string(deleted);
+    } else {
+        out = "SERVER_ERROR storage doesn't support prefix delete";
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,5 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
+#include <afina/metrics/Server.h>
 
 #include <iostream>
 #include <iterator>
@@ -28,14 +29,14 @@ void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
 
     std::stringstream outStream;
 
-    std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
-            continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
+    std::size_t hits = 0;
+    storage.MultiGet(_keys, [this, &outStream, &hits](std::size_t i, const std::string &value) {
+        outStream << "VALUE " << _keys[i] << " 0 " << value.size() << "\r\n";
         outStream << value << "\r\n";
-    }
+        hits++;
+    });
     outStream << "END"; // networking layer should add the last \r\n
+    Metrics::RecordHits(hits, _keys.size() - hits);
 
     out = outStream.str();
 }
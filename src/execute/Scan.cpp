@@ -0,0 +1,28 @@
+#include <afina/Storage.h>
+#include <afina/execute/Scan.h>
+
+#include <sstream>
+
+namespace Afina {
+namespace Execute {
+
+const std::size_t Scan::default_limit;
+
+// See Scan.h
+void Scan::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::stringstream outStream;
+    bool supported = storage.Scan(_prefix, _limit, [&outStream](const std::string &key, const std::string &value) {
+        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
+        outStream << value << "\r\n";
+    });
+
+    if (!supported) {
+        out = "SERVER_ERROR storage doesn't support prefix scan";
+        return;
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+    out = outStream.str();
+}
+
+} // namespace Execute
+} // namespace Afina
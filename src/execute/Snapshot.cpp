@@ -0,0 +1,26 @@
+#include <afina/Snapshot.h>
+#include <afina/Storage.h>
+#include <afina/execute/Snapshot.h>
+
+namespace Afina {
+namespace Execute {
+
+// See Snapshot.h
+void Snapshot::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (_name.empty()) {
+        out = "CLIENT_ERROR snapshot name expected";
+        return;
+    }
+
+    std::string path, error;
+    if (!Backend::SnapshotPath(_name, path, error)) {
+        out = "CLIENT_ERROR " + error;
+    } else if (Backend::ForkSnapshot(storage, path, error)) {
+        out = "OK";
+    } else {
+        out = "SERVER_ERROR " + error;
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
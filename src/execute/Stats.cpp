@@ -1,5 +1,7 @@
+#include <afina/Snapshot.h>
 #include <afina/Storage.h>
 #include <afina/execute/Stats.h>
+#include <afina/metrics/Server.h>
 
 #include <iostream>
 #include <iterator>
@@ -8,7 +10,38 @@
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+/* memcached protocol:
+
+Each statistic sent by the server looks like this:
+
+STAT <name> <value>\r\n
+
+After all the statistics have been transmitted, the server sends the string
+"END\r\n"
+
+*/
+
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<std::pair<std::string, std::string>> stats;
+    if (_group.empty()) {
+        storage.Stats(stats);
+        Backend::SnapshotStats(stats);
+        Metrics::ServerStats(stats);
+    } else if (_group == "latency") {
+        Metrics::LatencyStats(stats);
+    } else {
+        out = "CLIENT_ERROR unknown stats group " + _group;
+        return;
+    }
+
+    std::stringstream outStream;
+    for (auto &stat : stats) {
+        outStream << "STAT " << stat.first << " " << stat.second << "\r\n";
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+
+    out = outStream.str();
+}
 
 } // namespace Execute
 } // namespace Afina
@@ -1,6 +1,8 @@
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <memory>
+#include <sstream>
 
 #include <atomic>
 #include <semaphore.h>
@@ -9,6 +11,7 @@
 
 #include <cxxopts.hpp>
 
+#include <afina/Snapshot.h>
 #include <afina/Storage.h>
 #include <afina/Version.h>
 #include <afina/logging/Service.h>
@@ -21,8 +24,19 @@
 #include "network/st_coroutine/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
 
+#include "storage/ClockCache.h"
+#include "storage/CompressedStorage.h"
+#include "storage/EpochHashCache.h"
+#include "storage/EvictionPolicy.h"
+#include "storage/FlatCombineLRU.h"
+#include "storage/HotKeyStorage.h"
+#include "storage/LoggedStorage.h"
+#include "storage/MmapStorage.h"
+#include "storage/NamespacedStorage.h"
+#include "storage/RWLockLRU.h"
 #include "storage/SimpleLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/TieredStorage.h"
 
 using namespace Afina;
 
@@ -51,12 +65,69 @@ public:
             storage_type = options["storage"].as<std::string>();
         }
 
-        if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
-        } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
-        } else {
-            throw std::runtime_error("Unknown storage type");
+        std::string policy_type = "lru";
+        if (options.count("policy") > 0) {
+            policy_type = options["policy"].as<std::string>();
+        }
+
+        const std::size_t max_size = 1024;
+        storage = MakeStorage(options, storage_type, max_size, policy_type);
+
+        if (options.count("tier-file") > 0) {
+            // Promoter thread writes into memory tier while clients read it, so st_lru won't do
+            auto memory = std::dynamic_pointer_cast<Afina::Backend::SimpleLRU>(storage);
+            if (!memory || !memory->ThreadSafe()) {
+                throw std::runtime_error("Disk tier requires thread safe LRU based storage");
+            }
+
+            std::size_t size = 1024;
+            if (options.count("tier-size") > 0) {
+                size = options["tier-size"].as<int>();
+            }
+            storage = std::make_shared<Afina::Backend::TieredStorage>(memory, options["tier-file"].as<std::string>(),
+                                                                      size << 20);
+        }
+
+        if (options.count("namespaces") > 0) {
+            auto spaces = std::make_shared<Afina::Backend::NamespacedStorage>(storage);
+
+            // Comma separated list of <name>=<max size>[/<policy>], storage type is the same as the default one
+            std::stringstream list(options["namespaces"].as<std::string>());
+            std::string spec;
+            while (std::getline(list, spec, ',')) {
+                std::size_t eq = spec.find('='), slash = spec.find('/');
+                if (eq == std::string::npos || storage_type == "mmap") {
+                    throw std::runtime_error("Bad namespace: " + spec);
+                }
+
+                std::string name = spec.substr(0, eq);
+                std::size_t size = std::stoul(spec.substr(eq + 1, slash - eq - 1));
+                std::string policy = (slash == std::string::npos) ? policy_type : spec.substr(slash + 1);
+                spaces->Add(name, MakeStorage(options, storage_type, size, policy));
+            }
+            storage = spaces;
+        }
+
+        if (options.count("wal") > 0) {
+            storage = std::make_shared<Afina::Backend::LoggedStorage>(storage, options["wal"].as<std::string>());
+        }
+
+        if (options.count("compress-threshold") > 0) {
+            std::size_t threshold = options["compress-threshold"].as<int>();
+            storage = std::make_shared<Afina::Backend::CompressedStorage>(storage, threshold);
+        }
+
+        if (options.count("hot-keys") > 0) {
+            std::size_t top = options["hot-keys"].as<int>();
+            storage = std::make_shared<Afina::Backend::HotKeyStorage>(storage, top, options.count("hot-replicate") > 0);
+        }
+
+        if (options.count("snapshot-dir") > 0) {
+            Afina::Backend::SetSnapshotDirectory(options["snapshot-dir"].as<std::string>());
+        }
+
+        if (options.count("load-snapshot") > 0) {
+            snapshot = options["load-snapshot"].as<std::string>();
         }
 
         // Step 2: Configure network
@@ -88,6 +159,12 @@ public:
 
         log->warn("Start storage");
         storage->Start();
+        if (!snapshot.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            std::size_t loaded = Afina::Backend::LoadSnapshot(*storage, snapshot);
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            log->warn("Loaded {} entries from {} in {} ms", loaded, snapshot, ms.count());
+        }
 
         // TODO: configure network service
         const uint16_t port = 8080;
@@ -107,10 +184,56 @@ public:
     }
 
 private:
+    // Builds base storage of the given type
+    std::shared_ptr<Afina::Storage> MakeStorage(const cxxopts::Options &options, const std::string &type,
+                                                std::size_t max_size, const std::string &policy_type) {
+        std::unique_ptr<Afina::Backend::EvictionPolicy> policy =
+            Afina::Backend::MakeEvictionPolicy(policy_type, max_size);
+
+        if (type == "st_lru") {
+            return std::make_shared<Afina::Backend::SimpleLRU>(max_size, std::move(policy));
+        } else if (type == "mt_lru") {
+            auto lru = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(max_size, std::move(policy));
+            if (options.count("evict-ahead") > 0) {
+                unsigned low, high;
+                std::string watermarks = options["evict-ahead"].as<std::string>();
+                if (sscanf(watermarks.c_str(), "%u,%u", &low, &high) != 2) {
+                    throw std::runtime_error("Bad eviction watermarks: " + watermarks);
+                }
+                lru->EvictAhead(low, high);
+            }
+            return lru;
+        } else if (type == "fc_lru") {
+            return std::make_shared<Afina::Backend::FlatCombineLRU>(max_size, std::move(policy));
+        } else if (type == "rw_lru") {
+            return std::make_shared<Afina::Backend::RWLockLRU>(max_size, std::move(policy));
+        } else if (type == "mt_clock") {
+            return std::make_shared<Afina::Backend::ClockCache>(max_size);
+        } else if (type == "mt_epoch") {
+            return std::make_shared<Afina::Backend::EpochHashCache>(max_size);
+        } else if (type == "mmap") {
+            std::string path = "/dev/shm/afina.cache";
+            if (options.count("mmap-file") > 0) {
+                path = options["mmap-file"].as<std::string>();
+            }
+
+            std::size_t size = 64;
+            if (options.count("mmap-size") > 0) {
+                size = options["mmap-size"].as<int>();
+            }
+            return std::make_shared<Afina::Backend::MmapStorage>(path, size << 20);
+        } else {
+            throw std::runtime_error("Unknown storage type");
+        }
+    }
+
     std::shared_ptr<Logging::Config> logConfig;
     std::shared_ptr<Logging::Service> logService;
 
     std::shared_ptr<Afina::Storage> storage;
+
+    // Snapshot to fill storage from on start
+    std::string snapshot;
     std::shared_ptr<Network::Server> server;
 };
 
@@ -131,6 +254,23 @@ int main(int argc, char **argv) {
         // TODO: use custom cxxopts::value to print options possible values in help message
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
+        options.add_options()("p,policy", "Eviction policy of storage", cxxopts::value<std::string>());
+        options.add_options()("mmap-file", "File backing mmap storage", cxxopts::value<std::string>());
+        options.add_options()("mmap-size", "Size of mmap storage file in megabytes", cxxopts::value<int>());
+        options.add_options()("evict-ahead", "Evict in background from <high>% of mt_lru size down to <low>%",
+                              cxxopts::value<std::string>());
+        options.add_options()("tier-file", "Spill evicted entries into given file", cxxopts::value<std::string>());
+        options.add_options()("tier-size", "Size of the spill file in megabytes", cxxopts::value<int>());
+        options.add_options()("namespaces", "Isolated namespaces: <name>=<max size>[/<policy>],...",
+                              cxxopts::value<std::string>());
+        options.add_options()("wal", "Log writes into file and replay it on start", cxxopts::value<std::string>());
+        options.add_options()("compress-threshold", "Compress values of at least given size", cxxopts::value<int>());
+        options.add_options()("hot-keys", "Track given number of the most read keys", cxxopts::value<int>());
+        options.add_options()("hot-replicate", "Keep per thread copies of the most read keys");
+        options.add_options()("snapshot-dir", "Directory snapshot command writes to, disabled if not set",
+                              cxxopts::value<std::string>());
+        options.add_options()("load-snapshot", "Fill storage from the snapshot file on start",
+                              cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
@@ -0,0 +1,78 @@
+#include <afina/metrics/Histogram.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace Afina {
+namespace Metrics {
+
+const unsigned Histogram::sub_bits;
+const uint64_t Histogram::sub_count;
+const uint64_t Histogram::half_count;
+
+// See Histogram.h
+Histogram::Histogram() : _counts(sub_count + (64 - sub_bits) * half_count, 0) { Clear(); }
+
+// See Histogram.h
+void Histogram::Merge(const Histogram &other) {
+    for (std::size_t i = 0; i < _counts.size(); i++) {
+        _counts[i] += other._counts[i];
+    }
+    _total += other._total;
+    _sum += other._sum;
+    if (other._min < _min) {
+        _min = other._min;
+    }
+    if (other._max > _max) {
+        _max = other._max;
+    }
+}
+
+// See Histogram.h
+void Histogram::Clear() {
+    std::fill(_counts.begin(), _counts.end(), 0);
+    _total = 0;
+    _sum = 0;
+    _min = std::numeric_limits<uint64_t>::max();
+    _max = 0;
+}
+
+// See Histogram.h
+uint64_t Histogram::Percentile(double percentile) const {
+    if (_total == 0) {
+        return 0;
+    }
+
+    // Rank of the value looked for, starting from 1
+    uint64_t rank = uint64_t(percentile / 100 * _total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > _total) {
+        rank = _total;
+    }
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < _counts.size(); i++) {
+        seen += _counts[i];
+        if (seen >= rank) {
+            // Bucket bound could be above anything actually seen
+            uint64_t value = Highest(i);
+            return value < _max ? value : _max;
+        }
+    }
+    return _max;
+}
+
+// See Histogram.h
+uint64_t Histogram::Highest(std::size_t index) {
+    if (index < sub_count) {
+        return index;
+    }
+
+    unsigned shift = (index - sub_count) / half_count + 1;
+    uint64_t sub = (index - sub_count) % half_count;
+    return ((half_count + sub) << shift) + ((uint64_t(1) << shift) - 1);
+}
+
+} // namespace Metrics
+} // namespace Afina
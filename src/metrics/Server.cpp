@@ -0,0 +1,141 @@
+#include <afina/metrics/Server.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <afina/concurrency/ThreadLocal.h>
+#include <afina/metrics/Histogram.h>
+
+namespace Afina {
+namespace Metrics {
+
+namespace {
+
+// Commands latency is tracked for, the last one stands for everything else
+const char *const commands[] = {"get",    "set",   "add",      "append", "prepend",       "replace",
+                                "delete", "stats", "snapshot", "scan",   "delete_prefix", "other"};
+const std::size_t command_count = sizeof(commands) / sizeof(commands[0]);
+
+// Percentiles reported by LatencyStats and their names
+const std::pair<double, const char *> percentiles[] = {{50, "p50"}, {90, "p90"}, {99, "p99"}, {99.9, "p999"}};
+
+struct ThreadMetrics {
+    ThreadMetrics() : latency(command_count), hits(0), misses(0), bytes_in(0), bytes_out(0), opened(0), closed(0) {}
+
+    std::vector<Histogram> latency;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t opened;
+    uint64_t closed;
+};
+
+void Merge(ThreadMetrics &into, const ThreadMetrics &from) {
+    for (std::size_t i = 0; i < command_count; i++) {
+        into.latency[i].Merge(from.latency[i]);
+    }
+    into.hits += from.hits;
+    into.misses += from.misses;
+    into.bytes_in += from.bytes_in;
+    into.bytes_out += from.bytes_out;
+    into.opened += from.opened;
+    into.closed += from.closed;
+}
+
+Concurrency::ThreadLocal<ThreadMetrics> &Threads() {
+    static Concurrency::ThreadLocal<ThreadMetrics> threads(Merge);
+    return threads;
+}
+
+std::string Microseconds(double nanoseconds) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", nanoseconds / 1000);
+    return buf;
+}
+
+} // namespace
+
+// See Server.h
+void RecordCommand(const std::string &name, uint64_t nanoseconds) {
+    std::size_t i = 0;
+    while (i < command_count - 1 && name != commands[i]) {
+        i++;
+    }
+    Threads()->latency[i].Record(nanoseconds);
+}
+
+// See Server.h
+void RecordHits(uint64_t hits, uint64_t misses) {
+    ThreadMetrics &metrics = Threads().get();
+    metrics.hits += hits;
+    metrics.misses += misses;
+}
+
+// See Server.h
+void RecordTraffic(uint64_t in, uint64_t out) {
+    ThreadMetrics &metrics = Threads().get();
+    metrics.bytes_in += in;
+    metrics.bytes_out += out;
+}
+
+// See Server.h
+void ConnectionOpened() { Threads()->opened++; }
+
+// See Server.h
+void ConnectionClosed() { Threads()->closed++; }
+
+// See Server.h
+void ServerStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    std::vector<uint64_t> calls(command_count, 0);
+    uint64_t hits = 0, misses = 0, bytes_in = 0, bytes_out = 0, opened = 0, closed = 0;
+    Threads().visit([&](const ThreadMetrics &metrics) {
+        for (std::size_t i = 0; i < command_count; i++) {
+            calls[i] += metrics.latency[i].Count();
+        }
+        hits += metrics.hits;
+        misses += metrics.misses;
+        bytes_in += metrics.bytes_in;
+        bytes_out += metrics.bytes_out;
+        opened += metrics.opened;
+        closed += metrics.closed;
+    });
+
+    stats.emplace_back("curr_connections", std::to_string(opened - closed));
+    stats.emplace_back("total_connections", std::to_string(opened));
+    for (std::size_t i = 0; i < command_count; i++) {
+        stats.emplace_back(std::string("cmd_") + commands[i], std::to_string(calls[i]));
+    }
+    stats.emplace_back("get_hits", std::to_string(hits));
+    stats.emplace_back("get_misses", std::to_string(misses));
+    stats.emplace_back("bytes_read", std::to_string(bytes_in));
+    stats.emplace_back("bytes_written", std::to_string(bytes_out));
+}
+
+// See Server.h
+void LatencyStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    std::vector<Histogram> latency(command_count);
+    Threads().visit([&latency](const ThreadMetrics &metrics) {
+        for (std::size_t i = 0; i < command_count; i++) {
+            latency[i].Merge(metrics.latency[i]);
+        }
+    });
+
+    for (std::size_t i = 0; i < command_count; i++) {
+        const Histogram &h = latency[i];
+        if (h.Count() == 0) {
+            continue;
+        }
+
+        std::string prefix = std::string(commands[i]) + ":";
+        stats.emplace_back(prefix + "count", std::to_string(h.Count()));
+        stats.emplace_back(prefix + "mean_us", Microseconds(h.Mean()));
+        for (auto &p : percentiles) {
+            stats.emplace_back(prefix + p.second + "_us", Microseconds(h.Percentile(p.first)));
+        }
+        stats.emplace_back(prefix + "max_us", Microseconds(h.Max()));
+    }
+}
+
+} // namespace Metrics
+} // namespace Afina
@@ -1,6 +1,7 @@
 #include "ServerImpl.h"
 
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -20,13 +21,17 @@
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
 #include <afina/logging/Service.h>
+#include <afina/metrics/Server.h>
 
 #include "protocol/Parser.h"
+#include "protocol/ValueBuffer.h"
 
 namespace Afina {
 namespace Network {
 namespace STblocking {
 
+const std::size_t ServerImpl::max_data_block;
+
 // See Server.h
 ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
 
@@ -127,7 +132,7 @@ void ServerImpl::OnRun() {
     // - argument_for_command: buffer stores argument
     std::size_t arg_remains;
     Protocol::Parser parser;
-    std::string argument_for_command;
+    Protocol::ValueBuffer argument_for_command;
     std::unique_ptr<Execute::Command> command_to_execute;
     while (running.load()) {
         _logger->debug("waiting for connection...");
@@ -139,6 +144,7 @@ void ServerImpl::OnRun() {
         if ((client_socket = accept(_server_socket, (struct sockaddr *)&client_addr, &client_addr_len)) == -1) {
             continue;
         }
+        Metrics::ConnectionOpened();
 
         // Got new connection
         if (_logger->should_log(spdlog::level::debug)) {
@@ -170,6 +176,7 @@ void ServerImpl::OnRun() {
             char client_buffer[4096];
             while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
                 _logger->debug("Got {} bytes from socket", readed_bytes);
+                Metrics::RecordTraffic(readed_bytes, 0);
 
                 // Single block of data readed from the socket could trigger inside actions a multiple times,
                 // for example:
@@ -185,6 +192,13 @@ void ServerImpl::OnRun() {
                             // Here we are, current chunk finished some command, process it
                             _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
                             command_to_execute = parser.Build(arg_remains);
+                            if (arg_remains > max_data_block) {
+                                // Skipping the block would take reading all of it, so connection is dropped
+                                const char error[] = "SERVER_ERROR object too large for cache\r\n";
+                                send(client_socket, error, sizeof(error) - 1, 0);
+                                throw std::runtime_error("Data block of " + std::to_string(arg_remains) +
+                                                         " bytes is over the limit");
+                            }
                             if (arg_remains > 0) {
                                 arg_remains += 2;
                             }
@@ -205,22 +219,41 @@ void ServerImpl::OnRun() {
                         _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
                         // There is some parsed command, and now we are reading argument
                         std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                        argument_for_command.append(client_buffer, to_read);
+                        argument_for_command.Append(client_buffer, to_read);
 
                         std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
                         arg_remains -= to_read;
                         readed_bytes -= to_read;
                     }
 
+                    // Rest of the argument goes from socket right into the buffer chunks, bypassing client_buffer
+                    while (command_to_execute && arg_remains > 0 && readed_bytes == 0) {
+                        std::size_t space;
+                        char *tail = argument_for_command.Reserve(arg_remains, space);
+                        ssize_t n = read(client_socket, tail, space);
+                        if (n == 0) {
+                            throw std::runtime_error("Connection closed in the middle of argument");
+                        } else if (n < 0) {
+                            throw std::runtime_error(std::string(strerror(errno)));
+                        }
+
+                        _logger->debug("Read {} bytes of argument, {} remains", n, arg_remains - n);
+                        Metrics::RecordTraffic(n, 0);
+                        argument_for_command.Commit(n);
+                        arg_remains -= n;
+                    }
+
                     // Thre is command & argument - RUN!
                     if (command_to_execute && arg_remains == 0) {
                         _logger->debug("Start command execution");
+                        auto started = std::chrono::steady_clock::now();
 
-                        std::string result;
-                        if (argument_for_command.size()) {
-                            argument_for_command.resize(argument_for_command.size() - 2);
+                        // Argument is assembled once with exact size, without trailing \r\n
+                        std::string result, argument;
+                        if (argument_for_command.Size()) {
+                            argument_for_command.CopyTo(argument, argument_for_command.Size() - 2);
                         }
-                        command_to_execute->Execute(*pStorage, argument_for_command, result);
+                        command_to_execute->Execute(*pStorage, argument, result);
 
                         // Send response
                         result += "\r\n";
@@ -228,9 +261,15 @@ void ServerImpl::OnRun() {
                             throw std::runtime_error("Failed to send response");
                         }
 
+                        // Latency covers execution and sending response, argument transfer depends on the client
+                        auto elapsed = std::chrono::steady_clock::now() - started;
+                        Metrics::RecordCommand(parser.Name(),
+                                               std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                        Metrics::RecordTraffic(0, result.size());
+
                         // Prepare for the next command
                         command_to_execute.reset();
-                        argument_for_command.resize(0);
+                        argument_for_command.Clear();
                         parser.Reset();
                     }
                 } // while (readed_bytes)
@@ -247,10 +286,11 @@ void ServerImpl::OnRun() {
 
         // We are done with this connection
         close(client_socket);
+        Metrics::ConnectionClosed();
 
         // Prepare for the next command: just in case if connection was closed in the middle of executing something
         command_to_execute.reset();
-        argument_for_command.resize(0);
+        argument_for_command.Clear();
         parser.Reset();
     }
 
@@ -2,6 +2,7 @@
 #define AFINA_NETWORK_ST_BLOCKING_SERVER_H
 
 #include <atomic>
+#include <cstddef>
 #include <thread>
 
 #include <afina/network/Server.h>
@@ -20,6 +21,10 @@ namespace STblocking {
  */
 class ServerImpl : public Server {
 public:
+    // Largest data block command could carry. Bigger ones are refused before any of their bytes are read, so that
+    // is also the limit of memory single connection buffers
+    static const std::size_t max_data_block = 64 << 20;
+
     ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
     ~ServerImpl();
 
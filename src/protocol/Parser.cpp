@@ -1,5 +1,6 @@
 #include "Parser.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -8,8 +9,11 @@
 #include <afina/execute/Append.h>
 #include <afina/execute/Command.h>
 #include <afina/execute/Delete.h>
+#include <afina/execute/DeletePrefix.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Scan.h>
 #include <afina/execute/Set.h>
+#include <afina/execute/Snapshot.h>
 #include <afina/execute/Stats.h>
 
 namespace Afina {
@@ -32,9 +36,9 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                     state = State::spKey;
                 } else if (name == "get" || name == "gets") {
                     state = State::sgKey;
-                } else if (name == "stats") {
-                    state = State::sLF;
-                    continue;
+                } else if (name == "stats" || name == "snapshot" || name == "scan" || name == "delete_prefix") {
+                    // Argument is optional, so that missing one is reported by command instead of breaking the stream
+                    state = (c == ' ') ? State::sgKey : State::sLF;
                 } else {
                     throw std::runtime_error("Unknown command name: " + name);
                 }
@@ -177,7 +181,21 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
     } else if (name == "get") {
         return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
     } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
+        return std::unique_ptr<Execute::Command>(new Execute::Stats(keys.empty() ? std::string() : keys[0]));
+    } else if (name == "snapshot") {
+        return std::unique_ptr<Execute::Command>(new Execute::Snapshot(keys.empty() ? std::string() : keys[0]));
+    } else if (name == "scan") {
+        std::size_t limit = Execute::Scan::default_limit;
+        if (keys.size() > 1) {
+            char *end = nullptr;
+            limit = strtoul(keys[1].c_str(), &end, 10);
+            if (keys[1].empty() || *end != '\0') {
+                throw std::runtime_error("Invalid scan limit: " + keys[1]);
+            }
+        }
+        return std::unique_ptr<Execute::Command>(new Execute::Scan(keys.empty() ? std::string() : keys[0], limit));
+    } else if (name == "delete_prefix") {
+        return std::unique_ptr<Execute::Command>(new Execute::DeletePrefix(keys.empty() ? std::string() : keys[0]));
     } else {
         throw std::runtime_error("Unsupported command");
     }
@@ -0,0 +1,49 @@
+#include "ValueBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Afina {
+namespace Protocol {
+
+// See ValueBuffer.h
+void ValueBuffer::Append(const char *data, std::size_t size) {
+    while (size > 0) {
+        std::size_t space;
+        char *tail = Reserve(size, space);
+        memcpy(tail, data, space);
+        Commit(space);
+        data += space;
+        size -= space;
+    }
+}
+
+// See ValueBuffer.h
+char *ValueBuffer::Reserve(std::size_t limit, std::size_t &size) {
+    std::size_t chunk = _size / _chunk_size, offset = _size % _chunk_size;
+    if (chunk == _chunks.size()) {
+        _chunks.emplace_back(new char[_chunk_size]);
+    }
+
+    size = std::min(limit, _chunk_size - offset);
+    return _chunks[chunk].get() + offset;
+}
+
+// See ValueBuffer.h
+void ValueBuffer::CopyTo(std::string &out, std::size_t size) const {
+    size = std::min(size, _size);
+    out.clear();
+    out.reserve(size);
+    for (std::size_t i = 0; out.size() < size; i++) {
+        out.append(_chunks[i].get(), std::min(_chunk_size, size - out.size()));
+    }
+}
+
+// See ValueBuffer.h
+void ValueBuffer::Clear() {
+    _chunks.resize(std::min<std::size_t>(_chunks.size(), 1));
+    _size = 0;
+}
+
+} // namespace Protocol
+} // namespace Afina
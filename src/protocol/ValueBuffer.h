@@ -0,0 +1,72 @@
+#ifndef AFINA_PROTOCOL_VALUE_BUFFER_H
+#define AFINA_PROTOCOL_VALUE_BUFFER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Buffer for command data block
+ * Bytes are kept in fixed size chunks, so growing buffer never moves what is already there: 50 MB value costs
+ * 50 MB plus a chunk, not a series of reallocations each copying everything read so far.
+ *
+ * Network code could read socket right into the buffer: Reserve gives free space at the end, Commit accounts
+ * bytes that were put there. Clear releases everything except the first chunk, so connection doesn't hold
+ * memory of the largest value it has ever seen.
+ *
+ * Chunks end at the network layer: commands and storage take values as std::string, so complete block is still
+ * copied into one string by CopyTo and storage copies it once more into its entry. Buffer only saves the copies
+ * of growing while block is being received
+ */
+class ValueBuffer {
+public:
+    explicit ValueBuffer(std::size_t chunk_size = 64 << 10) : _chunk_size(chunk_size), _size(0) {}
+
+    ValueBuffer(const ValueBuffer &) = delete;
+    ValueBuffer &operator=(const ValueBuffer &) = delete;
+
+    /**
+     * Copies bytes to the end of buffer
+     */
+    void Append(const char *data, std::size_t size);
+
+    /**
+     * Returns pointer to free space at the end of buffer, allocating new chunk if the last one is full.
+     * Space is contiguous and holds at most limit bytes, its size is returned in size
+     */
+    char *Reserve(std::size_t limit, std::size_t &size);
+
+    /**
+     * Accounts size bytes written into space given by the last Reserve
+     */
+    void Commit(std::size_t size) { _size += size; }
+
+    /**
+     * Replaces content of out with the first size bytes of buffer, allocating string once
+     */
+    void CopyTo(std::string &out, std::size_t size) const;
+
+    /**
+     * Drops content, keeps the first chunk for reuse
+     */
+    void Clear();
+
+    std::size_t Size() const { return _size; }
+
+private:
+    const std::size_t _chunk_size;
+
+    // Chunk i holds bytes from i * _chunk_size, all of them but the last are full
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    std::size_t _size;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_VALUE_BUFFER_H
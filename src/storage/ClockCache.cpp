@@ -0,0 +1,198 @@
+#include "ClockCache.h"
+
+#include <mutex>
+
+namespace Afina {
+namespace Backend {
+
+using Afina::Concurrency::SharedLock;
+using Afina::Concurrency::SharedMutex;
+
+// See ClockCache.h
+ClockCache::ClockCache(size_t max_size) : _max_size(max_size), _size(0), _evictions(0), _hand(nullptr) {}
+
+// See ClockCache.h
+ClockCache::~ClockCache() {}
+
+// See MapBasedGlobalLockImpl.h
+bool ClockCache::Put(const std::string &key, const std::string &value) {
+    std::lock_guard<SharedMutex> lock(_lock);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        return Update(*it->second, value);
+    }
+    return Insert(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ClockCache::PutIfAbsent(const std::string &key, const std::string &value) {
+    std::lock_guard<SharedMutex> lock(_lock);
+    if (_index.find(key) != _index.end()) {
+        return false;
+    }
+    return Insert(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ClockCache::Set(const std::string &key, const std::string &value) {
+    std::lock_guard<SharedMutex> lock(_lock);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    return Update(*it->second, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ClockCache::Delete(const std::string &key) {
+    std::lock_guard<SharedMutex> lock(_lock);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    Remove(*it->second);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ClockCache::Get(const std::string &key, std::string &value) {
+    SharedLock<SharedMutex> lock(_lock);
+    return Lookup(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+void ClockCache::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    SharedLock<SharedMutex> lock(_lock);
+    std::string value;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (Lookup(keys[i], value)) {
+            found(i, value);
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void ClockCache::Freeze(const std::function<void()> &func) {
+    std::lock_guard<SharedMutex> lock(_lock);
+    func();
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ClockCache::ForEach(const visit_func &visit) const {
+    for (auto &it : _index) {
+        visit(it.second->key, it.second->value);
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+void ClockCache::Reserve(std::size_t count) {
+    std::lock_guard<SharedMutex> lock(_lock);
+    _index.reserve(_index.size() + count);
+}
+
+// See MapBasedGlobalLockImpl.h
+void ClockCache::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    SharedLock<SharedMutex> lock(_lock);
+    stats.emplace_back("curr_items", std::to_string(_index.size()));
+    stats.emplace_back("bytes", std::to_string(_size));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("evictions", std::to_string(_evictions));
+}
+
+// See ClockCache.h
+bool ClockCache::Lookup(const std::string &key, std::string &value) {
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    Entry &entry = *it->second;
+    value = entry.value;
+
+    // Hot entries are read all the time, check first so that their cache line isn't written on each hit
+    if (!entry.referenced.load(std::memory_order_relaxed)) {
+        entry.referenced.store(true, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// See ClockCache.h
+bool ClockCache::Insert(const std::string &key, const std::string &value) {
+    std::size_t need = key.size() + value.size();
+    if (need > _max_size) {
+        return false;
+    }
+    Evict(need, nullptr);
+
+    std::unique_ptr<Entry> entry(new Entry(key, value));
+    Entry *e = entry.get();
+    _index.emplace(std::cref(e->key), std::move(entry));
+    _size += need;
+
+    // Place entry right behind the hand, so it is examined last
+    if (_hand == nullptr) {
+        e->prev = e->next = e;
+        _hand = e;
+    } else {
+        e->next = _hand;
+        e->prev = _hand->prev;
+        _hand->prev->next = e;
+        _hand->prev = e;
+    }
+    return true;
+}
+
+// See ClockCache.h
+bool ClockCache::Update(Entry &entry, const std::string &value) {
+    if (entry.key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    _size -= entry.value.size();
+    Evict(value.size(), &entry);
+
+    entry.value = value;
+    entry.referenced.store(true, std::memory_order_relaxed);
+    _size += value.size();
+    return true;
+}
+
+// See ClockCache.h
+void ClockCache::Remove(Entry &entry) {
+    if (entry.next == &entry) {
+        _hand = nullptr;
+    } else {
+        entry.prev->next = entry.next;
+        entry.next->prev = entry.prev;
+        if (_hand == &entry) {
+            _hand = entry.next;
+        }
+    }
+
+    _size -= entry.key.size() + entry.value.size();
+    _index.erase(_index.find(entry.key));
+}
+
+// See ClockCache.h
+void ClockCache::Evict(std::size_t extra, const Entry *keep) {
+    while (_size + extra > _max_size && _hand != nullptr) {
+        if (_hand == keep && _hand->next == keep) {
+            // Nothing else left to evict
+            return;
+        }
+
+        Entry *e = _hand;
+        if (e == keep || e->referenced.load(std::memory_order_relaxed)) {
+            e->referenced.store(false, std::memory_order_relaxed);
+            _hand = e->next;
+            continue;
+        }
+        Remove(*e);
+        _evictions++;
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,121 @@
+#ifndef AFINA_STORAGE_CLOCK_CACHE_H
+#define AFINA_STORAGE_CLOCK_CACHE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/SharedMutex.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Thread safe cache with CLOCK eviction
+ * Entries form a ring with the clock hand pointing to the next eviction candidate. A hit just sets reference
+ * bit of the entry, hand clears bits while moving and evicts the first entry found not referenced since the
+ * previous pass, so recently read entries get second chance the same way as in LRU.
+ *
+ * Since reads never change the ring they run under shared lock, only inserts, updates, deletes and eviction
+ * take it exclusively
+ */
+class ClockCache : public Afina::Storage {
+public:
+    ClockCache(size_t max_size = 1024);
+    ~ClockCache();
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override;
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override;
+
+    // Implements Afina::Storage interface
+    void Reserve(std::size_t count) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+private:
+    struct Entry {
+        Entry(const std::string &k, const std::string &v) : key(k), value(v), referenced(false) {}
+
+        std::string key;
+        std::string value;
+
+        // Set by readers concurrently, hence atomic. Relaxed ordering is enough: bit is a hint for eviction
+        // and doesn't guard any data
+        std::atomic<bool> referenced;
+
+        // Neighbours in the ring, changed under exclusive lock only
+        Entry *prev;
+        Entry *next;
+    };
+
+    // Copies value and marks entry referenced, must be called under shared lock at least
+    bool Lookup(const std::string &key, std::string &value);
+
+    // Methods below must be called under exclusive lock
+
+    // Creates new entry for the key, evicting old ones if there is no room for it
+    bool Insert(const std::string &key, const std::string &value);
+
+    // Replaces value of the existing entry, evicting other ones if there is no room for it
+    bool Update(Entry &entry, const std::string &value);
+
+    // Removes entry from ring and index
+    void Remove(Entry &entry);
+
+    // Moves clock hand evicting entries until there is room for extra bytes. keep is never evicted
+    void Evict(std::size_t extra, const Entry *keep);
+
+    // Maximum number of bytes could be stored in this cache, i.e sum of (keys+values)
+    const std::size_t _max_size;
+
+    // Number of bytes currently stored in this cache
+    std::size_t _size;
+
+    // Number of entries removed by clock hand to make room for others
+    uint64_t _evictions;
+
+    // Next entry to be examined by eviction, new entries are placed right behind it
+    Entry *_hand;
+
+    // Index owns all entries
+    std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<Entry>, std::hash<std::string>,
+                       std::equal_to<std::string>>
+        _index;
+
+    // Readers share it, writers own it exclusively
+    Afina::Concurrency::SharedMutex _lock;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CLOCK_CACHE_H
@@ -0,0 +1,123 @@
+#include "CompressedStorage.h"
+
+#include <cstdio>
+
+#include "LZCodec.h"
+
+namespace Afina {
+namespace Backend {
+
+// See CompressedStorage.h
+CompressedStorage::CompressedStorage(std::shared_ptr<Afina::Storage> backend, std::size_t threshold)
+    : _backend(backend), _threshold(threshold), _bytes_in(0), _bytes_stored(0), _compressed(0) {}
+
+// See MapBasedGlobalLockImpl.h
+bool CompressedStorage::Put(const std::string &key, const std::string &value) {
+    return _backend->Put(key, Encode(value));
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompressedStorage::PutIfAbsent(const std::string &key, const std::string &value) {
+    return _backend->PutIfAbsent(key, Encode(value));
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompressedStorage::Set(const std::string &key, const std::string &value) {
+    return _backend->Set(key, Encode(value));
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompressedStorage::Get(const std::string &key, std::string &value) {
+    std::string stored;
+    if (!_backend->Get(key, stored)) {
+        return false;
+    }
+    return Decode(stored, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+void CompressedStorage::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    std::string value;
+    _backend->MultiGet(keys, [this, &found, &value](std::size_t i, const std::string &stored) {
+        if (Decode(stored, value)) {
+            found(i, value);
+        }
+    });
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompressedStorage::ForEach(const visit_func &visit) const {
+    std::string value;
+    return _backend->ForEach([this, &visit, &value](const std::string &key, const std::string &stored) {
+        if (Decode(stored, value)) {
+            visit(key, value);
+        }
+    });
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompressedStorage::Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) {
+    std::string value;
+    return _backend->Scan(prefix, limit, [this, &visit, &value](const std::string &key, const std::string &stored) {
+        if (Decode(stored, value)) {
+            visit(key, value);
+        }
+    });
+}
+
+// See CompressedStorage.h
+void CompressedStorage::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    _backend->Stats(stats);
+
+    uint64_t in = _bytes_in.load(std::memory_order_relaxed);
+    uint64_t stored = _bytes_stored.load(std::memory_order_relaxed);
+    stats.emplace_back("compress_bytes_in", std::to_string(in));
+    stats.emplace_back("compress_bytes_stored", std::to_string(stored));
+    stats.emplace_back("compress_items", std::to_string(_compressed.load(std::memory_order_relaxed)));
+
+    char ratio[32];
+    snprintf(ratio, sizeof(ratio), "%.2f", stored > 0 ? double(in) / stored : 1.0);
+    stats.emplace_back("compress_ratio", ratio);
+}
+
+// See CompressedStorage.h
+std::string CompressedStorage::Encode(const std::string &value) {
+    std::string result;
+    if (value.size() >= _threshold) {
+        result.reserve(value.size() + 1);
+        result.push_back(LZ);
+        LZCodec::Compress(value.data(), value.size(), result);
+    }
+
+    if (result.empty() || result.size() >= value.size() + 1) {
+        // Not worth it
+        result.assign(1, Raw);
+        result.append(value);
+    } else {
+        _compressed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _bytes_in.fetch_add(value.size(), std::memory_order_relaxed);
+    _bytes_stored.fetch_add(result.size(), std::memory_order_relaxed);
+    return result;
+}
+
+// See CompressedStorage.h
+bool CompressedStorage::Decode(const std::string &stored, std::string &value) const {
+    if (stored.empty()) {
+        return false;
+    }
+
+    switch (stored[0]) {
+    case Raw:
+        value.assign(stored, 1, std::string::npos);
+        return true;
+    case LZ:
+        return LZCodec::Decompress(stored.data() + 1, stored.size() - 1, value);
+    default:
+        return false;
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,101 @@
+#ifndef AFINA_STORAGE_COMPRESSED_STORAGE_H
+#define AFINA_STORAGE_COMPRESSED_STORAGE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Storage decorator compressing big values
+ * Each value stored in backend starts with a one byte codec tag. Values of at least threshold bytes are
+ * compressed with LZCodec and stored compressed only if that saves space, others are stored as is. So backend
+ * memory limits apply to compressed sizes and the same cache holds more data.
+ *
+ * Stats() reports number of bytes given by clients and stored in backend for all writes
+ */
+class CompressedStorage : public Afina::Storage {
+public:
+    CompressedStorage(std::shared_ptr<Afina::Storage> backend, std::size_t threshold = 256);
+    ~CompressedStorage() {}
+
+    // Implements Afina::Storage interface
+    void Start() override { _backend->Start(); }
+
+    // Implements Afina::Storage interface
+    void Stop() override { _backend->Stop(); }
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return _backend->ThreadSafe(); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return _backend->Delete(key); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override { _backend->Freeze(func); }
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override;
+
+    // Implements Afina::Storage interface
+    void Reserve(std::size_t count) override { _backend->Reserve(count); }
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override;
+
+    // Implements Afina::Storage interface
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override {
+        return _backend->DeletePrefix(prefix, deleted);
+    }
+
+    // Implements Afina::Storage interface
+    bool WatchEvictions(const evicted_func &evicted) override { return _backend->WatchEvictions(evicted); }
+
+private:
+    enum Codec : char { Raw = 0, LZ = 1 };
+
+    // Returns value in the backend format
+    std::string Encode(const std::string &value);
+
+    // Restores value from the backend format, returns false if it is corrupted
+    bool Decode(const std::string &stored, std::string &value) const;
+
+    std::shared_ptr<Afina::Storage> _backend;
+
+    // Values shorter than that aren't worth compressing
+    const std::size_t _threshold;
+
+    // Totals over all writes: bytes given by clients, bytes stored in backend, values stored compressed
+    std::atomic<uint64_t> _bytes_in;
+    std::atomic<uint64_t> _bytes_stored;
+    std::atomic<uint64_t> _compressed;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_COMPRESSED_STORAGE_H
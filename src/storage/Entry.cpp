@@ -0,0 +1,163 @@
+#include "Entry.h"
+
+#include <new>
+
+namespace Afina {
+namespace Backend {
+
+const std::size_t Entry::max_key_size;
+const std::size_t Entry::max_value_size;
+const std::size_t EntryTable::min_buckets;
+
+// See Entry.h
+std::size_t HashBytes(const char *data, std::size_t size) {
+    // MurmurHash64A
+    const uint64_t m = 0xC6A4A7935BD1E995ULL;
+    const int r = 47;
+
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (size * m);
+    for (; size >= 8; data += 8, size -= 8) {
+        uint64_t k;
+        std::memcpy(&k, data, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    if (size > 0) {
+        uint64_t k = 0;
+        std::memcpy(&k, data, size);
+        h ^= k;
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return static_cast<std::size_t>(h);
+}
+
+// See Entry.h
+Entry *Entry::Create(const char *key, std::size_t key_size, const char *value, std::size_t value_size,
+                     uint32_t flags, uint32_t exptime) {
+    if (key_size > max_key_size || value_size > max_value_size) {
+        return nullptr;
+    }
+
+    void *block = ::operator new(sizeof(Entry) + key_size + value_size);
+    Entry *e = new (block) Entry();
+    e->prev = e->next = e->chain = nullptr;
+    e->flags = flags;
+    e->exptime = exptime;
+    e->value_len = static_cast<uint32_t>(value_size);
+    e->key_len = static_cast<uint8_t>(key_size);
+    e->queue = 0;
+    e->bits = 0;
+
+    char *data = reinterpret_cast<char *>(e + 1);
+    std::memcpy(data, key, key_size);
+    std::memcpy(data + key_size, value, value_size);
+    return e;
+}
+
+// See Entry.h
+void Entry::Destroy(Entry *e) {
+    e->~Entry();
+    ::operator delete(e);
+}
+
+// See Entry.h
+EntryTable::EntryTable() : _mask(min_buckets - 1), _buckets(new Entry *[min_buckets]()), _size(0) {}
+
+// See Entry.h
+EntryTable::~EntryTable() {
+    for (std::size_t i = 0; i <= _mask; i++) {
+        for (Entry *e = _buckets[i]; e != nullptr;) {
+            Entry *next = e->chain;
+            Entry::Destroy(e);
+            e = next;
+        }
+    }
+}
+
+// See Entry.h
+Entry *EntryTable::find(std::size_t hash) const {
+    for (Entry *e = _buckets[hash & _mask]; e != nullptr; e = e->chain) {
+        if (HashBytes(e->key(), e->key_len) == hash) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+// See Entry.h
+void EntryTable::insert(std::size_t hash, Entry &e) {
+    if (_size > _mask) {
+        rehash(2 * (_mask + 1));
+    }
+
+    Entry *&head = _buckets[hash & _mask];
+    e.chain = head;
+    head = &e;
+    _size++;
+}
+
+// See Entry.h
+void EntryTable::replace(std::size_t hash, Entry &old, Entry &e) {
+    Entry **place = link(hash, old);
+    e.chain = old.chain;
+    *place = &e;
+    old.chain = nullptr;
+}
+
+// See Entry.h
+void EntryTable::remove(std::size_t hash, Entry &e) {
+    Entry **place = link(hash, e);
+    *place = e.chain;
+    e.chain = nullptr;
+    _size--;
+}
+
+// See Entry.h
+void EntryTable::reserve(std::size_t count) {
+    std::size_t buckets = _mask + 1;
+    while (buckets < count) {
+        buckets *= 2;
+    }
+    if (buckets > _mask + 1) {
+        rehash(buckets);
+    }
+}
+
+// See Entry.h
+Entry **EntryTable::link(std::size_t hash, const Entry &e) const {
+    Entry **place = &_buckets[hash & _mask];
+    while (*place != &e) {
+        place = &(*place)->chain;
+    }
+    return place;
+}
+
+// See Entry.h
+void EntryTable::rehash(std::size_t buckets) {
+    std::unique_ptr<Entry *[]> table(new Entry *[buckets]());
+    std::size_t mask = buckets - 1;
+    for (std::size_t i = 0; i <= _mask; i++) {
+        for (Entry *e = _buckets[i]; e != nullptr;) {
+            Entry *next = e->chain;
+            Entry *&head = table[HashBytes(e->key(), e->key_len) & mask];
+            e->chain = head;
+            head = e;
+            e = next;
+        }
+    }
+
+    _buckets = std::move(table);
+    _mask = mask;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,242 @@
+#ifndef AFINA_STORAGE_ENTRY_H
+#define AFINA_STORAGE_ENTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * Hash of the byte string, same for the key stored in Entry and for the std::string with the same content
+ */
+std::size_t HashBytes(const char *data, std::size_t size);
+
+inline std::size_t HashBytes(const std::string &s) { return HashBytes(s.data(), s.size()); }
+
+/**
+ * # Cache entry
+ * Single contiguous block: policy links, index chain link, 16 byte item header, key bytes and value bytes right after
+ * it. So the block takes one allocation and 40 bytes on top of key and value instead of two std::string objects plus
+ * their heap buffers. Besides that malloc adds its own header and rounding, and index takes a bucket slot, see
+ * EntryTable
+ *
+ * Blocks are created by Create() and released by Destroy() only. Owned by EntryTable, links and queue tag are
+ * managed by eviction policy. Content never changes, new value means new entry
+ */
+struct Entry {
+    // Maximum length of the key, same as in memcached
+    static const std::size_t max_key_size = 250;
+
+    // Maximum length of the value
+    static const std::size_t max_value_size = UINT32_MAX;
+
+    /**
+     * Allocates entry for the given key and value, returns nullptr if they exceed limits above.
+     * Throws std::bad_alloc if there is no memory
+     */
+    static Entry *Create(const char *key, std::size_t key_size, const char *value, std::size_t value_size,
+                         uint32_t flags = 0, uint32_t exptime = 0);
+
+    static Entry *Create(const std::string &key, const std::string &value) {
+        return Create(key.data(), key.size(), value.data(), value.size());
+    }
+
+    // Releases entry created by Create()
+    static void Destroy(Entry *e);
+
+    // Deleter for std::unique_ptr
+    struct Deleter {
+        void operator()(Entry *e) const { Destroy(e); }
+    };
+
+    const char *key() const { return reinterpret_cast<const char *>(this + 1); }
+    const char *value() const { return key() + key_len; }
+
+    // Payload size, that is what storage limits are about
+    std::size_t size() const { return key_len + value_len; }
+
+    // Position in one of the policy queues
+    Entry *prev;
+    Entry *next;
+
+    // Next entry in the same EntryTable bucket
+    Entry *chain;
+
+    // Item header, 16 bytes
+
+    // Client flags and expiration time, storage interface doesn't carry them yet so they are zero for now
+    uint32_t flags;
+    uint32_t exptime;
+
+    uint32_t value_len;
+    uint8_t key_len;
+
+    // Policy specific tag, usually tells which queue entry sits in
+    uint8_t queue;
+
+    // Reserved for item state bits
+    uint16_t bits;
+
+private:
+    Entry() {}
+    ~Entry() {}
+};
+
+static_assert(sizeof(Entry) == 3 * sizeof(void *) + 16, "Entry header must be packed");
+
+/**
+ * # Reference to the key bytes
+ * Index key which points either to the key of some entry or to the std::string being looked up. Ordered the same
+ * way as std::string
+ */
+struct KeyRef {
+    KeyRef(const char *d, std::size_t s) : data(d), size(s) {}
+    KeyRef(const std::string &s) : data(s.data()), size(s.size()) {}
+    KeyRef(const Entry &e) : data(e.key()), size(e.key_len) {}
+
+    bool operator<(const KeyRef &other) const {
+        int cmp = std::memcmp(data, other.data, size < other.size ? size : other.size);
+        return cmp < 0 || (cmp == 0 && size < other.size);
+    }
+
+    const char *data;
+    std::size_t size;
+};
+
+/**
+ * # Intrusive hash index of entries
+ * Chained hash table over HashBytes of entry keys. Bucket heads are a single array and entries are chained through
+ * Entry::chain, so index allocates nothing per entry: on 64 bit an entry costs 8 byte chain link plus 8 to 16 bytes
+ * of bucket array, since table doubles once it holds more entries than buckets. Keys are in no particular order
+ *
+ * Owns all entries linked into it. Lookups don't modify anything, so they could run concurrently with each other
+ */
+class EntryTable {
+public:
+    // Number of buckets in empty table
+    static const std::size_t min_buckets = 16;
+
+    EntryTable();
+    ~EntryTable();
+
+    EntryTable(const EntryTable &) = delete;
+    EntryTable &operator=(const EntryTable &) = delete;
+
+    // Returns entry with the given key, nullptr if there is no such entry. hash is HashBytes of the key
+    Entry *find(std::size_t hash, const char *key, std::size_t size) const {
+        for (Entry *e = _buckets[hash & _mask]; e != nullptr; e = e->chain) {
+            if (e->key_len == size && std::memcmp(e->key(), key, size) == 0) {
+                return e;
+            }
+        }
+        return nullptr;
+    }
+
+    Entry *find(std::size_t hash, const std::string &key) const { return find(hash, key.data(), key.size()); }
+
+    // Returns entry which key has the given hash, nullptr if there is none. Hashes of different keys could
+    // collide, so entry is not necessarily the one hash was taken from
+    Entry *find(std::size_t hash) const;
+
+    // Takes ownership of the entry, there must be no entry with the same key. Throws std::bad_alloc if table
+    // has to grow and there is no memory, entry is not taken then
+    void insert(std::size_t hash, Entry &e);
+
+    // Puts entry in place of the old one with the same key, ownership of the old entry goes back to the caller
+    void replace(std::size_t hash, Entry &old, Entry &e);
+
+    // Unlinks entry, ownership goes back to the caller
+    void remove(std::size_t hash, Entry &e);
+
+    // Grows table to hold count entries without further rehashing
+    void reserve(std::size_t count);
+
+    std::size_t size() const { return _size; }
+
+    // Calls func for each entry, func must not modify the table
+    template <typename F> void for_each(F func) const {
+        for (std::size_t i = 0; i <= _mask; i++) {
+            for (Entry *e = _buckets[i]; e != nullptr; e = e->chain) {
+                func(*e);
+            }
+        }
+    }
+
+private:
+    // Returns link pointing to the given entry
+    Entry **link(std::size_t hash, const Entry &e) const;
+
+    // Moves all entries to the new array of given number of buckets, which is a power of two
+    void rehash(std::size_t buckets);
+
+    // Number of buckets minus one
+    std::size_t _mask;
+    std::unique_ptr<Entry *[]> _buckets;
+
+    // Number of entries
+    std::size_t _size;
+};
+
+/**
+ * # Intrusive list of entries
+ * Head is the oldest element, tail is the newest one. Keeps track of the number of bytes in entries
+ */
+class EntryList {
+public:
+    EntryList() : _head(nullptr), _tail(nullptr), _bytes(0) {}
+
+    void push_back(Entry &e) {
+        e.prev = _tail;
+        e.next = nullptr;
+        if (_tail != nullptr) {
+            _tail->next = &e;
+        } else {
+            _head = &e;
+        }
+        _tail = &e;
+        _bytes += e.size();
+    }
+
+    void remove(Entry &e) {
+        if (e.prev != nullptr) {
+            e.prev->next = e.next;
+        } else {
+            _head = e.next;
+        }
+
+        if (e.next != nullptr) {
+            e.next->prev = e.prev;
+        } else {
+            _tail = e.prev;
+        }
+
+        e.prev = e.next = nullptr;
+        _bytes -= e.size();
+    }
+
+    // Moves entry to the tail of the list, it must be in the list already
+    void move_back(Entry &e) {
+        if (&e != _tail) {
+            remove(e);
+            push_back(e);
+        }
+    }
+
+    Entry *front() const { return _head; }
+    bool empty() const { return _head == nullptr; }
+    std::size_t bytes() const { return _bytes; }
+
+private:
+    Entry *_head;
+    Entry *_tail;
+    std::size_t _bytes;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_ENTRY_H
@@ -0,0 +1,342 @@
+#include "EpochHashCache.h"
+
+#include <algorithm>
+
+namespace Afina {
+namespace Backend {
+
+using Afina::Concurrency::EpochManager;
+
+namespace {
+
+std::size_t RoundUp(std::size_t n) {
+    std::size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+const std::size_t EpochHashCache::lookup_group;
+
+// See EpochHashCache.h
+EpochHashCache::EpochHashCache(size_t max_size, size_t shards) : _max_size(max_size), _size(0), _items(0), _evictions(0) {
+    // Table doesn't grow once filled, so it is sized for small entries to keep chains short
+    const std::size_t average_entry = 64;
+    std::size_t buckets = RoundUp(std::max<std::size_t>(max_size / average_entry, 64));
+    _mask = buckets - 1;
+    _buckets.reset(new std::atomic<Node *>[buckets]);
+    for (std::size_t i = 0; i < buckets; i++) {
+        _buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    // Shards should be big enough for clock to be meaningful
+    if (shards == 0) {
+        const std::size_t min_shard = 64 * 1024;
+        shards = std::min<std::size_t>(std::max<std::size_t>(max_size / min_shard, 1), 64);
+    }
+    _shards_count = std::min(RoundUp(shards), buckets);
+    _shards.reset(new Shard[_shards_count]);
+}
+
+// See EpochHashCache.h
+EpochHashCache::~EpochHashCache() {
+    for (std::size_t i = 0; i <= _mask; i++) {
+        Node *node = _buckets[i].load(std::memory_order_relaxed);
+        while (node != nullptr) {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+bool EpochHashCache::Put(const std::string &key, const std::string &value) {
+    std::size_t hash = _hash(key);
+    Shard &shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    return Store(shard, Find(hash, key), hash, key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool EpochHashCache::PutIfAbsent(const std::string &key, const std::string &value) {
+    std::size_t hash = _hash(key);
+    Shard &shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    std::atomic<Node *> &link = Find(hash, key);
+    if (link.load(std::memory_order_relaxed) != nullptr) {
+        return false;
+    }
+    return Store(shard, link, hash, key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool EpochHashCache::Set(const std::string &key, const std::string &value) {
+    std::size_t hash = _hash(key);
+    Shard &shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    std::atomic<Node *> &link = Find(hash, key);
+    if (link.load(std::memory_order_relaxed) == nullptr) {
+        return false;
+    }
+    return Store(shard, link, hash, key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool EpochHashCache::Delete(const std::string &key) {
+    std::size_t hash = _hash(key);
+    Shard &shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    std::atomic<Node *> &link = Find(hash, key);
+    if (link.load(std::memory_order_relaxed) == nullptr) {
+        return false;
+    }
+
+    Remove(shard, link);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool EpochHashCache::Get(const std::string &key, std::string &value) {
+    EpochManager::Guard guard(_epoch);
+    Node *node = Lookup(_hash(key), key);
+    if (node == nullptr) {
+        return false;
+    }
+
+    value = node->value;
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+void EpochHashCache::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    Node *nodes[lookup_group];
+
+    EpochManager::Guard guard(_epoch);
+    for (std::size_t base = 0; base < keys.size(); base += lookup_group) {
+        std::size_t count = std::min(lookup_group, keys.size() - base);
+        LookupGroup(&keys[base], count, nodes);
+
+        for (std::size_t i = 0; i < count; i++) {
+            if (nodes[i] != nullptr) {
+                found(base + i, nodes[i]->value);
+            }
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void EpochHashCache::Freeze(const std::function<void()> &func) {
+    // Shards are always locked in order, so freezing threads never deadlock each other
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(_shards_count);
+    for (std::size_t i = 0; i < _shards_count; i++) {
+        locks.emplace_back(_shards[i].lock);
+    }
+    func();
+}
+
+// See MapBasedGlobalLockImpl.h
+bool EpochHashCache::ForEach(const visit_func &visit) const {
+    for (std::size_t i = 0; i <= _mask; i++) {
+        for (Node *node = _buckets[i].load(std::memory_order_acquire); node != nullptr;
+             node = node->next.load(std::memory_order_acquire)) {
+            visit(node->key, node->value);
+        }
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+void EpochHashCache::Reserve(std::size_t count) {
+    // Sizing for the tiniest entries possible would let a wild count take all memory
+    const std::size_t min_entry = 16;
+    std::size_t buckets = RoundUp(std::min(count, _max_size / min_entry));
+    if (buckets <= _mask + 1) {
+        return;
+    }
+
+    // Nodes are never moved between chains, so only empty table could be replaced
+    for (std::size_t i = 0; i <= _mask; i++) {
+        if (_buckets[i].load(std::memory_order_relaxed) != nullptr) {
+            return;
+        }
+    }
+
+    _mask = buckets - 1;
+    _buckets.reset(new std::atomic<Node *>[buckets]);
+    for (std::size_t i = 0; i < buckets; i++) {
+        _buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void EpochHashCache::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    stats.emplace_back("curr_items", std::to_string(_items.load(std::memory_order_relaxed)));
+    stats.emplace_back("bytes", std::to_string(_size.load(std::memory_order_relaxed)));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("evictions", std::to_string(_evictions.load(std::memory_order_relaxed)));
+}
+
+// See EpochHashCache.h
+EpochHashCache::Node *EpochHashCache::Probe(Node *node, std::size_t hash, const std::string &key) {
+    for (; node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+        if (node->hash == hash && node->key == key) {
+            // Check first so that hot node cache line isn't written on each hit
+            if (!node->referenced.load(std::memory_order_relaxed)) {
+                node->referenced.store(true, std::memory_order_relaxed);
+            }
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+// See EpochHashCache.h
+void EpochHashCache::LookupGroup(const std::string *keys, std::size_t count, Node **nodes) {
+    std::size_t hashes[lookup_group];
+
+    // Stage 1: hash keys, request bucket heads
+    for (std::size_t i = 0; i < count; i++) {
+        hashes[i] = _hash(keys[i]);
+        __builtin_prefetch(&BucketOf(hashes[i]));
+    }
+
+    // Stage 2: read heads, request first nodes of the chains
+    for (std::size_t i = 0; i < count; i++) {
+        nodes[i] = BucketOf(hashes[i]).load(std::memory_order_acquire);
+        if (nodes[i] != nullptr) {
+            __builtin_prefetch(nodes[i]);
+        }
+    }
+
+    // Stage 3: request key bytes of nodes likely to match, long keys live out of node
+    for (std::size_t i = 0; i < count; i++) {
+        if (nodes[i] != nullptr && nodes[i]->hash == hashes[i]) {
+            __builtin_prefetch(nodes[i]->key.data());
+        }
+    }
+
+    // Stage 4: compare keys. Collisions are rare, so the rest of the chain is walked the usual way
+    for (std::size_t i = 0; i < count; i++) {
+        nodes[i] = Probe(nodes[i], hashes[i], keys[i]);
+    }
+}
+
+// See EpochHashCache.h
+std::atomic<EpochHashCache::Node *> &EpochHashCache::Find(std::size_t hash, const std::string &key) {
+    std::atomic<Node *> *link = &BucketOf(hash);
+    for (Node *node = link->load(std::memory_order_relaxed); node != nullptr;
+         node = link->load(std::memory_order_relaxed)) {
+        if (node->hash == hash && node->key == key) {
+            break;
+        }
+        link = &node->next;
+    }
+    return *link;
+}
+
+// See EpochHashCache.h
+bool EpochHashCache::Store(Shard &shard, std::atomic<Node *> &link, std::size_t hash, const std::string &key,
+                           const std::string &value) {
+    std::size_t need = key.size() + value.size();
+    if (need > _max_size) {
+        return false;
+    }
+
+    Node *old = link.load(std::memory_order_relaxed);
+    if (old != nullptr) {
+        _size.fetch_sub(old->size(), std::memory_order_relaxed);
+    }
+    Evict(shard, need, old);
+
+    // Eviction could unlink the predecessor, so look the place up again
+    std::atomic<Node *> &place = Find(hash, key);
+    Node *node = new Node(hash, key, value);
+    node->next.store(old != nullptr ? old->next.load(std::memory_order_relaxed) : nullptr,
+                     std::memory_order_relaxed);
+    node->referenced.store(old != nullptr, std::memory_order_relaxed);
+
+    if (old != nullptr) {
+        // New node takes place of the old one in the clock ring
+        if (old->next_ring == old) {
+            node->prev_ring = node->next_ring = node;
+        } else {
+            node->prev_ring = old->prev_ring;
+            node->next_ring = old->next_ring;
+            node->prev_ring->next_ring = node;
+            node->next_ring->prev_ring = node;
+        }
+        if (shard.hand == old) {
+            shard.hand = node;
+        }
+    } else if (shard.hand == nullptr) {
+        node->prev_ring = node->next_ring = node;
+        shard.hand = node;
+    } else {
+        // Right behind the hand, so that it is examined last
+        node->next_ring = shard.hand;
+        node->prev_ring = shard.hand->prev_ring;
+        node->prev_ring->next_ring = node;
+        shard.hand->prev_ring = node;
+    }
+
+    // Publish: release store makes node content visible to readers following the link
+    place.store(node, std::memory_order_release);
+    _size.fetch_add(need, std::memory_order_relaxed);
+
+    if (old != nullptr) {
+        _epoch.retire(old);
+    } else {
+        _items.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// See EpochHashCache.h
+void EpochHashCache::Remove(Shard &shard, std::atomic<Node *> &link) {
+    Node *node = link.load(std::memory_order_relaxed);
+    link.store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+
+    if (node->next_ring == node) {
+        shard.hand = nullptr;
+    } else {
+        node->prev_ring->next_ring = node->next_ring;
+        node->next_ring->prev_ring = node->prev_ring;
+        if (shard.hand == node) {
+            shard.hand = node->next_ring;
+        }
+    }
+
+    _size.fetch_sub(node->size(), std::memory_order_relaxed);
+    _items.fetch_sub(1, std::memory_order_relaxed);
+    _epoch.retire(node);
+}
+
+// See EpochHashCache.h
+void EpochHashCache::Evict(Shard &shard, std::size_t extra, const Node *keep) {
+    while (_size.load(std::memory_order_relaxed) + extra > _max_size && shard.hand != nullptr) {
+        Node *node = shard.hand;
+        if (node == keep && node->next_ring == keep) {
+            // Nothing else left in this shard
+            return;
+        }
+
+        if (node == keep || node->referenced.load(std::memory_order_relaxed)) {
+            node->referenced.store(false, std::memory_order_relaxed);
+            shard.hand = node->next_ring;
+            continue;
+        }
+        Remove(shard, Find(node->hash, node->key));
+        _evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,168 @@
+#ifndef AFINA_STORAGE_EPOCH_HASH_CACHE_H
+#define AFINA_STORAGE_EPOCH_HASH_CACHE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Epoch.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Thread safe cache with lock free reads
+ * Index is a fixed size hash table with singly linked chains. Nodes are immutable once published: update creates
+ * new node and swaps it into the chain, delete just unlinks. So reader walks chains without any locks, and unlinked
+ * nodes are freed through epoch based reclamation once no reader could hold them anymore.
+ *
+ * Writers are serialized per shard, each shard owns a subset of buckets and evicts its own entries with CLOCK: reader
+ * hit sets reference bit of the node, the shard clock hand skips referenced nodes once. Total size is shared by
+ * all shards, concurrent writers could exceed it by at most one entry per shard for a short while
+ */
+class EpochHashCache : public Afina::Storage {
+public:
+    // Number of lookups MultiGet interleaves, about the number of cache misses core could have in flight
+    static const std::size_t lookup_group = 16;
+
+    /**
+     * shards is the number of independent writer locks, rounded up to a power of two; 0 picks it by max_size
+     */
+    EpochHashCache(size_t max_size = 1024, size_t shards = 0);
+    ~EpochHashCache();
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override;
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override;
+
+    // Implements Afina::Storage interface, table is rebuilt only while it is empty
+    void Reserve(std::size_t count) override;
+
+    // Implements Afina::Storage interface, counters are read one by one, so they could be slightly inconsistent
+    // with each other under concurrent writes
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+private:
+    struct Node {
+        Node(std::size_t h, const std::string &k, const std::string &v)
+            : hash(h), key(k), value(v), referenced(false), next(nullptr), prev_ring(nullptr), next_ring(nullptr) {}
+
+        std::size_t size() const { return key.size() + value.size(); }
+
+        const std::size_t hash;
+        const std::string key;
+        const std::string value;
+
+        // Set by readers on hit, cleared by clock hand
+        std::atomic<bool> referenced;
+
+        // Next node in the bucket chain
+        std::atomic<Node *> next;
+
+        // Position in the shard clock ring, writers only
+        Node *prev_ring;
+        Node *next_ring;
+    };
+
+    struct Shard {
+        Shard() : hand(nullptr) {}
+
+        // Serializes writers of all buckets belonging to the shard
+        std::mutex lock;
+
+        // Clock hand over the ring of all shard nodes
+        Node *hand;
+    };
+
+    // Returns shard owning the bucket of the given hash
+    Shard &ShardOf(std::size_t hash) { return _shards[hash & (_shards_count - 1)]; }
+
+    // Returns head of the bucket chain for the given hash
+    std::atomic<Node *> &BucketOf(std::size_t hash) { return _buckets[hash & _mask]; }
+
+    // Returns node of the key and marks it referenced, nullptr if there is no such key. Must be called
+    // inside epoch guard, node stays valid until guard is destroyed
+    Node *Lookup(std::size_t hash, const std::string &key) {
+        return Probe(BucketOf(hash).load(std::memory_order_acquire), hash, key);
+    }
+
+    // Same as Lookup, but walks chain starting from the given node
+    Node *Probe(Node *node, std::size_t hash, const std::string &key);
+
+    // Looks up count (up to lookup_group) keys at once. Instead of chasing pointers key by key each stage
+    // issues prefetches for the whole group and the next stage consumes them, so memory latency of independent
+    // lookups overlaps. Must be called inside epoch guard, nodes stay valid until guard is destroyed
+    void LookupGroup(const std::string *keys, std::size_t count, Node **nodes);
+
+    // Methods below must be called under the lock of the shard key belongs to
+
+    // Returns link pointing to the node with given key, or to nullptr at the end of chain if there is no such key
+    std::atomic<Node *> &Find(std::size_t hash, const std::string &key);
+
+    // Puts new value of the key in place of the node link points to, either existing node or chain end
+    bool Store(Shard &shard, std::atomic<Node *> &link, std::size_t hash, const std::string &key,
+               const std::string &value);
+
+    // Unlinks node link points to and retires it
+    void Remove(Shard &shard, std::atomic<Node *> &link);
+
+    // Evicts shard nodes until there is room for extra bytes. keep is never evicted
+    void Evict(Shard &shard, std::size_t extra, const Node *keep);
+
+    // Maximum number of bytes could be stored in this cache, i.e sum of (keys+values)
+    const std::size_t _max_size;
+
+    // Number of bytes currently stored in this cache
+    std::atomic<std::size_t> _size;
+
+    // Number of entries currently stored in this cache
+    std::atomic<std::size_t> _items;
+
+    // Number of entries removed by clock hands to make room for others
+    std::atomic<uint64_t> _evictions;
+
+    std::hash<std::string> _hash;
+
+    // Bucket heads, number of buckets is a power of two
+    std::size_t _mask;
+    std::unique_ptr<std::atomic<Node *>[]> _buckets;
+
+    // Writer shards, number of shards is a power of two not greater than the number of buckets
+    std::size_t _shards_count;
+    std::unique_ptr<Shard[]> _shards;
+
+    // Reclaims nodes unlinked from chains
+    Afina::Concurrency::EpochManager _epoch;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_EPOCH_HASH_CACHE_H
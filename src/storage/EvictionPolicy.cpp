@@ -0,0 +1,28 @@
+#include "EvictionPolicy.h"
+
+#include <stdexcept>
+
+#include "policy/LRUPolicy.h"
+#include "policy/SLRUPolicy.h"
+#include "policy/TinyLFUPolicy.h"
+#include "policy/TwoQueuePolicy.h"
+
+namespace Afina {
+namespace Backend {
+
+// See EvictionPolicy.h
+std::unique_ptr<EvictionPolicy> MakeEvictionPolicy(const std::string &name, std::size_t max_size) {
+    if (name == "lru") {
+        return std::unique_ptr<EvictionPolicy>(new LRUPolicy());
+    } else if (name == "slru") {
+        return std::unique_ptr<EvictionPolicy>(new SLRUPolicy(max_size));
+    } else if (name == "2q") {
+        return std::unique_ptr<EvictionPolicy>(new TwoQueuePolicy(max_size));
+    } else if (name == "tinylfu") {
+        return std::unique_ptr<EvictionPolicy>(new TinyLFUPolicy(max_size));
+    }
+    throw std::runtime_error("Unknown eviction policy");
+}
+
+} // namespace Backend
+} // namespace Afina
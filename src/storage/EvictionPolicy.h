@@ -0,0 +1,68 @@
+#ifndef AFINA_STORAGE_EVICTION_POLICY_H
+#define AFINA_STORAGE_EVICTION_POLICY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "Entry.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Eviction policy
+ * Decides which entry leaves the cache once it is out of space. Storage notifies policy about all
+ * changes in the set of entries and about all accesses, policy keeps entries in its own queues.
+ *
+ * Sizes of entries never change while they are known to the policy: storage erases entry before changing
+ * value and reinserts it after that
+ */
+class EvictionPolicy {
+public:
+    EvictionPolicy() {}
+    virtual ~EvictionPolicy() {}
+
+    /**
+     * New entry appeared in the cache
+     */
+    virtual void Insert(Entry &e) = 0;
+
+    /**
+     * Existing entry was read or updated
+     */
+    virtual void Access(Entry &e) = 0;
+
+    /**
+     * Lookup of the key not present in the cache, frequency based policies count it as well. hash is
+     * HashBytes of the key
+     */
+    virtual void Miss(std::size_t hash) {}
+
+    /**
+     * Entry leaves the cache, either because of Victim() call or because of explicit delete
+     */
+    virtual void Erase(Entry &e, bool evicted) = 0;
+
+    /**
+     * Entry erased with evicted = false comes back, so that storage could change its size. Policy puts it back
+     * into the queue it was in before
+     */
+    virtual void Reinsert(Entry &e) = 0;
+
+    /**
+     * Returns entry to be evicted next, nullptr if policy has no entries
+     */
+    virtual Entry *Victim() = 0;
+};
+
+/**
+ * Creates eviction policy by name: "lru", "slru", "2q" or "tinylfu". max_size is the capacity of the
+ * cache in bytes, policies use it to size internal queues. Throws std::runtime_error for unknown names
+ */
+std::unique_ptr<EvictionPolicy> MakeEvictionPolicy(const std::string &name, std::size_t max_size);
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_EVICTION_POLICY_H
@@ -0,0 +1,183 @@
+#ifndef AFINA_STORAGE_FLAT_COMBINE_LRU_H
+#define AFINA_STORAGE_FLAT_COMBINE_LRU_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <afina/concurrency/FlatCombine.h>
+
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SimpleLRU thread safe version built on flat combining
+ * LRU promotion turns every Get into a write, so there is nothing to gain from reader-writer locks. Instead
+ * threads publish their operations and a single combiner applies them in batch, keeping LRU structures in
+ * the cache of one core.
+ *
+ * Operations of the batch are independent: if one throws, e.g. bad_alloc or exception from the caller's callback,
+ * only its caller gets the exception, the rest of the batch is applied as usual
+ */
+class FlatCombineLRU : public SimpleLRU {
+public:
+    FlatCombineLRU(size_t max_size = 1024, std::unique_ptr<EvictionPolicy> policy = nullptr)
+        : SimpleLRU(max_size, std::move(policy)),
+          _combine([this](Operation *const *ops, std::size_t n) { Apply(ops, n); }) {}
+    ~FlatCombineLRU() {}
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value) override {
+        return Execute(Operation::Type::Put, key, &value, nullptr);
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return Execute(Operation::Type::PutIfAbsent, key, &value, nullptr);
+    }
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value) override {
+        return Execute(Operation::Type::Set, key, &value, nullptr);
+    }
+
+    // see SimpleLRU.h
+    bool Delete(const std::string &key) override { return Execute(Operation::Type::Delete, key, nullptr, nullptr); }
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, std::string &value) override {
+        return Execute(Operation::Type::Get, key, nullptr, &value);
+    }
+
+    // see SimpleLRU.h
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override {
+        // Whole batch is a single operation, so it is applied at once by whoever is combiner
+        Operation op{Operation::Type::MultiGet, nullptr, nullptr, nullptr, false, &keys, &found, nullptr, nullptr};
+        Run(op);
+    }
+
+    // see SimpleLRU.h
+    void Freeze(const std::function<void()> &func) override {
+        // Combiner is the only thread touching the cache, so function runs as an operation
+        Operation op{Operation::Type::Freeze, nullptr, nullptr, nullptr, false, nullptr, nullptr, &func, nullptr};
+        Run(op);
+    }
+
+    // see SimpleLRU.h
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override {
+        // Rare and long, so it runs as exclusive function instead of having own operation type
+        bool result = false;
+        Freeze([this, &prefix, limit, &visit, &result]() { result = SimpleLRU::Scan(prefix, limit, visit); });
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override {
+        bool result = false;
+        Freeze([this, &prefix, &deleted, &result]() { result = SimpleLRU::DeletePrefix(prefix, deleted); });
+        return result;
+    }
+
+    // see SimpleLRU.h
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override {
+        Freeze([this, &stats]() { SimpleLRU::Stats(stats); });
+    }
+
+private:
+    // Storage call published for the combiner
+    struct Operation {
+        enum class Type { Put, PutIfAbsent, Set, Delete, Get, MultiGet, Freeze };
+
+        Type type;
+        const std::string *key;
+        const std::string *in;
+        std::string *out;
+        bool result;
+
+        // MultiGet arguments
+        const std::vector<std::string> *keys;
+        const found_func *found;
+
+        // Freeze argument
+        const std::function<void()> *func;
+
+        // Exception thrown while applying the operation, rethrown to its caller only
+        std::exception_ptr error;
+    };
+
+    bool Execute(Operation::Type type, const std::string &key, const std::string *in, std::string *out) {
+        Operation op{type, &key, in, out, false, nullptr, nullptr, nullptr, nullptr};
+        Run(op);
+        return op.result;
+    }
+
+    // Passes operation to combiner and rethrows whatever it has thrown
+    void Run(Operation &op) {
+        _combine.execute(op);
+        if (op.error) {
+            std::rethrow_exception(op.error);
+        }
+    }
+
+    // Runs by combiner with exclusive access to the cache
+    void Apply(Operation *const *ops, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            try {
+                ApplyOne(*ops[i]);
+            } catch (...) {
+                ops[i]->error = std::current_exception();
+            }
+        }
+    }
+
+    // Runs by combiner as part of Apply
+    void ApplyOne(Operation &op) {
+        switch (op.type) {
+        case Operation::Type::Put:
+            op.result = SimpleLRU::Put(*op.key, *op.in);
+            break;
+        case Operation::Type::PutIfAbsent:
+            op.result = SimpleLRU::PutIfAbsent(*op.key, *op.in);
+            break;
+        case Operation::Type::Set:
+            op.result = SimpleLRU::Set(*op.key, *op.in);
+            break;
+        case Operation::Type::Delete:
+            op.result = SimpleLRU::Delete(*op.key);
+            break;
+        case Operation::Type::Get:
+            op.result = SimpleLRU::Get(*op.key, *op.out);
+            break;
+        case Operation::Type::MultiGet:
+            ApplyMultiGet(*op.keys, *op.found);
+            break;
+        case Operation::Type::Freeze:
+            (*op.func)();
+            break;
+        }
+    }
+
+    // Runs by combiner as part of Apply
+    void ApplyMultiGet(const std::vector<std::string> &keys, const found_func &found) {
+        std::string value;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (SimpleLRU::Get(keys[i], value)) {
+                found(i, value);
+            }
+        }
+    }
+
+    Afina::Concurrency::FlatCombine<Operation> _combine;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FLAT_COMBINE_LRU_H
@@ -0,0 +1,184 @@
+#include "HotKeyStorage.h"
+
+#include <algorithm>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Number of samples between recomputations of top keys
+const std::size_t refresh_period = 256;
+
+} // namespace
+
+// See HotKeyStorage.h
+HotKeyStorage::HotKeyStorage(std::shared_ptr<Afina::Storage> backend, std::size_t top, bool replicate,
+                             unsigned sample)
+    : _backend(backend), _top(top), _replicate(replicate), _sample(std::max(sample, 1u)), _tracker(8 * top),
+      _samples(0), _generation(1),
+      _threads([](ThreadState &into, const ThreadState &from) { into.hits += from.hits; }) {
+    // Evicted copy isn't stale yet, but once key is added again it is
+    _watched = _replicate && _backend->WatchEvictions([this](const std::string &key) { Invalidate(key, false); });
+}
+
+// See HotKeyStorage.h
+HotKeyStorage::~HotKeyStorage() {
+    if (_watched) {
+        _backend->WatchEvictions(evicted_func());
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+bool HotKeyStorage::Put(const std::string &key, const std::string &value) {
+    bool result = _backend->Put(key, value);
+    Invalidate(key, true);
+    return result;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool HotKeyStorage::PutIfAbsent(const std::string &key, const std::string &value) {
+    bool result = _backend->PutIfAbsent(key, value);
+    if (result) {
+        Invalidate(key, true);
+    }
+    return result;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool HotKeyStorage::Set(const std::string &key, const std::string &value) {
+    bool result = _backend->Set(key, value);
+    Invalidate(key, true);
+    return result;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool HotKeyStorage::Delete(const std::string &key) {
+    bool result = _backend->Delete(key);
+    Invalidate(key, false);
+    return result;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool HotKeyStorage::DeletePrefix(const std::string &prefix, std::size_t &deleted) {
+    if (!_backend->DeletePrefix(prefix, deleted)) {
+        return false;
+    }
+
+    // Checking each hot key against prefix isn't worth it, copies are just taken again
+    if (_replicate && deleted > 0) {
+        _generation.fetch_add(1);
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool HotKeyStorage::Get(const std::string &key, std::string &value) {
+    ThreadState &state = _threads.get();
+    Sample(state, key);
+    if (!_replicate) {
+        return _backend->Get(key, value);
+    }
+
+    if (state.generation != _generation.load()) {
+        std::lock_guard<std::mutex> lock(_lock);
+        state.copies.clear();
+        state.hot = _hot;
+        state.generation = _generation.load(std::memory_order_relaxed);
+    }
+
+    auto it = state.copies.find(key);
+    if (it != state.copies.end()) {
+        value = it->second;
+        state.hits++;
+        return true;
+    }
+
+    // Generation was checked before the read, so any write that could make this copy stale bumps it later
+    if (!_backend->Get(key, value)) {
+        return false;
+    }
+    if (state.hot.count(key) > 0) {
+        state.copies[key] = value;
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+void HotKeyStorage::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    if (_replicate) {
+        // Keys go through copies one by one
+        Storage::MultiGet(keys, found);
+        return;
+    }
+
+    ThreadState &state = _threads.get();
+    for (const std::string &key : keys) {
+        Sample(state, key);
+    }
+    _backend->MultiGet(keys, found);
+}
+
+// See HotKeyStorage.h
+void HotKeyStorage::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    _backend->Stats(stats);
+
+    std::vector<SpaceSaving::Counter> top;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        top = _tracker.Top(_top);
+    }
+    for (const SpaceSaving::Counter &counter : top) {
+        stats.emplace_back("hot:" + counter.key, std::to_string(counter.count * _sample));
+    }
+
+    if (_replicate) {
+        uint64_t hits =
+            _threads.aggregate(uint64_t(0), [](uint64_t sum, const ThreadState &s) { return sum + s.hits; });
+        stats.emplace_back("hot_copy_hits", std::to_string(hits));
+    }
+}
+
+// See HotKeyStorage.h
+void HotKeyStorage::Sample(ThreadState &state, const std::string &key) {
+    if (state.countdown > 0) {
+        state.countdown--;
+        return;
+    }
+    state.countdown = _sample - 1;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _tracker.Add(key);
+    if (++_samples < refresh_period) {
+        return;
+    }
+    _samples = 0;
+
+    std::unordered_set<std::string> hot;
+    for (const SpaceSaving::Counter &counter : _tracker.Top(_top)) {
+        hot.insert(counter.key);
+    }
+    if (hot != _hot) {
+        _hot.swap(hot);
+        _generation.fetch_add(1);
+    }
+}
+
+// See HotKeyStorage.h
+void HotKeyStorage::Invalidate(const std::string &key, bool write) {
+    if (!_replicate) {
+        return;
+    }
+    if (write && !_watched) {
+        _generation.fetch_add(1);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_hot.count(key) > 0) {
+        _generation.fetch_add(1);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
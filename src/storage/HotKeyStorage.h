@@ -0,0 +1,139 @@
+#ifndef AFINA_STORAGE_HOT_KEY_STORAGE_H
+#define AFINA_STORAGE_HOT_KEY_STORAGE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/ThreadLocal.h>
+
+#include "SpaceSaving.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Storage decorator tracking the most read keys
+ * Every sample-th read of each thread is fed into Space-Saving tracker, top keys are reported by Stats() as
+ * "hot:<key>" with estimated number of reads.
+ *
+ * With replication enabled each thread also keeps read-only copies of the current top keys, so that reads of
+ * a few very popular keys stop hitting the same backend shard and lock. Copies are dropped on each write or eviction
+ * of any of the top keys and each time the set of top keys changes: writer bumps global generation, reader compares
+ * it with the generation its copies were taken at before using them. If backend can't report evictions, copies are
+ * dropped on every write instead, as any write could evict a top key
+ */
+class HotKeyStorage : public Afina::Storage {
+public:
+    /**
+     * top is the number of keys reported and replicated, 1 of sample reads of each thread is tracked
+     */
+    HotKeyStorage(std::shared_ptr<Afina::Storage> backend, std::size_t top = 16, bool replicate = false,
+                  unsigned sample = 16);
+    ~HotKeyStorage();
+
+    // Implements Afina::Storage interface
+    void Start() override { _backend->Start(); }
+
+    // Implements Afina::Storage interface
+    void Stop() override { _backend->Stop(); }
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return _backend->ThreadSafe(); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override { _backend->Freeze(func); }
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override { return _backend->ForEach(visit); }
+
+    // Implements Afina::Storage interface
+    void Reserve(std::size_t count) override { _backend->Reserve(count); }
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override {
+        return _backend->Scan(prefix, limit, visit);
+    }
+
+    // Implements Afina::Storage interface
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override;
+
+private:
+    struct ThreadState {
+        ThreadState() : countdown(0), generation(0), hits(0) {}
+
+        // Reads left until the next sample
+        unsigned countdown;
+
+        // Generation copies below were taken at
+        uint64_t generation;
+
+        // Top keys and copies of their values read so far
+        std::unordered_set<std::string> hot;
+        std::unordered_map<std::string, std::string> copies;
+
+        // Reads served from copies
+        uint64_t hits;
+    };
+
+    // Feeds read into tracker if it is time to sample
+    void Sample(ThreadState &state, const std::string &key);
+
+    // Drops copies of all threads if key is one of the top keys, or unconditionally on write if evictions
+    // aren't watched
+    void Invalidate(const std::string &key, bool write);
+
+    std::shared_ptr<Afina::Storage> _backend;
+
+    const std::size_t _top;
+    const bool _replicate;
+    const unsigned _sample;
+
+    // True if backend reports evicted keys
+    bool _watched;
+
+    // Protects tracker and the set of top keys
+    std::mutex _lock;
+    SpaceSaving _tracker;
+    std::unordered_set<std::string> _hot;
+
+    // Number of samples since top keys were recomputed
+    std::size_t _samples;
+
+    // Incremented each time copies become invalid
+    std::atomic<uint64_t> _generation;
+
+    Afina::Concurrency::ThreadLocal<ThreadState> _threads;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_HOT_KEY_STORAGE_H
@@ -0,0 +1,178 @@
+#include "LZCodec.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Shortest back reference worth encoding
+const std::size_t min_match = 4;
+
+// Input tail always goes as literals, so that match search never reads past the end
+const std::size_t last_literals = 5;
+
+// Back references reach that far only
+const std::size_t max_offset = 65535;
+
+// Positions of recently seen 4 byte sequences indexed by their hash
+const int hash_bits = 12;
+
+uint32_t Read32(const char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Hash(uint32_t v) { return (v * 2654435761U) >> (32 - hash_bits); }
+
+// Lengths not fitting into token nibble continue in bytes of 255
+void PutLength(std::size_t len, std::string &out) {
+    for (; len >= 255; len -= 255) {
+        out.push_back(static_cast<char>(255));
+    }
+    out.push_back(static_cast<char>(len));
+}
+
+bool GetLength(const unsigned char *&in, const unsigned char *end, std::size_t &len) {
+    unsigned char b;
+    do {
+        if (in == end) {
+            return false;
+        }
+        b = *in++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+void PutSequence(const char *literals, std::size_t lit_len, std::size_t offset, std::size_t match_len,
+                 std::string &out) {
+    std::size_t ml = match_len >= min_match ? match_len - min_match : 0;
+    unsigned char token = static_cast<unsigned char>(((lit_len < 15 ? lit_len : 15) << 4) | (ml < 15 ? ml : 15));
+    out.push_back(static_cast<char>(token));
+    if (lit_len >= 15) {
+        PutLength(lit_len - 15, out);
+    }
+    out.append(literals, lit_len);
+
+    // Last sequence has literals only
+    if (match_len == 0) {
+        return;
+    }
+
+    out.push_back(static_cast<char>(offset & 0xff));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (ml >= 15) {
+        PutLength(ml - 15, out);
+    }
+}
+
+} // namespace
+
+// See LZCodec.h
+void LZCodec::Compress(const char *data, std::size_t size, std::string &out) {
+    // Original size goes first as varint
+    for (std::size_t n = size; ; n >>= 7) {
+        if (n < 0x80) {
+            out.push_back(static_cast<char>(n));
+            break;
+        }
+        out.push_back(static_cast<char>((n & 0x7f) | 0x80));
+    }
+
+    uint32_t table[1 << hash_bits];
+    std::memset(table, 0, sizeof(table));
+
+    std::size_t anchor = 0, pos = 0;
+    std::size_t limit = size > last_literals + min_match ? size - last_literals - min_match : 0;
+    while (pos < limit) {
+        uint32_t seq = Read32(data + pos);
+        uint32_t h = Hash(seq);
+        std::size_t ref = table[h];
+        table[h] = static_cast<uint32_t>(pos);
+
+        if (ref >= pos || pos - ref > max_offset || Read32(data + ref) != seq) {
+            pos++;
+            continue;
+        }
+
+        std::size_t len = min_match;
+        while (pos + len < size - last_literals && data[ref + len] == data[pos + len]) {
+            len++;
+        }
+
+        PutSequence(data + anchor, pos - anchor, pos - ref, len, out);
+        pos += len;
+        anchor = pos;
+    }
+
+    PutSequence(data + anchor, size - anchor, 0, 0, out);
+}
+
+// See LZCodec.h
+bool LZCodec::Decompress(const char *data, std::size_t size, std::string &out) {
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char *end = in + size;
+
+    std::size_t expected = 0;
+    for (int shift = 0;; shift += 7) {
+        if (in == end || shift > 56) {
+            return false;
+        }
+        unsigned char b = *in++;
+        expected |= static_cast<std::size_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+
+    out.clear();
+    out.reserve(expected);
+    while (in < end) {
+        unsigned char token = *in++;
+
+        std::size_t lit_len = token >> 4;
+        if (lit_len == 15 && !GetLength(in, end, lit_len)) {
+            return false;
+        }
+        if (lit_len > static_cast<std::size_t>(end - in) || out.size() + lit_len > expected) {
+            return false;
+        }
+        out.append(reinterpret_cast<const char *>(in), lit_len);
+        in += lit_len;
+
+        if (in == end) {
+            break;
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        std::size_t offset = in[0] | (static_cast<std::size_t>(in[1]) << 8);
+        in += 2;
+
+        std::size_t match_len = token & 0x0f;
+        if (match_len == 15 && !GetLength(in, end, match_len)) {
+            return false;
+        }
+        match_len += min_match;
+
+        if (offset == 0 || offset > out.size() || out.size() + match_len > expected) {
+            return false;
+        }
+
+        // Reference could overlap with bytes being produced, so copy goes byte by byte
+        std::size_t from = out.size() - offset;
+        for (std::size_t i = 0; i < match_len; i++) {
+            out.push_back(out[from + i]);
+        }
+    }
+
+    return out.size() == expected;
+}
+
+} // namespace Backend
+} // namespace Afina
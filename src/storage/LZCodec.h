@@ -0,0 +1,33 @@
+#ifndef AFINA_STORAGE_LZ_CODEC_H
+#define AFINA_STORAGE_LZ_CODEC_H
+
+#include <cstddef>
+#include <string>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Fast LZ77 codec
+ * Byte oriented format borrowed from LZ4 block: sequences of literals followed by a back reference into the
+ * last 64KB of output. No entropy coding, so both directions run at memory speed and compress text-like data
+ * (JSON, HTML) about 2-4 times. Output starts with the original size, so decoder allocates once and checks
+ * the result
+ */
+class LZCodec {
+public:
+    /**
+     * Appends compressed representation of the data to out
+     */
+    static void Compress(const char *data, std::size_t size, std::string &out);
+
+    /**
+     * Replaces out with data decompressed from the input. Returns false if input is corrupted
+     */
+    static bool Decompress(const char *data, std::size_t size, std::string &out);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_LZ_CODEC_H
@@ -0,0 +1,440 @@
+#include "LoggedStorage.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Entry.h"
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Size of chunks rewrite child writes the new log with
+const std::size_t rewrite_chunk = 1 << 20;
+
+// Sanity limit for lengths read from the log, so that garbage doesn't make us allocate gigabytes
+const uint64_t max_length = 1 << 30;
+
+void PutVarint(std::string &out, uint64_t n) {
+    for (; n >= 0x80; n >>= 7) {
+        out.push_back(char(n | 0x80));
+    }
+    out.push_back(char(n));
+}
+
+bool GetVarint(FILE *f, uint64_t &n) {
+    n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF) {
+            return false;
+        }
+        n |= uint64_t(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GetString(FILE *f, uint64_t size, std::string &out) {
+    if (size > max_length) {
+        return false;
+    }
+    out.resize(size);
+    return size == 0 || fread(&out[0], 1, size, f) == size;
+}
+
+bool WriteAll(int fd, const char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Makes rename of the file durable
+void SyncDirectory(const std::string &path) {
+    std::size_t slash = path.rfind('/');
+    std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+    int fd = open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+} // namespace
+
+// See LoggedStorage.h
+LoggedStorage::LoggedStorage(std::shared_ptr<Afina::Storage> backend, const std::string &path,
+                             std::size_t rewrite_size)
+    : _backend(backend), _path(path), _rewrite_size(rewrite_size), _fd(-1), _log_size(0), _base_size(0),
+      _appended(0), _synced(0), _failed(false), _stop(false), _rewrite_pid(0), _rewrite_requested(false),
+      _replayed(0), _batches(0), _rewrites(0) {
+    _log_size = _base_size = Replay();
+
+    _fd = open(_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to open " + _path + ": " + std::string(strerror(errno)));
+    }
+
+    // Whatever follows the last valid record is garbage of a torn write
+    if (ftruncate(_fd, _log_size) != 0) {
+        close(_fd);
+        throw std::runtime_error("Failed to truncate " + _path + ": " + std::string(strerror(errno)));
+    }
+
+    _flusher = std::thread(&LoggedStorage::Flush, this);
+}
+
+// See LoggedStorage.h
+LoggedStorage::~LoggedStorage() {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stop = true;
+        _pending_cv.notify_one();
+    }
+    _flusher.join();
+
+    if (_rewrite_pid > 0) {
+        kill(_rewrite_pid, SIGKILL);
+        waitpid(_rewrite_pid, nullptr, 0);
+        unlink((_path + ".rewrite").c_str());
+    }
+    close(_fd);
+}
+
+// See LoggedStorage.h
+void LoggedStorage::Stop() {
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        uint64_t seq = _appended;
+        _synced_cv.wait(lock, [this, seq]() { return _synced >= seq; });
+    }
+    _backend->Stop();
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LoggedStorage::Put(const std::string &key, const std::string &value) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_failed || !_backend->Put(key, value)) {
+            return false;
+        }
+        seq = Append(OpPut, key, value);
+    }
+    return Commit(seq);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LoggedStorage::PutIfAbsent(const std::string &key, const std::string &value) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_failed || !_backend->PutIfAbsent(key, value)) {
+            return false;
+        }
+        seq = Append(OpPut, key, value);
+    }
+    return Commit(seq);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LoggedStorage::Set(const std::string &key, const std::string &value) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_failed || !_backend->Set(key, value)) {
+            return false;
+        }
+        seq = Append(OpPut, key, value);
+    }
+    return Commit(seq);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LoggedStorage::Delete(const std::string &key) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_failed || !_backend->Delete(key)) {
+            return false;
+        }
+        seq = Append(OpDelete, key, std::string());
+    }
+    return Commit(seq);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LoggedStorage::DeletePrefix(const std::string &prefix, std::size_t &deleted) {
+    uint64_t seq;
+    {
+        // Single record with prefix as a key, replay removes the same range
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_failed || !_backend->DeletePrefix(prefix, deleted)) {
+            return false;
+        } else if (deleted == 0) {
+            return true;
+        }
+        seq = Append(OpDeletePrefix, prefix, std::string());
+    }
+    return Commit(seq);
+}
+
+// See LoggedStorage.h
+void LoggedStorage::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    _backend->Stats(stats);
+
+    std::lock_guard<std::mutex> lock(_lock);
+    stats.emplace_back("wal_records", std::to_string(_appended));
+    stats.emplace_back("wal_batches", std::to_string(_batches));
+    stats.emplace_back("wal_size", std::to_string(_log_size));
+    stats.emplace_back("wal_rewrites", std::to_string(_rewrites));
+    stats.emplace_back("wal_replayed", std::to_string(_replayed));
+    stats.emplace_back("wal_failed", _failed ? "1" : "0");
+}
+
+// See MapBasedGlobalLockImpl.h
+void LoggedStorage::Freeze(const std::function<void()> &func) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _backend->Freeze(func);
+}
+
+// See LoggedStorage.h
+void LoggedStorage::Rewrite() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _rewrite_requested = true;
+    _pending_cv.notify_one();
+}
+
+// See LoggedStorage.h
+void LoggedStorage::Encode(Op op, const std::string &key, const std::string &value, std::string &out) {
+    std::size_t start = out.size();
+    out.push_back(op);
+    PutVarint(out, key.size());
+    PutVarint(out, value.size());
+    out.append(key);
+    out.append(value);
+
+    uint32_t checksum = HashBytes(out.data() + start, out.size() - start);
+    for (int i = 0; i < 4; i++) {
+        out.push_back(char(checksum >> (8 * i)));
+    }
+}
+
+// See LoggedStorage.h
+uint64_t LoggedStorage::Replay() {
+    FILE *f = fopen(_path.c_str(), "rb");
+    if (f == nullptr) {
+        return 0;
+    }
+
+    std::vector<char> buffer(rewrite_chunk);
+    setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+
+    uint64_t valid = 0;
+    std::string key, value, record;
+    for (int op = fgetc(f); op != EOF; op = fgetc(f)) {
+        uint64_t key_len, value_len;
+        char checksum[4];
+        if ((op != OpPut && op != OpDelete && op != OpDeletePrefix) || !GetVarint(f, key_len) ||
+            !GetVarint(f, value_len) || !GetString(f, key_len, key) || !GetString(f, value_len, value) ||
+            fread(checksum, 1, sizeof(checksum), f) != sizeof(checksum)) {
+            break;
+        }
+
+        record.clear();
+        Encode(Op(op), key, value, record);
+        if (memcmp(record.data() + record.size() - sizeof(checksum), checksum, sizeof(checksum)) != 0) {
+            break;
+        }
+
+        std::size_t deleted;
+        if (op == OpPut) {
+            _backend->Put(key, value);
+        } else if (op == OpDelete) {
+            _backend->Delete(key);
+        } else {
+            _backend->DeletePrefix(key, deleted);
+        }
+        valid += record.size();
+        _replayed++;
+    }
+
+    fclose(f);
+    return valid;
+}
+
+// See LoggedStorage.h
+uint64_t LoggedStorage::Append(Op op, const std::string &key, const std::string &value) {
+    std::size_t start = _buffer.size();
+    Encode(op, key, value, _buffer);
+    _log_size += _buffer.size() - start;
+
+    // Rewrite child dumps state as of fork, so new log needs everything after it
+    if (_rewrite_pid > 0) {
+        _rewrite_tail.append(_buffer, start, std::string::npos);
+    }
+
+    _pending_cv.notify_one();
+    return ++_appended;
+}
+
+// See LoggedStorage.h
+bool LoggedStorage::Commit(uint64_t seq) {
+    std::unique_lock<std::mutex> lock(_lock);
+    _synced_cv.wait(lock, [this, seq]() { return _synced >= seq; });
+    return !_failed;
+}
+
+// See LoggedStorage.h
+void LoggedStorage::Flush() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(_lock);
+    while (true) {
+        if (_rewrite_pid > 0) {
+            PollRewrite();
+        } else if (_rewrite_requested || _failed || (_log_size > _rewrite_size && _log_size > 2 * _base_size)) {
+            _rewrite_requested = false;
+            StartRewrite();
+        }
+
+        if (_buffer.empty()) {
+            if (_stop) {
+                break;
+            } else if (_rewrite_pid > 0) {
+                // Nobody signals child exit, so check it from time to time
+                _pending_cv.wait_for(lock, std::chrono::milliseconds(10));
+            } else if (_rewrite_requested) {
+                // Asked while the previous child was running
+            } else if (_failed) {
+                // Rewrite has failed too, retry later or once asked to
+                _pending_cv.wait_for(lock, std::chrono::seconds(1));
+            } else {
+                _pending_cv.wait(lock);
+            }
+            continue;
+        }
+
+        // Writers keep appending to the other buffer while this one goes to disk
+        batch.clear();
+        batch.swap(_buffer);
+        uint64_t seq = _appended;
+        int fd = _fd;
+
+        lock.unlock();
+        bool ok = WriteAll(fd, batch.data(), batch.size()) && fdatasync(fd) == 0;
+        lock.lock();
+
+        _failed = _failed || !ok;
+        _synced = seq;
+        _batches++;
+        _synced_cv.notify_all();
+    }
+}
+
+// See LoggedStorage.h
+void LoggedStorage::StartRewrite() {
+    std::string tmp = _path + ".rewrite";
+    pid_t pid = -1;
+
+    // No writer could get between backend and log while we hold the lock, freeze makes sure readers don't hold
+    // backend structures half updated
+    Afina::Storage &backend = *_backend;
+    _backend->Freeze([&backend, &tmp, &pid]() {
+        pid = fork();
+        if (pid != 0) {
+            return;
+        }
+
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            _exit(1);
+        }
+
+        std::string out;
+        bool ok = true;
+        bool supported = backend.ForEach([fd, &out, &ok](const std::string &key, const std::string &value) {
+            Encode(OpPut, key, value, out);
+            if (out.size() >= rewrite_chunk) {
+                ok = ok && WriteAll(fd, out.data(), out.size());
+                out.clear();
+            }
+        });
+        ok = ok && supported && WriteAll(fd, out.data(), out.size()) && fdatasync(fd) == 0;
+        _exit(ok ? 0 : 1);
+    });
+
+    if (pid < 0) {
+        // Try again once log doubles
+        _base_size = _log_size;
+        return;
+    }
+    _rewrite_pid = pid;
+    _rewrite_tail.clear();
+}
+
+// See LoggedStorage.h
+void LoggedStorage::PollRewrite() {
+    int status = 0;
+    if (waitpid(_rewrite_pid, &status, WNOHANG) == 0) {
+        return;
+    }
+    _rewrite_pid = 0;
+
+    std::string tmp = _path + ".rewrite";
+    int fd = -1;
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (ok) {
+        fd = open(tmp.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        ok = fd >= 0 && WriteAll(fd, _rewrite_tail.data(), _rewrite_tail.size()) && fdatasync(fd) == 0 &&
+             rename(tmp.c_str(), _path.c_str()) == 0;
+    }
+
+    if (!ok) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        unlink(tmp.c_str());
+        _rewrite_tail.clear();
+
+        // Try again once log doubles
+        _base_size = _log_size;
+        return;
+    }
+    SyncDirectory(_path);
+
+    // Records not flushed yet are part of the tail, so everything appended is on disk now
+    struct stat st;
+    fstat(fd, &st);
+    close(_fd);
+    _fd = fd;
+    _log_size = _base_size = st.st_size;
+    _buffer.clear();
+    _rewrite_tail.clear();
+    _synced = _appended;
+    _failed = false;
+    _rewrites++;
+    _synced_cv.notify_all();
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,190 @@
+#ifndef AFINA_STORAGE_LOGGED_STORAGE_H
+#define AFINA_STORAGE_LOGGED_STORAGE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Storage decorator with write-ahead log
+ * Each successful change is appended to the log file and write returns once it is on disk. Log is replayed into
+ * backend on construction, so contents survive restarts.
+ *
+ * Group commit: writers append records into the shared buffer and sleep, single flusher thread writes whatever
+ * has accumulated with one write() and one fdatasync() and wakes up everybody covered. While disk is busy with
+ * one batch the next one grows, so the higher is the rate the less sync costs per write.
+ *
+ * Changes are applied to backend and appended to log under the same lock, so log order is the order backend saw.
+ *
+ * Once log grows over rewrite_size (and twice as large as it was after the previous rewrite) it is compacted:
+ * flusher forks with frozen backend, child dumps all entries into the new log, parent keeps copy of records
+ * appended meanwhile and puts them at the end of the new log before swapping it in. Requires backend to support
+ * Storage::ForEach, otherwise log just grows.
+ *
+ * Record: op byte, varint key length, varint value length, key, value, 32 bit checksum. Replay stops at the first
+ * broken record and cuts it off, that is a write torn by crash which no client was told succeeded.
+ *
+ * Once write or sync of the log fails, writes in that batch return false although backend has applied them, and
+ * all later writes fail before touching backend, so that nothing is applied without being logged. Flusher keeps
+ * trying to rewrite the log from backend contents, the first successful rewrite makes the log whole again and
+ * writes are accepted from then on.
+ */
+class LoggedStorage : public Afina::Storage {
+public:
+    /**
+     * Replays existing log at path into backend and opens it for writes. Throws std::runtime_error if log can't
+     * be opened
+     */
+    LoggedStorage(std::shared_ptr<Afina::Storage> backend, const std::string &path,
+                  std::size_t rewrite_size = 64 << 20);
+    ~LoggedStorage();
+
+    LoggedStorage(const LoggedStorage &) = delete;
+    LoggedStorage &operator=(const LoggedStorage &) = delete;
+
+    // Implements Afina::Storage interface
+    void Start() override { _backend->Start(); }
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return _backend->ThreadSafe(); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override { return _backend->Get(key, value); }
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override {
+        _backend->MultiGet(keys, found);
+    }
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override;
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override { return _backend->ForEach(visit); }
+
+    // Implements Afina::Storage interface
+    void Reserve(std::size_t count) override { _backend->Reserve(count); }
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override {
+        return _backend->Scan(prefix, limit, visit);
+    }
+
+    // Implements Afina::Storage interface
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override;
+
+    // Implements Afina::Storage interface
+    bool WatchEvictions(const evicted_func &evicted) override { return _backend->WatchEvictions(evicted); }
+
+    /**
+     * Asks flusher to compact log right away regardless of its size
+     */
+    void Rewrite();
+
+    /**
+     * Number of records applied from the log on construction
+     */
+    std::size_t Replayed() const { return _replayed; }
+
+private:
+    enum Op : char { OpPut = 1, OpDelete = 2, OpDeletePrefix = 3 };
+
+    // Appends record to the given buffer
+    static void Encode(Op op, const std::string &key, const std::string &value, std::string &out);
+
+    // Applies log to backend, cuts off broken tail. Returns size of the valid part
+    uint64_t Replay();
+
+    // Must be called under lock once backend accepted the change: queues record, returns its number
+    uint64_t Append(Op op, const std::string &key, const std::string &value);
+
+    // Waits until record with the given number is on disk, returns false if log is broken
+    bool Commit(uint64_t seq);
+
+    // Flusher thread body
+    void Flush();
+
+    // Methods below are called by flusher under lock
+
+    // Forks child dumping backend into the new log
+    void StartRewrite();
+
+    // Checks if rewrite child has exited and swaps log if it succeeded
+    void PollRewrite();
+
+    std::shared_ptr<Afina::Storage> _backend;
+
+    const std::string _path;
+    const std::size_t _rewrite_size;
+
+    // Orders changes, protects everything below
+    std::mutex _lock;
+
+    // Writers wake up flusher, flusher wakes up writers
+    std::condition_variable _pending_cv;
+    std::condition_variable _synced_cv;
+
+    // Log file and its size, including records being written by flusher
+    int _fd;
+    uint64_t _log_size;
+
+    // Log size after the last rewrite
+    uint64_t _base_size;
+
+    // Records not handed to flusher yet
+    std::string _buffer;
+
+    // Number of records appended and number of records on disk
+    uint64_t _appended;
+    uint64_t _synced;
+
+    // Set once write or sync failed, writes are refused until log is rewritten
+    bool _failed;
+    bool _stop;
+
+    // Rewrite child, copy of records appended since it was forked and explicit request for rewrite
+    pid_t _rewrite_pid;
+    std::string _rewrite_tail;
+    bool _rewrite_requested;
+
+    // Statistics
+    std::size_t _replayed;
+    uint64_t _batches;
+    uint64_t _rewrites;
+
+    std::thread _flusher;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_LOGGED_STORAGE_H
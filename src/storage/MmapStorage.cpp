@@ -0,0 +1,496 @@
+#include "MmapStorage.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Entry.h"
+
+namespace Afina {
+namespace Backend {
+
+static const char mmap_magic[8] = {'A', 'F', 'I', 'N', 'A', 'M', 'M', 'P'};
+
+// Metadata regions start on their own OS pages
+static const std::size_t mmap_align = 4096;
+
+static std::size_t AlignUp(std::size_t n, std::size_t align) { return (n + align - 1) / align * align; }
+
+// See MmapStorage.h
+MmapStorage::MmapStorage(const std::string &path, std::size_t file_size, std::size_t page_size)
+    : _fd(-1), _base(nullptr), _size(file_size), _header(nullptr), _restored(0) {
+    _fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(strerror(errno)));
+    }
+
+    // Two processes attached to the same file would both own slabs and index, e.g. during overlapping restart
+    if (flock(_fd, LOCK_EX | LOCK_NB) != 0) {
+        int error = errno;
+        close(_fd);
+        throw std::runtime_error("Failed to lock " + path + ": " + std::string(strerror(error)));
+    }
+
+    Header existing;
+    bool valid = pread(_fd, &existing, sizeof(existing), 0) == sizeof(existing) &&
+                 Valid(existing, file_size, page_size);
+    if (!valid) {
+        // Drop whatever was there, file comes back zero filled
+        if (ftruncate(_fd, 0) != 0 || ftruncate(_fd, file_size) != 0) {
+            close(_fd);
+            throw std::runtime_error("Failed to resize " + path + ": " + std::string(strerror(errno)));
+        }
+    }
+
+    void *p = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (p == MAP_FAILED) {
+        close(_fd);
+        throw std::runtime_error("Failed to map " + path + ": " + std::string(strerror(errno)));
+    }
+    _base = static_cast<char *>(p);
+    _header = At<Header>(0);
+
+    if (!valid) {
+        try {
+            Format(file_size, page_size);
+        } catch (...) {
+            munmap(_base, _size);
+            close(_fd);
+            throw;
+        }
+    } else if (_header->dirty) {
+        Recover();
+    }
+
+    for (std::size_t i = 0; i < _header->class_count; i++) {
+        _restored += _header->classes[i].items;
+    }
+    MarkDirty();
+}
+
+// See MmapStorage.h
+MmapStorage::~MmapStorage() {
+    Sync();
+    munmap(_base, _size);
+    close(_fd);
+}
+
+// See MmapStorage.h
+void MmapStorage::Stop() {
+    std::lock_guard<std::mutex> lock(_lock);
+    Sync();
+}
+
+// See MapBasedGlobalLockImpl.h
+bool MmapStorage::Put(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(_lock);
+    MarkDirty();
+    return Store(key, value, Find(key));
+}
+
+// See MapBasedGlobalLockImpl.h
+bool MmapStorage::PutIfAbsent(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (Find(key) != nullptr) {
+        return false;
+    }
+    MarkDirty();
+    return Store(key, value, nullptr);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool MmapStorage::Set(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(_lock);
+    Item *old = Find(key);
+    if (old == nullptr) {
+        return false;
+    }
+    MarkDirty();
+    return Store(key, value, old);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool MmapStorage::Delete(const std::string &key) {
+    std::lock_guard<std::mutex> lock(_lock);
+    Item *item = Find(key);
+    if (item == nullptr) {
+        return false;
+    }
+    MarkDirty();
+    Release(item);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool MmapStorage::Get(const std::string &key, std::string &value) {
+    std::lock_guard<std::mutex> lock(_lock);
+    Item *item = Find(key);
+    if (item == nullptr) {
+        return false;
+    }
+
+    MarkDirty();
+    Unlink(item);
+    LinkHead(item);
+    value.assign(item->data() + item->key_len, item->value_len);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+void MmapStorage::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    std::lock_guard<std::mutex> lock(_lock);
+    MarkDirty();
+
+    std::string value;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        Item *item = Find(keys[i]);
+        if (item != nullptr) {
+            Unlink(item);
+            LinkHead(item);
+            value.assign(item->data() + item->key_len, item->value_len);
+            found(i, value);
+        }
+    }
+}
+
+// See MmapStorage.h
+void MmapStorage::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    uint64_t items = 0;
+    for (std::size_t i = 0; i < _header->class_count; i++) {
+        items += _header->classes[i].items;
+    }
+
+    stats.emplace_back("mmap_items", std::to_string(items));
+    stats.emplace_back("mmap_restored", std::to_string(_restored));
+    stats.emplace_back("mmap_pages_used", std::to_string(_header->pages_used));
+    stats.emplace_back("mmap_pages", std::to_string(_header->page_count));
+}
+
+// See MapBasedGlobalLockImpl.h
+void MmapStorage::Freeze(const std::function<void()> &func) {
+    std::lock_guard<std::mutex> lock(_lock);
+    func();
+}
+
+// See MmapStorage.h
+bool MmapStorage::Valid(const Header &header, std::size_t file_size, std::size_t page_size) {
+    if (memcmp(header.magic, mmap_magic, sizeof(mmap_magic)) != 0 || header.version != version ||
+        header.file_size != file_size || header.page_size != page_size) {
+        return false;
+    }
+
+    // Regions must be in order and fit the file, otherwise recovery would walk out of mapping
+    bool pow2 = header.bucket_count > 0 && (header.bucket_count & (header.bucket_count - 1)) == 0;
+    return pow2 && header.class_count > 0 && header.class_count <= max_classes && header.buckets >= sizeof(Header) &&
+           header.page_table >= header.buckets + header.bucket_count * sizeof(offset_t) &&
+           header.pages >= header.page_table + header.page_count &&
+           header.pages + header.page_count * page_size <= file_size && header.pages_used <= header.page_count;
+}
+
+// See MmapStorage.h
+void MmapStorage::Format(std::size_t file_size, std::size_t page_size) {
+    std::size_t bucket_count = 1024;
+    while (bucket_count < file_size / 256) {
+        bucket_count *= 2;
+    }
+
+    Header &h = *_header;
+    h.version = version;
+    h.file_size = file_size;
+    h.page_size = page_size;
+    h.bucket_count = bucket_count;
+    h.buckets = AlignUp(sizeof(Header), mmap_align);
+    h.page_table = AlignUp(h.buckets + bucket_count * sizeof(offset_t), mmap_align);
+
+    // Page table takes a byte per page, so there is a bit less pages than file_size / page_size
+    std::size_t pages = file_size / page_size;
+    while (pages > 0 && AlignUp(h.page_table + pages, mmap_align) + pages * page_size > file_size) {
+        pages--;
+    }
+    if (pages == 0 || page_size < 2 * sizeof(Item)) {
+        throw std::runtime_error("Storage file is too small for the page size");
+    }
+    h.page_count = pages;
+    h.pages = AlignUp(h.page_table + pages, mmap_align);
+    h.pages_used = 0;
+    h.sequence = 0;
+
+    // Chunk sizes grow by 25%, the last class takes whole page
+    std::size_t size = 64;
+    h.class_count = 0;
+    while (size < page_size && h.class_count < max_classes - 1) {
+        h.classes[h.class_count++].chunk_size = size;
+        size = AlignUp(size + size / 4, 8);
+    }
+    h.classes[h.class_count++].chunk_size = page_size;
+
+    // Magic goes last, so that half formatted file is never taken as valid
+    h.dirty = 1;
+    msync(_base, _size, MS_SYNC);
+    memcpy(h.magic, mmap_magic, sizeof(mmap_magic));
+}
+
+// See MmapStorage.h
+void MmapStorage::Recover() {
+    Header &h = *_header;
+    memset(Buckets(), 0, h.bucket_count * sizeof(offset_t));
+    for (std::size_t i = 0; i < h.class_count; i++) {
+        SlabClass &c = h.classes[i];
+        c.free_head = c.lru_head = c.lru_tail = 0;
+        c.items = 0;
+    }
+
+    // Items are put back into LRU in order of their writes, which is the best guess we have
+    std::vector<std::pair<uint64_t, offset_t>> alive;
+    uint8_t *page_table = PageTable();
+    for (std::size_t page = 0; page < h.pages_used; page++) {
+        uint8_t cls = page_table[page];
+        if (cls >= h.class_count) {
+            // Page was being handed out, take it back
+            page_table[page] = h.class_count - 1;
+            cls = page_table[page];
+        }
+
+        std::size_t chunk = h.classes[cls].chunk_size;
+        offset_t start = h.pages + page * h.page_size;
+        for (offset_t off = start; off + chunk <= start + h.page_size; off += chunk) {
+            Item *item = At<Item>(off);
+            bool ok = item->state == Used && item->cls == cls &&
+                      sizeof(Item) + uint64_t(item->key_len) + item->value_len <= chunk &&
+                      item->checksum == Checksum(item);
+            if (!ok) {
+                item->state = Free;
+                item->lru_next = h.classes[cls].free_head;
+                h.classes[cls].free_head = off;
+                continue;
+            }
+
+            std::string key(item->data(), item->key_len);
+            Item *other = Find(key);
+            if (other == nullptr) {
+                item->hash_next = Bucket(HashBytes(key));
+                Bucket(HashBytes(key)) = off;
+                alive.emplace_back(item->sequence, off);
+                h.sequence = std::max(h.sequence, item->sequence);
+                continue;
+            }
+
+            // Crash happened while value was replaced, the latest one wins
+            Item *loser = item;
+            if (other->sequence < item->sequence) {
+                *LinkTo(other) = other->hash_next;
+                item->hash_next = Bucket(HashBytes(key));
+                Bucket(HashBytes(key)) = off;
+                alive.emplace_back(item->sequence, off);
+                h.sequence = std::max(h.sequence, item->sequence);
+                loser = other;
+            }
+            loser->state = Free;
+            loser->sequence = 0;
+            loser->lru_next = h.classes[loser->cls].free_head;
+            h.classes[loser->cls].free_head = Offset(loser);
+        }
+    }
+
+    std::sort(alive.begin(), alive.end());
+    for (auto &a : alive) {
+        Item *item = At<Item>(a.second);
+        if (item->state == Used && item->sequence == a.first) {
+            LinkHead(item);
+            h.classes[item->cls].items++;
+        }
+    }
+}
+
+// See MmapStorage.h
+uint32_t MmapStorage::Checksum(Item *item) {
+    uint64_t h = HashBytes(item->data(), item->key_len + std::size_t(item->value_len));
+    h ^= item->sequence * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t(item->key_len) << 32) | item->value_len;
+    return uint32_t(h ^ (h >> 32));
+}
+
+// See MmapStorage.h
+int MmapStorage::ClassFor(std::size_t size) const {
+    for (std::size_t i = 0; i < _header->class_count; i++) {
+        if (_header->classes[i].chunk_size >= size) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// See MmapStorage.h
+MmapStorage::Item *MmapStorage::Find(const std::string &key) const {
+    for (offset_t off = Bucket(HashBytes(key)); off != 0;) {
+        Item *item = At<Item>(off);
+        if (item->key_len == key.size() && memcmp(item->data(), key.data(), key.size()) == 0) {
+            return item;
+        }
+        off = item->hash_next;
+    }
+    return nullptr;
+}
+
+// See MmapStorage.h
+bool MmapStorage::Store(const std::string &key, const std::string &value, Item *old) {
+    int cls = ClassFor(sizeof(Item) + key.size() + value.size());
+    if (cls < 0) {
+        return false;
+    }
+
+    // Old value must not be evicted to make room for the new one, otherwise it could be lost if new one is
+    // failed to store
+    if (old != nullptr) {
+        Unlink(old);
+    }
+
+    Item *item = Allocate(cls);
+    if (item == nullptr) {
+        if (old != nullptr) {
+            LinkHead(old);
+        }
+        return false;
+    }
+
+    item->key_len = key.size();
+    item->value_len = value.size();
+    item->cls = cls;
+    item->sequence = ++_header->sequence;
+    memcpy(item->data(), key.data(), key.size());
+    memcpy(item->data() + key.size(), value.data(), value.size());
+    item->checksum = Checksum(item);
+    item->state = Used;
+
+    offset_t &bucket = Bucket(HashBytes(key));
+    item->hash_next = bucket;
+    bucket = Offset(item);
+    LinkHead(item);
+    _header->classes[cls].items++;
+
+    if (old != nullptr) {
+        // Already out of LRU list
+        LinkHead(old);
+        Release(old);
+    }
+    return true;
+}
+
+// See MmapStorage.h
+MmapStorage::Item *MmapStorage::Allocate(int cls) {
+    SlabClass &c = _header->classes[cls];
+    if (c.free_head == 0 && _header->pages_used < _header->page_count) {
+        std::size_t page = _header->pages_used;
+        PageTable()[page] = cls;
+        _header->pages_used++;
+
+        // Chunks are linked in reverse, so that they are handed out in address order
+        offset_t start = _header->pages + page * _header->page_size;
+        offset_t last = start + (_header->page_size / c.chunk_size - 1) * c.chunk_size;
+        for (offset_t off = last; off >= start; off -= c.chunk_size) {
+            Item *item = At<Item>(off);
+            item->state = Free;
+            item->lru_next = c.free_head;
+            c.free_head = off;
+            if (off == start) {
+                break;
+            }
+        }
+    }
+
+    if (c.free_head == 0 && c.lru_tail != 0) {
+        Release(At<Item>(c.lru_tail));
+    }
+
+    if (c.free_head == 0) {
+        return nullptr;
+    }
+
+    Item *item = At<Item>(c.free_head);
+    c.free_head = item->lru_next;
+    item->lru_prev = item->lru_next = item->hash_next = 0;
+    return item;
+}
+
+// See MmapStorage.h
+void MmapStorage::Release(Item *item) {
+    // State goes first, so that item is never resurrected by recovery
+    item->state = Free;
+    *LinkTo(item) = item->hash_next;
+    Unlink(item);
+
+    SlabClass &c = _header->classes[item->cls];
+    c.items--;
+    item->lru_next = c.free_head;
+    c.free_head = Offset(item);
+}
+
+// See MmapStorage.h
+MmapStorage::offset_t *MmapStorage::LinkTo(Item *item) const {
+    offset_t target = Offset(item);
+    offset_t *link = &Bucket(HashBytes(item->data(), item->key_len));
+    while (*link != target) {
+        link = &At<Item>(*link)->hash_next;
+    }
+    return link;
+}
+
+// See MmapStorage.h
+void MmapStorage::LinkHead(Item *item) {
+    SlabClass &c = _header->classes[item->cls];
+    item->lru_prev = 0;
+    item->lru_next = c.lru_head;
+    if (c.lru_head != 0) {
+        At<Item>(c.lru_head)->lru_prev = Offset(item);
+    } else {
+        c.lru_tail = Offset(item);
+    }
+    c.lru_head = Offset(item);
+}
+
+// See MmapStorage.h
+void MmapStorage::Unlink(Item *item) {
+    SlabClass &c = _header->classes[item->cls];
+    if (item->lru_prev != 0) {
+        At<Item>(item->lru_prev)->lru_next = item->lru_next;
+    } else {
+        c.lru_head = item->lru_next;
+    }
+
+    if (item->lru_next != 0) {
+        At<Item>(item->lru_next)->lru_prev = item->lru_prev;
+    } else {
+        c.lru_tail = item->lru_prev;
+    }
+    item->lru_prev = item->lru_next = 0;
+}
+
+// See MmapStorage.h
+void MmapStorage::MarkDirty() {
+    if (_header->dirty == 0) {
+        _header->dirty = 1;
+        msync(_base, mmap_align, MS_SYNC);
+    }
+}
+
+// See MmapStorage.h
+void MmapStorage::Sync() {
+    if (_header->dirty != 0) {
+        msync(_base, _size, MS_SYNC);
+        _header->dirty = 0;
+        msync(_base, mmap_align, MS_SYNC);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,200 @@
+#ifndef AFINA_STORAGE_MMAP_STORAGE_H
+#define AFINA_STORAGE_MMAP_STORAGE_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Cache living in memory mapped file
+ * Everything, including index and LRU lists, is kept in the MAP_SHARED mapping of a single file, so contents survive
+ * process restart: new process maps the same file and serves previous values right away. File in /dev/shm gives
+ * the same without any disk IO.
+ *
+ * Memory is split into pages, each page is given to some slab class and cut into chunks of the class size, one item
+ * per chunk. Each class has its own free list and LRU list, once class has no free chunks and there are no free
+ * pages left its least recently used item gets evicted. Pages never move between classes.
+ *
+ * File is locked exclusively for the lifetime of the storage, so only one process at a time could attach it.
+ *
+ * Crash safety: header carries "dirty" flag, it is set while file is attached and cleared by Stop() after msync.
+ * Every item carries sequence number and checksum, its state is switched to "used" only once it is completely
+ * written. If file was left dirty, lists can't be trusted, so index and lists are rebuilt from items that pass
+ * the checks; for the same key the latest one wins. Guarantees hold for process crash, data that kernel didn't
+ * write back before power loss is lost anyway.
+ *
+ * All operations are serialized with the single lock
+ */
+class MmapStorage : public Afina::Storage {
+public:
+    /**
+     * Maps given file, reuses its contents if it was created with the same geometry, reformats it otherwise.
+     * Throws std::runtime_error if file can't be opened or mapped, or is used by another instance
+     */
+    MmapStorage(const std::string &path, std::size_t file_size = 64 << 20, std::size_t page_size = 1 << 20);
+    ~MmapStorage();
+
+    MmapStorage(const MmapStorage &) = delete;
+    MmapStorage &operator=(const MmapStorage &) = delete;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override;
+
+    /**
+     * Not supported: mapping is shared with forked children, so they can't see a frozen copy of it. The file
+     * itself is the snapshot, copy it after Stop()
+     */
+    bool ForEach(const visit_func &visit) const override { return false; }
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    /**
+     * Number of items restored from the file on attach
+     */
+    std::size_t Restored() const { return _restored; }
+
+private:
+    // All links are offsets from the beginning of the file, 0 means none
+    using offset_t = uint64_t;
+
+    static const uint32_t version = 1;
+    static const std::size_t max_classes = 64;
+
+    struct SlabClass {
+        uint32_t chunk_size;
+        uint32_t reserved;
+        offset_t free_head;
+        offset_t lru_head;
+        offset_t lru_tail;
+        uint64_t items;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t dirty;
+        uint64_t file_size;
+        uint64_t page_size;
+        uint64_t bucket_count;
+        uint64_t page_count;
+        uint64_t pages_used;
+        uint64_t sequence;
+        offset_t buckets;
+        offset_t page_table;
+        offset_t pages;
+        uint32_t class_count;
+        uint32_t reserved;
+        SlabClass classes[max_classes];
+    };
+
+    enum State : uint8_t { Free = 0, Used = 0xA5 };
+
+    struct Item {
+        offset_t hash_next;
+        offset_t lru_prev;
+        offset_t lru_next;
+        uint64_t sequence;
+        uint32_t key_len;
+        uint32_t value_len;
+        uint32_t checksum;
+        uint8_t cls;
+        uint8_t state;
+        uint16_t reserved;
+
+        char *data() { return reinterpret_cast<char *>(this + 1); }
+    };
+
+    template <typename T> T *At(offset_t off) const { return reinterpret_cast<T *>(_base + off); }
+    offset_t Offset(const void *p) const { return static_cast<const char *>(p) - _base; }
+
+    offset_t *Buckets() const { return At<offset_t>(_header->buckets); }
+    uint8_t *PageTable() const { return At<uint8_t>(_header->page_table); }
+    offset_t &Bucket(uint64_t hash) const { return Buckets()[hash & (_header->bucket_count - 1)]; }
+
+    // Header describes consistent file of the requested geometry
+    static bool Valid(const Header &header, std::size_t file_size, std::size_t page_size);
+
+    // Lays out empty cache
+    void Format(std::size_t file_size, std::size_t page_size);
+
+    // Rebuilds index, lists and free lists from items after crash
+    void Recover();
+
+    // Checksum of item contents along with its header fields
+    static uint32_t Checksum(Item *item);
+
+    // Slab class for item of the given size, or -1 if it doesn't fit any
+    int ClassFor(std::size_t size) const;
+
+    // Returns item for the key, nullptr if key isn't there
+    Item *Find(const std::string &key) const;
+
+    // Writes new item for the key, replacing the old one if any
+    bool Store(const std::string &key, const std::string &value, Item *old);
+
+    // Takes free chunk of the class, evicts if needed. nullptr if class can't get any memory
+    Item *Allocate(int cls);
+
+    // Removes item from index and LRU list, returns chunk to the free list
+    void Release(Item *item);
+
+    // Returns link referencing given item in its hash chain
+    offset_t *LinkTo(Item *item) const;
+
+    // LRU list maintenance, head is the most recently used
+    void LinkHead(Item *item);
+    void Unlink(Item *item);
+
+    // Sets dirty flag before the first modification since attach or Sync()
+    void MarkDirty();
+
+    // Flushes mapping to the file and marks it clean
+    void Sync();
+
+    std::mutex _lock;
+
+    int _fd;
+    char *_base;
+    std::size_t _size;
+    Header *_header;
+
+    // Items found in the file on attach
+    std::size_t _restored;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_MMAP_STORAGE_H
@@ -0,0 +1,286 @@
+#include "NamespacedStorage.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See NamespacedStorage.h
+void NamespacedStorage::Add(const std::string &name, std::shared_ptr<Afina::Storage> storage) {
+    if (name.empty() || name.find(_separator) != std::string::npos) {
+        throw std::invalid_argument("Bad namespace name: " + name);
+    }
+    for (auto &space : _namespaces) {
+        if (space->name == name) {
+            throw std::invalid_argument("Duplicate namespace: " + name);
+        }
+    }
+    _namespaces.emplace_back(new Namespace(name, storage));
+}
+
+// See MapBasedGlobalLockImpl.h
+void NamespacedStorage::Start() {
+    _fallback->Start();
+    for (auto &space : _namespaces) {
+        space->storage->Start();
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void NamespacedStorage::Stop() {
+    for (auto &space : _namespaces) {
+        space->storage->Stop();
+    }
+    _fallback->Stop();
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::ThreadSafe() const {
+    for (auto &space : _namespaces) {
+        if (!space->storage->ThreadSafe()) {
+            return false;
+        }
+    }
+    return _fallback->ThreadSafe();
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::Put(const std::string &key, const std::string &value) {
+    Namespace *space = Route(key);
+    if (space) {
+        space->writes++;
+    }
+    return StorageOf(space).Put(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::PutIfAbsent(const std::string &key, const std::string &value) {
+    Namespace *space = Route(key);
+    if (space) {
+        space->writes++;
+    }
+    return StorageOf(space).PutIfAbsent(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::Set(const std::string &key, const std::string &value) {
+    Namespace *space = Route(key);
+    if (space) {
+        space->writes++;
+    }
+    return StorageOf(space).Set(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::Delete(const std::string &key) {
+    Namespace *space = Route(key);
+    if (space) {
+        space->deletes++;
+    }
+    return StorageOf(space).Delete(key);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::Get(const std::string &key, std::string &value) {
+    Namespace *space = Route(key);
+    bool found = StorageOf(space).Get(key, value);
+    if (space) {
+        space->reads++;
+        space->hits += found ? 1 : 0;
+    }
+    return found;
+}
+
+// See MapBasedGlobalLockImpl.h
+void NamespacedStorage::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    if (keys.empty()) {
+        return;
+    }
+
+    // Usually all keys of a request belong to the same namespace
+    std::vector<Namespace *> routes(keys.size());
+    bool same = true;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        routes[i] = Route(keys[i]);
+        same = same && routes[i] == routes[0];
+    }
+
+    if (same) {
+        std::size_t hits = 0;
+        StorageOf(routes[0]).MultiGet(keys, [&found, &hits](std::size_t i, const std::string &value) {
+            hits++;
+            found(i, value);
+        });
+        if (routes[0]) {
+            routes[0]->reads += keys.size();
+            routes[0]->hits += hits;
+        }
+        return;
+    }
+
+    // Otherwise batch per namespace, then report values in order of keys
+    std::vector<std::string> values(keys.size());
+    std::vector<char> hit(keys.size(), 0);
+    std::vector<bool> done(keys.size(), false);
+    for (std::size_t first = 0; first < keys.size(); first++) {
+        if (done[first]) {
+            continue;
+        }
+
+        Namespace *space = routes[first];
+        std::vector<std::size_t> positions;
+        std::vector<std::string> batch;
+        for (std::size_t i = first; i < keys.size(); i++) {
+            if (routes[i] == space) {
+                positions.push_back(i);
+                batch.push_back(keys[i]);
+                done[i] = true;
+            }
+        }
+
+        std::size_t hits = 0;
+        StorageOf(space).MultiGet(batch, [&](std::size_t i, const std::string &value) {
+            values[positions[i]] = value;
+            hit[positions[i]] = 1;
+            hits++;
+        });
+        if (space) {
+            space->reads += batch.size();
+            space->hits += hits;
+        }
+    }
+
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (hit[i]) {
+            found(i, values[i]);
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void NamespacedStorage::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    _fallback->Stats(stats);
+
+    std::vector<std::pair<std::string, std::string>> own;
+    for (auto &space : _namespaces) {
+        std::string prefix = "ns_" + space->name + "_";
+        stats.emplace_back(prefix + "reads", std::to_string(space->reads.load()));
+        stats.emplace_back(prefix + "hits", std::to_string(space->hits.load()));
+        stats.emplace_back(prefix + "writes", std::to_string(space->writes.load()));
+        stats.emplace_back(prefix + "deletes", std::to_string(space->deletes.load()));
+
+        own.clear();
+        space->storage->Stats(own);
+        for (auto &stat : own) {
+            stats.emplace_back(prefix + stat.first, stat.second);
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void NamespacedStorage::Freeze(const std::function<void()> &func) {
+    _fallback->Freeze([this, &func]() { FreezeFrom(0, func); });
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::WatchEvictions(const evicted_func &evicted) {
+    // Keys are stored as is, so all storages could report to the same callback
+    bool result = _fallback->WatchEvictions(evicted);
+    for (auto &space : _namespaces) {
+        result = space->storage->WatchEvictions(evicted) && result;
+    }
+    return result;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::ForEach(const visit_func &visit) const {
+    if (!_fallback->ForEach(visit)) {
+        return false;
+    }
+    for (auto &space : _namespaces) {
+        if (!space->storage->ForEach(visit)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) {
+    std::vector<Afina::Storage *> storages = Cover(prefix);
+    if (storages.size() == 1) {
+        return storages[0]->Scan(prefix, limit, visit);
+    }
+
+    // Key ranges of storages interleave, so the first limit entries of each are merged
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (Afina::Storage *storage : storages) {
+        bool supported = storage->Scan(prefix, limit, [&entries](const std::string &key, const std::string &value) {
+            entries.emplace_back(key, value);
+        });
+        if (!supported) {
+            return false;
+        }
+    }
+
+    std::sort(entries.begin(), entries.end());
+    for (std::size_t i = 0; i < entries.size() && i < limit; i++) {
+        visit(entries[i].first, entries[i].second);
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool NamespacedStorage::DeletePrefix(const std::string &prefix, std::size_t &deleted) {
+    deleted = 0;
+    for (Afina::Storage *storage : Cover(prefix)) {
+        std::size_t n = 0;
+        if (!storage->DeletePrefix(prefix, n)) {
+            return false;
+        }
+        deleted += n;
+    }
+    return true;
+}
+
+// See NamespacedStorage.h
+NamespacedStorage::Namespace *NamespacedStorage::Route(const std::string &key) const {
+    for (auto &space : _namespaces) {
+        const std::string &name = space->name;
+        if (key.size() > name.size() && key[name.size()] == _separator && key.compare(0, name.size(), name) == 0) {
+            return space.get();
+        }
+    }
+    return nullptr;
+}
+
+// See NamespacedStorage.h
+std::vector<Afina::Storage *> NamespacedStorage::Cover(const std::string &prefix) const {
+    Namespace *space = Route(prefix);
+    if (space) {
+        return {space->storage.get()};
+    }
+
+    // Prefix is shorter than "<name><separator>", it could match both default keys and the whole namespaces
+    std::vector<Afina::Storage *> storages = {_fallback.get()};
+    for (auto &space : _namespaces) {
+        std::string head = space->name + _separator;
+        if (head.compare(0, prefix.size(), prefix) == 0) {
+            storages.push_back(space->storage.get());
+        }
+    }
+    return storages;
+}
+
+// See NamespacedStorage.h
+void NamespacedStorage::FreezeFrom(std::size_t i, const std::function<void()> &func) {
+    if (i == _namespaces.size()) {
+        func();
+    } else {
+        _namespaces[i]->storage->Freeze([this, i, &func]() { FreezeFrom(i + 1, func); });
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
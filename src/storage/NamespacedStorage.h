@@ -0,0 +1,119 @@
+#ifndef AFINA_STORAGE_NAMESPACED_STORAGE_H
+#define AFINA_STORAGE_NAMESPACED_STORAGE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Storage routing keys into isolated namespaces
+ * Key "<name><separator>..." goes to the storage of namespace name, all other keys go to the default storage.
+ * Each namespace has its own storage instance, so its own memory budget and eviction policy: filling one namespace
+ * never evicts keys of another one.
+ *
+ * Keys are passed to namespace storages as is, prefix included. Stats() reports default storage statistics
+ * unchanged, followed by "ns_<name>_*" ones for each namespace: reads, hits, writes, deletes and whatever its
+ * storage reports.
+ */
+class NamespacedStorage : public Afina::Storage {
+public:
+    NamespacedStorage(std::shared_ptr<Afina::Storage> fallback, char separator = ':')
+        : _fallback(fallback), _separator(separator) {}
+    ~NamespacedStorage() {}
+
+    /**
+     * Registers namespace, must be done before storage is shared between threads. Throws std::invalid_argument
+     * if name is empty, contains separator or is already taken
+     */
+    void Add(const std::string &name, std::shared_ptr<Afina::Storage> storage);
+
+    // Implements Afina::Storage interface
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override;
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override;
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override;
+
+    // Implements Afina::Storage interface
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override;
+
+    // Implements Afina::Storage interface, namespaces added later aren't watched
+    bool WatchEvictions(const evicted_func &evicted) override;
+
+private:
+    struct Namespace {
+        Namespace(const std::string &name, std::shared_ptr<Afina::Storage> storage)
+            : name(name), storage(storage), reads(0), hits(0), writes(0), deletes(0) {}
+
+        const std::string name;
+        std::shared_ptr<Afina::Storage> storage;
+
+        std::atomic<uint64_t> reads;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> writes;
+        std::atomic<uint64_t> deletes;
+    };
+
+    // Returns namespace of the key, nullptr for the default one
+    Namespace *Route(const std::string &key) const;
+
+    // Returns storage of the namespace, default storage for nullptr
+    Afina::Storage &StorageOf(Namespace *space) const { return space ? *space->storage : *_fallback; }
+
+    // Returns storages which could have keys with the given prefix
+    std::vector<Afina::Storage *> Cover(const std::string &prefix) const;
+
+    // Takes locks of namespaces starting from the given one, then calls func
+    void FreezeFrom(std::size_t i, const std::function<void()> &func);
+
+    std::shared_ptr<Afina::Storage> _fallback;
+    const char _separator;
+
+    // There are a few namespaces, linear scan beats hashing prefix out of each key
+    std::vector<std::unique_ptr<Namespace>> _namespaces;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_NAMESPACED_STORAGE_H
@@ -0,0 +1,160 @@
+#ifndef AFINA_STORAGE_RW_LOCK_LRU_H
+#define AFINA_STORAGE_RW_LOCK_LRU_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <afina/concurrency/SharedMutex.h>
+#include <afina/concurrency/ThreadLocal.h>
+
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SimpleLRU thread safe version for read mostly load
+ * Lookups run in parallel under shared lock and don't update recency. Instead each thread remembers hashes of keys
+ * it has read in its own bump buffer, and once buffer is full replays them to the eviction policy under exclusive
+ * lock, the whole batch at once. Readers never wait for that: if lock is busy they keep buffering, and a buffer
+ * overflowing under contention is dropped. So recency is slightly delayed and lossy, which is fine for eviction.
+ * Buffer is allocated once per thread and hashes are computed for lookups anyway, so reads don't allocate
+ */
+class RWLockLRU : public SimpleLRU {
+public:
+    // Number of reads buffered before thread tries to replay them
+    static const std::size_t bump_batch = 64;
+
+    // Number of reads buffered before buffer is dropped if lock stays busy
+    static const std::size_t bump_limit = 16 * bump_batch;
+
+    RWLockLRU(size_t max_size = 1024, std::unique_ptr<EvictionPolicy> policy = nullptr)
+        : SimpleLRU(max_size, std::move(policy)) {}
+    ~RWLockLRU() {}
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value) override {
+        std::lock_guard<Afina::Concurrency::SharedMutex> lock(_lock);
+        return SimpleLRU::Put(key, value);
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        std::lock_guard<Afina::Concurrency::SharedMutex> lock(_lock);
+        return SimpleLRU::PutIfAbsent(key, value);
+    }
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value) override {
+        std::lock_guard<Afina::Concurrency::SharedMutex> lock(_lock);
+        return SimpleLRU::Set(key, value);
+    }
+
+    // see SimpleLRU.h
+    bool Delete(const std::string &key) override {
+        std::lock_guard<Afina::Concurrency::SharedMutex> lock(_lock);
+        return SimpleLRU::Delete(key);
+    }
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, std::string &value) override {
+        std::size_t hash = HashBytes(key);
+        bool found;
+        {
+            Afina::Concurrency::SharedLock<Afina::Concurrency::SharedMutex> lock(_lock);
+            found = Lookup(hash, key, value);
+        }
+
+        std::vector<std::size_t> &bumps = Bumps();
+        bumps.push_back(hash);
+        if (bumps.size() >= bump_batch) {
+            Drain(bumps);
+        }
+        return found;
+    }
+
+    // see SimpleLRU.h
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override {
+        std::vector<std::size_t> &bumps = Bumps();
+        {
+            Afina::Concurrency::SharedLock<Afina::Concurrency::SharedMutex> lock(_lock);
+            std::string value;
+            for (std::size_t i = 0; i < keys.size(); i++) {
+                std::size_t hash = HashBytes(keys[i]);
+                if (Lookup(hash, keys[i], value)) {
+                    found(i, value);
+                }
+                if (bumps.size() < bump_limit) {
+                    bumps.push_back(hash);
+                }
+            }
+        }
+
+        if (bumps.size() >= bump_batch) {
+            Drain(bumps);
+        }
+    }
+
+    // see SimpleLRU.h
+    void Freeze(const std::function<void()> &func) override {
+        std::lock_guard<Afina::Concurrency::SharedMutex> lock(_lock);
+        func();
+    }
+
+    // see SimpleLRU.h
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override {
+        Afina::Concurrency::SharedLock<Afina::Concurrency::SharedMutex> lock(_lock);
+        return SimpleLRU::Scan(prefix, limit, visit);
+    }
+
+    // see SimpleLRU.h
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override {
+        std::lock_guard<Afina::Concurrency::SharedMutex> lock(_lock);
+        return SimpleLRU::DeletePrefix(prefix, deleted);
+    }
+
+    // see SimpleLRU.h
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override {
+        Afina::Concurrency::SharedLock<Afina::Concurrency::SharedMutex> lock(_lock);
+        SimpleLRU::Stats(stats);
+    }
+
+private:
+    // Returns bump buffer of the calling thread, room for a full one is reserved on first use
+    std::vector<std::size_t> &Bumps() {
+        std::vector<std::size_t> &bumps = _bumps.get();
+        if (bumps.capacity() == 0) {
+            bumps.reserve(bump_limit);
+        }
+        return bumps;
+    }
+
+    // Replays buffered reads if exclusive lock is available right away
+    void Drain(std::vector<std::size_t> &bumps) {
+        std::unique_lock<Afina::Concurrency::SharedMutex> lock(_lock, std::try_to_lock);
+        if (lock.owns_lock()) {
+            for (std::size_t hash : bumps) {
+                Touch(hash);
+            }
+            bumps.clear();
+        } else if (bumps.size() >= bump_limit) {
+            bumps.clear();
+        }
+    }
+
+    // Readers share it, writers and draining readers own it exclusively
+    Afina::Concurrency::SharedMutex _lock;
+
+    // Hashes of keys read by each thread and not reported to the policy yet
+    Afina::Concurrency::ThreadLocal<std::vector<std::size_t>> _bumps;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_RW_LOCK_LRU_H
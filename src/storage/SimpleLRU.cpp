@@ -1,22 +1,259 @@
 #include "SimpleLRU.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "policy/LRUPolicy.h"
+
 namespace Afina {
 namespace Backend {
 
+// See SimpleLRU.h
+SimpleLRU::SimpleLRU(size_t max_size, std::unique_ptr<EvictionPolicy> policy)
+    : _max_size(max_size), _size(0), _policy(std::move(policy)), _evicted_inline(0), _evictions(0) {
+    if (!_policy) {
+        _policy.reset(new LRUPolicy());
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Put(const std::string &key, const std::string &value) {
+    std::size_t hash = HashBytes(key);
+    Entry *entry = _lru_index.find(hash, key);
+    if (entry != nullptr) {
+        return Update(hash, *entry, value);
+    }
+    return Insert(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    if (_lru_index.find(HashBytes(key), key) != nullptr) {
+        return false;
+    }
+    return Insert(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Set(const std::string &key, const std::string &value) {
+    std::size_t hash = HashBytes(key);
+    Entry *entry = _lru_index.find(hash, key);
+    if (entry == nullptr) {
+        return false;
+    }
+    return Update(hash, *entry, value);
+}
+
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Put(const std::string &key, const std::string &value) { return false; }
+bool SimpleLRU::Delete(const std::string &key) {
+    Entry *entry = _lru_index.find(HashBytes(key), key);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    Remove(*entry, false);
+    return true;
+}
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) { return false; }
+bool SimpleLRU::Get(const std::string &key, std::string &value) {
+    std::size_t hash = HashBytes(key);
+    Entry *entry = _lru_index.find(hash, key);
+    if (entry == nullptr) {
+        _policy->Miss(hash);
+        return false;
+    }
+
+    value.assign(entry->value(), entry->value_len);
+    _policy->Access(*entry);
+    return true;
+}
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Set(const std::string &key, const std::string &value) { return false; }
+bool SimpleLRU::ForEach(const visit_func &visit) const {
+    std::string key, value;
+    _lru_index.for_each([&key, &value, &visit](const Entry &entry) {
+        key.assign(entry.key(), entry.key_len);
+        value.assign(entry.value(), entry.value_len);
+        visit(key, value);
+    });
+    return true;
+}
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Delete(const std::string &key) { return false; }
+bool SimpleLRU::Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) {
+    std::vector<Entry *> found;
+    Matching(prefix, found);
+
+    // Only entries to be visited need to be in order
+    limit = std::min(limit, found.size());
+    std::partial_sort(found.begin(), found.begin() + limit, found.end(),
+                      [](const Entry *a, const Entry *b) { return KeyRef(*a) < KeyRef(*b); });
+
+    std::string key, value;
+    for (std::size_t i = 0; i < limit; i++) {
+        key.assign(found[i]->key(), found[i]->key_len);
+        value.assign(found[i]->value(), found[i]->value_len);
+        visit(key, value);
+    }
+    return true;
+}
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Get(const std::string &key, std::string &value) { return false; }
+bool SimpleLRU::DeletePrefix(const std::string &prefix, std::size_t &deleted) {
+    std::vector<Entry *> found;
+    Matching(prefix, found);
+    for (Entry *entry : found) {
+        Remove(*entry, false);
+    }
+    deleted = found.size();
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    stats.emplace_back("curr_items", std::to_string(_lru_index.size()));
+    stats.emplace_back("bytes", std::to_string(_size));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("evictions", std::to_string(_evictions));
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::Reserve(std::size_t count) {
+    // Sizing for the tiniest entries possible would let a wild count take all memory
+    const std::size_t min_entry = 16;
+    _lru_index.reserve(std::min(_lru_index.size() + count, _max_size / min_entry));
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Lookup(std::size_t hash, const std::string &key, std::string &value) const {
+    const Entry *entry = _lru_index.find(hash, key);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    value.assign(entry->value(), entry->value_len);
+    return true;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Touch(std::size_t hash) {
+    Entry *entry = _lru_index.find(hash);
+    if (entry == nullptr) {
+        _policy->Miss(hash);
+    } else {
+        _policy->Access(*entry);
+    }
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Insert(const std::string &key, const std::string &value) {
+    std::size_t need = key.size() + value.size();
+    if (need > _max_size) {
+        return false;
+    }
+
+    std::unique_ptr<Entry, Entry::Deleter> entry(Entry::Create(key, value));
+    if (!entry) {
+        return false;
+    }
+    Evict(need);
+
+    Entry &ref = *entry;
+    _lru_index.insert(HashBytes(key), ref);
+    entry.release();
+    _policy->Insert(ref);
+    _size += need;
+    return true;
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Update(std::size_t hash, Entry &old, const std::string &value) {
+    if (old.key_len + value.size() > _max_size) {
+        return false;
+    }
+
+    std::unique_ptr<Entry, Entry::Deleter> entry(Entry::Create(old.key(), old.key_len, value.data(), value.size()));
+    if (!entry) {
+        return false;
+    }
+
+    // Policy forgets old entry for a while, that also guarantees eviction never picks it
+    _policy->Erase(old, false);
+    _size -= old.value_len;
+    Evict(value.size());
+
+    // New entry takes place of the old one both in index and in the policy queue
+    Entry &ref = *entry;
+    ref.queue = old.queue;
+    _lru_index.replace(hash, old, ref);
+    entry.release();
+    Entry::Destroy(&old);
+
+    _size += value.size();
+    _policy->Reinsert(ref);
+    _policy->Access(ref);
+    return true;
+}
+
+// See SimpleLRU.h
+SimpleLRU::entry_ptr SimpleLRU::Detach(Entry &entry, bool evicted) {
+    _policy->Erase(entry, evicted);
+    _size -= entry.size();
+    if (evicted) {
+        _evictions++;
+    }
+
+    _lru_index.remove(HashBytes(entry.key(), entry.key_len), entry);
+    return entry_ptr(&entry);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Evict(std::size_t extra) {
+    while (_size + extra > _max_size) {
+        Entry *victim = _policy->Victim();
+        if (victim == nullptr) {
+            break;
+        }
+
+        if (_on_evict) {
+            _on_evict(*victim);
+        }
+        if (_on_evict_key) {
+            _on_evict_key(std::string(victim->key(), victim->key_len));
+        }
+        Remove(*victim, true);
+        _evicted_inline++;
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Matching(const std::string &prefix, std::vector<Entry *> &found) const {
+    _lru_index.for_each([&prefix, &found](Entry &entry) {
+        if (entry.key_len >= prefix.size() && memcmp(entry.key(), prefix.data(), prefix.size()) == 0) {
+            found.push_back(&entry);
+        }
+    });
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::EvictTo(std::size_t target, std::size_t count, std::vector<entry_ptr> &victims) {
+    for (; _size > target && count > 0; count--) {
+        Entry *victim = _policy->Victim();
+        if (victim == nullptr) {
+            break;
+        }
+
+        if (_on_evict) {
+            _on_evict(*victim);
+        }
+        if (_on_evict_key) {
+            _on_evict_key(std::string(victim->key(), victim->key_len));
+        }
+        victims.push_back(Detach(*victim, true));
+    }
+    return _size <= target;
+}
 
 } // namespace Backend
 } // namespace Afina
@@ -1,28 +1,34 @@
 #ifndef AFINA_STORAGE_SIMPLE_LRU_H
 #define AFINA_STORAGE_SIMPLE_LRU_H
 
-#include <map>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <afina/Storage.h>
 
+#include "EvictionPolicy.h"
+
 namespace Afina {
 namespace Backend {
 
 /**
- * # Map based implementation
+ * # Hash table based implementation
+ * Order of eviction is decided by pluggable policy, strict LRU by default. Index keeps no key order, so Scan and
+ * DeletePrefix walk all entries and sort the matching ones.
  * That is NOT thread safe implementaiton!!
  */
 class SimpleLRU : public Afina::Storage {
 public:
-    SimpleLRU(size_t max_size = 1024) : _max_size(max_size) {}
+    // Receives entries evicted to make room for the new ones, called under the cache lock if there is any
+    using evict_func = std::function<void(const Entry &entry)>;
 
-    ~SimpleLRU() {
-        _lru_index.clear();
-        _lru_head.reset(); // TODO: Here is stack overflow
-    }
+    SimpleLRU(size_t max_size = 1024, std::unique_ptr<EvictionPolicy> policy = nullptr);
+
+    ~SimpleLRU() {}
 
     // Implements Afina::Storage interface
     bool Put(const std::string &key, const std::string &value) override;
@@ -39,27 +45,108 @@ public:
     // Implements Afina::Storage interface
     bool Get(const std::string &key, std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override;
+
+    // Implements Afina::Storage interface
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override;
+
+    // Implements Afina::Storage interface
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void Reserve(std::size_t count) override;
+
+    /**
+     * Sets function to call for each evicted entry, explicit deletes and updates aren't reported.
+     * Must be set before cache is shared between threads
+     */
+    void SetEvictionListener(evict_func listener) { _on_evict = listener; }
+
+    // Implements Afina::Storage interface, independent of the listener above
+    bool WatchEvictions(const evicted_func &evicted) override {
+        _on_evict_key = evicted;
+        return true;
+    }
+
+protected:
+    /**
+     * Copies value of the key without reporting access to the policy, hash is HashBytes of the key. Doesn't
+     * modify anything, so could run concurrently with other Lookup calls
+     */
+    bool Lookup(std::size_t hash, const std::string &key, std::string &value) const;
+
+    /**
+     * Reports access to the key with given HashBytes to eviction policy, same way Get does. Missing key counts
+     * as a miss. In the rare case of hash collision access is reported for another key, which only skews recency
+     */
+    void Touch(std::size_t hash);
+
+    // Entry taken out of the cache
+    using entry_ptr = std::unique_ptr<Entry, Entry::Deleter>;
+
+    /**
+     * Evicts entries chosen by policy until cache holds at most target bytes, but no more than count entries.
+     * Victims are moved into the given vector instead of being destroyed, so that caller could free them once
+     * its locks are released. Returns true if target is reached
+     */
+    bool EvictTo(std::size_t target, std::size_t count, std::vector<entry_ptr> &victims);
+
+    // Number of bytes stored and maximum number of bytes allowed
+    std::size_t Used() const { return _size; }
+    std::size_t Capacity() const { return _max_size; }
+
+    // Number of entries evicted by writes to make room for themselves
+    uint64_t EvictedInline() const { return _evicted_inline; }
+
 private:
-    // LRU cache node
-    using lru_node = struct lru_node {
-        std::string key;
-        std::string value;
-        std::unique_ptr<lru_node> prev;
-        std::unique_ptr<lru_node> next;
-    };
+    // Creates new entry for the key, evicting old ones if there is no room for it
+    bool Insert(const std::string &key, const std::string &value);
+
+    // Replaces entry of the key with the new one for the given value, evicting old entries if there is no room
+    // for it. hash is HashBytes of the key
+    bool Update(std::size_t hash, Entry &old, const std::string &value);
+
+    // Removes entry from policy and index
+    void Remove(Entry &entry, bool evicted) { Detach(entry, evicted); }
+
+    // Removes entry from policy and index, returns it to the caller
+    entry_ptr Detach(Entry &entry, bool evicted);
+
+    // Removes entries chosen by policy until there is room for extra bytes
+    void Evict(std::size_t extra);
+
+    // Collects entries which keys start with the given prefix
+    void Matching(const std::string &prefix, std::vector<Entry *> &found) const;
 
     // Maximum number of bytes could be stored in this cache.
     // i.e all (keys+values) must be less the _max_size
     std::size_t _max_size;
 
-    // Main storage of lru_nodes, elements in this list ordered descending by "freshness": in the head
-    // element that wasn't used for longest time.
-    //
-    // List owns all nodes
-    std::unique_ptr<lru_node> _lru_head;
+    // Number of bytes currently stored in this cache
+    std::size_t _size;
+
+    // Decides which entries leave the cache once it is full
+    std::unique_ptr<EvictionPolicy> _policy;
+
+    // Index of entries, allows fast random access to elements by Entry#key. Owns all entries: with 40 byte entry
+    // header, malloc header and rounding of the entry block and bucket slot an entry costs 56 to 79 bytes over
+    // its key and value on 64 bit glibc
+    EntryTable _lru_index;
+
+    // Gets entries before they are evicted
+    evict_func _on_evict;
+
+    // Gets keys of entries before they are evicted
+    evicted_func _on_evict_key;
+
+    uint64_t _evicted_inline;
 
-    // Index of nodes from list above, allows fast random access to elements by lru_node#key
-    std::map<std::reference_wrapper<std::string>, std::reference_wrapper<lru_node>, std::less<std::string>> _lru_index;
+    // Number of entries evicted by any means
+    uint64_t _evictions;
 };
 
 } // namespace Backend
@@ -0,0 +1,384 @@
+#include <afina/Snapshot.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+const char snapshot_magic[8] = {'A', 'F', 'S', 'N', 'A', 'P', '0', '1'};
+
+// Size of stdio buffers, large sequential IO is what makes dump and load fast
+const std::size_t io_buffer = 1 << 20;
+
+// Number of entries reader hands to a loader thread at once
+const std::size_t load_batch = 1024;
+
+// Sanity limit for lengths read from the file, so that corrupted one doesn't make us allocate gigabytes
+const uint64_t max_length = 1 << 30;
+
+// State of the forked snapshots
+std::atomic<bool> fork_running(false);
+std::atomic<uint64_t> forks_done(0);
+std::atomic<uint64_t> forks_failed(0);
+
+// Where client snapshots go, empty if they are disabled
+std::string snapshot_dir;
+
+using file_ptr = std::unique_ptr<FILE, int (*)(FILE *)>;
+
+void PutVarint(FILE *f, uint64_t n) {
+    char buf[10];
+    std::size_t len = 0;
+    for (; n >= 0x80; n >>= 7) {
+        buf[len++] = char(n | 0x80);
+    }
+    buf[len++] = char(n);
+    fwrite(buf, 1, len, f);
+}
+
+bool GetVarint(FILE *f, uint64_t &n) {
+    n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF) {
+            return false;
+        }
+        n |= uint64_t(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PutFixed(FILE *f, uint64_t n) {
+    unsigned char buf[8];
+    for (int i = 0; i < 8; i++) {
+        buf[i] = (n >> (8 * i)) & 0xFF;
+    }
+    fwrite(buf, 1, sizeof(buf), f);
+}
+
+bool GetFixed(FILE *f, uint64_t &n) {
+    unsigned char buf[8];
+    if (fread(buf, 1, sizeof(buf), f) != sizeof(buf)) {
+        return false;
+    }
+
+    n = 0;
+    for (int i = 0; i < 8; i++) {
+        n |= uint64_t(buf[i]) << (8 * i);
+    }
+    return true;
+}
+
+bool GetString(FILE *f, uint64_t size, std::string &out) {
+    out.resize(size);
+    return size == 0 || fread(&out[0], 1, size, f) == size;
+}
+
+// Batches of entries passed from reader to loader threads
+class LoadQueue {
+public:
+    using batch_type = std::vector<std::pair<std::string, std::string>>;
+
+    LoadQueue(std::size_t capacity) : _capacity(capacity), _closed(false), _aborted(false) {}
+
+    // Blocks while queue is full, returns false if queue is aborted
+    bool Push(batch_type &&batch) {
+        std::unique_lock<std::mutex> lock(_lock);
+        _not_full.wait(lock, [this]() { return _batches.size() < _capacity || _aborted; });
+        if (_aborted) {
+            return false;
+        }
+        _batches.push_back(std::move(batch));
+        _not_empty.notify_one();
+        return true;
+    }
+
+    // Blocks while queue is empty, returns false once it is closed and drained
+    bool Pop(batch_type &batch) {
+        std::unique_lock<std::mutex> lock(_lock);
+        _not_empty.wait(lock, [this]() { return !_batches.empty() || _closed; });
+        if (_batches.empty()) {
+            return false;
+        }
+
+        batch = std::move(_batches.front());
+        _batches.pop_front();
+        _not_full.notify_one();
+        return true;
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(_lock);
+        _closed = true;
+        _not_empty.notify_all();
+    }
+
+    // Drops queued batches and makes both sides stop: Pop returns false, Push refuses new batches
+    void Abort() {
+        std::lock_guard<std::mutex> lock(_lock);
+        _batches.clear();
+        _closed = _aborted = true;
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+private:
+    const std::size_t _capacity;
+
+    std::mutex _lock;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    std::deque<batch_type> _batches;
+    bool _closed;
+    bool _aborted;
+};
+
+} // namespace
+
+// See Snapshot.h
+std::size_t WriteSnapshot(const Afina::Storage &storage, const std::string &path) {
+    std::string tmp = path + ".tmp";
+    std::vector<char> buffer(io_buffer);
+    file_ptr f(fopen(tmp.c_str(), "wb"), fclose);
+    if (!f) {
+        throw std::runtime_error("Failed to create " + tmp + ": " + std::string(strerror(errno)));
+    }
+    setvbuf(f.get(), buffer.data(), _IOFBF, buffer.size());
+
+    // Number of entries isn't known in advance, it is patched once everything is written
+    uint64_t count = 0;
+    fwrite(snapshot_magic, 1, sizeof(snapshot_magic), f.get());
+    PutFixed(f.get(), count);
+
+    FILE *out = f.get();
+    bool supported = storage.ForEach([out, &count](const std::string &key, const std::string &value) {
+        PutVarint(out, key.size());
+        PutVarint(out, value.size());
+        fwrite(key.data(), 1, key.size(), out);
+        fwrite(value.data(), 1, value.size(), out);
+        count++;
+    });
+
+    std::string error;
+    if (!supported) {
+        error = "Storage doesn't support snapshots";
+    } else {
+        fseek(out, sizeof(snapshot_magic), SEEK_SET);
+        PutFixed(out, count);
+        if (fflush(out) != 0 || ferror(out) || fsync(fileno(out)) != 0) {
+            error = "Failed to write " + tmp + ": " + std::string(strerror(errno));
+        }
+    }
+
+    if (fclose(f.release()) != 0 && error.empty()) {
+        error = "Failed to write " + tmp + ": " + std::string(strerror(errno));
+    }
+    if (error.empty() && rename(tmp.c_str(), path.c_str()) != 0) {
+        error = "Failed to rename " + tmp + ": " + std::string(strerror(errno));
+    }
+
+    if (!error.empty()) {
+        unlink(tmp.c_str());
+        throw std::runtime_error(error);
+    }
+    return count;
+}
+
+// See Snapshot.h
+bool ForkSnapshot(Afina::Storage &storage, const std::string &path, std::string &error) {
+    bool expected = false;
+    if (!fork_running.compare_exchange_strong(expected, true)) {
+        error = "Snapshot is already running";
+        return false;
+    }
+
+    // Storage locks are held while forking, so child gets consistent copy and no lock stays held forever
+    // by the threads that don't exist in child
+    pid_t pid = -1;
+    int fork_errno = 0;
+    storage.Freeze([&storage, &path, &pid, &fork_errno]() {
+        pid = fork();
+        if (pid == 0) {
+            int code = 0;
+            try {
+                WriteSnapshot(storage, path);
+            } catch (...) {
+                code = 1;
+            }
+            _exit(code);
+        }
+        fork_errno = errno;
+    });
+
+    if (pid < 0) {
+        fork_running.store(false);
+        error = "Failed to fork: " + std::string(strerror(fork_errno));
+        return false;
+    }
+
+    std::thread([pid]() {
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            forks_done++;
+        } else {
+            forks_failed++;
+        }
+        fork_running.store(false);
+    }).detach();
+    return true;
+}
+
+// See Snapshot.h
+void SetSnapshotDirectory(const std::string &dir) { snapshot_dir = dir; }
+
+// See Snapshot.h
+bool SnapshotPath(const std::string &name, std::string &path, std::string &error) {
+    if (snapshot_dir.empty()) {
+        error = "Snapshots are disabled";
+        return false;
+    }
+    if (name.empty() || name[0] == '.' || name.find('/') != std::string::npos) {
+        error = "Bad snapshot name: " + name;
+        return false;
+    }
+
+    path = snapshot_dir + "/" + name;
+    return true;
+}
+
+// See Snapshot.h
+void SnapshotStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    stats.emplace_back("snapshot_running", fork_running.load() ? "1" : "0");
+    stats.emplace_back("snapshots_done", std::to_string(forks_done.load()));
+    stats.emplace_back("snapshots_failed", std::to_string(forks_failed.load()));
+}
+
+// See Snapshot.h
+std::size_t LoadSnapshot(Afina::Storage &storage, const std::string &path, unsigned threads) {
+    std::vector<char> buffer(io_buffer);
+    file_ptr f(fopen(path.c_str(), "rb"), fclose);
+    if (!f) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(strerror(errno)));
+    }
+    setvbuf(f.get(), buffer.data(), _IOFBF, buffer.size());
+
+    char magic[sizeof(snapshot_magic)];
+    uint64_t count;
+    if (fread(magic, 1, sizeof(magic), f.get()) != sizeof(magic) ||
+        memcmp(magic, snapshot_magic, sizeof(magic)) != 0 || !GetFixed(f.get(), count)) {
+        throw std::runtime_error("Not a snapshot file: " + path);
+    }
+
+    // Each entry takes at least two length bytes, so broken count can't make storage allocate more than file size
+    struct stat st;
+    if (fstat(fileno(f.get()), &st) == 0) {
+        storage.Reserve(std::min<uint64_t>(count, st.st_size / 2));
+    }
+
+    if (!storage.ThreadSafe()) {
+        threads = 1;
+    } else if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    LoadQueue queue(2 * threads);
+    std::atomic<std::size_t> stored(0);
+
+    // Storage could throw, exception must not escape loader thread: the first one stops the load and is
+    // reported once all threads are joined
+    std::mutex error_lock;
+    std::string error;
+    std::vector<std::thread> loaders;
+    for (unsigned i = 0; i < threads; i++) {
+        loaders.emplace_back([&storage, &queue, &stored, &error_lock, &error, &path]() {
+            std::string failure;
+            try {
+                LoadQueue::batch_type batch;
+                while (queue.Pop(batch)) {
+                    std::size_t n = 0;
+                    for (auto &entry : batch) {
+                        n += storage.Put(entry.first, entry.second) ? 1 : 0;
+                    }
+                    stored += n;
+                }
+                return;
+            } catch (std::exception &e) {
+                failure = "Failed to load " + path + ": " + e.what();
+            } catch (...) {
+                failure = "Failed to load " + path + ": unknown error";
+            }
+
+            queue.Abort();
+            std::lock_guard<std::mutex> lock(error_lock);
+            if (error.empty()) {
+                error = failure;
+            }
+        });
+    }
+
+    // Reader does nothing but parsing, so it keeps up with several loaders
+    std::string read_error;
+    LoadQueue::batch_type batch;
+    bool accepted = true;
+    for (uint64_t i = 0; i < count && accepted && read_error.empty(); i++) {
+        uint64_t key_len, value_len;
+        batch.emplace_back();
+        if (!GetVarint(f.get(), key_len) || !GetVarint(f.get(), value_len) || key_len > max_length ||
+            value_len > max_length || !GetString(f.get(), key_len, batch.back().first) ||
+            !GetString(f.get(), value_len, batch.back().second)) {
+            read_error = "Snapshot is truncated or corrupted: " + path;
+        } else if (batch.size() >= load_batch) {
+            accepted = queue.Push(std::move(batch));
+            batch = LoadQueue::batch_type();
+            batch.reserve(load_batch);
+        }
+    }
+
+    if (accepted && read_error.empty()) {
+        if (fgetc(f.get()) != EOF) {
+            read_error = "Snapshot has trailing data: " + path;
+        } else if (!batch.empty()) {
+            queue.Push(std::move(batch));
+        }
+    }
+
+    queue.Close();
+    for (auto &t : loaders) {
+        t.join();
+    }
+
+    // Storage failure stops reading, so it goes first
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    } else if (!read_error.empty()) {
+        throw std::runtime_error(read_error);
+    }
+    return stored.load();
+}
+
+} // namespace Backend
+} // namespace Afina
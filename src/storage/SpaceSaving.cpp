@@ -0,0 +1,49 @@
+#include "SpaceSaving.h"
+
+#include <algorithm>
+
+namespace Afina {
+namespace Backend {
+
+// See SpaceSaving.h
+SpaceSaving::SpaceSaving(std::size_t capacity) : _capacity(std::max<std::size_t>(capacity, 1)) {
+    _counters.reserve(_capacity);
+}
+
+// See SpaceSaving.h
+void SpaceSaving::Add(const std::string &key, uint64_t weight) {
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        _counters[it->second].count += weight;
+        return;
+    }
+
+    if (_counters.size() < _capacity) {
+        _index.emplace(key, _counters.size());
+        _counters.push_back(Counter{key, weight, 0});
+        return;
+    }
+
+    // Tracker is small and new keys are rare for skewed streams, so linear search is cheap enough
+    auto min = std::min_element(_counters.begin(), _counters.end(),
+                                [](const Counter &a, const Counter &b) { return a.count < b.count; });
+    _index.erase(min->key);
+    _index.emplace(key, min - _counters.begin());
+
+    min->key = key;
+    min->error = min->count;
+    min->count += weight;
+}
+
+// See SpaceSaving.h
+std::vector<SpaceSaving::Counter> SpaceSaving::Top(std::size_t k) const {
+    std::vector<Counter> result(_counters);
+    std::sort(result.begin(), result.end(), [](const Counter &a, const Counter &b) { return a.count > b.count; });
+    if (result.size() > k) {
+        result.resize(k);
+    }
+    return result;
+}
+
+} // namespace Backend
+} // namespace Afina
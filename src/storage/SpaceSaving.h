@@ -0,0 +1,51 @@
+#ifndef AFINA_STORAGE_SPACE_SAVING_H
+#define AFINA_STORAGE_SPACE_SAVING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Space-Saving top-K tracker
+ * Keeps a fixed number of counters. Key without a counter takes over the one with minimal count and inherits its
+ * value as the possible overestimation, so any key occurring more often than 1/capacity of the stream is
+ * guaranteed to be tracked. That is NOT thread safe implementation
+ */
+class SpaceSaving {
+public:
+    struct Counter {
+        std::string key;
+
+        // Estimated number of occurrences, never less than the real one
+        uint64_t count;
+
+        // Maximum overestimation of count
+        uint64_t error;
+    };
+
+    explicit SpaceSaving(std::size_t capacity);
+
+    // Counts weight more occurrences of the key
+    void Add(const std::string &key, uint64_t weight = 1);
+
+    // Returns up to k tracked keys ordered by estimated count, the most frequent first
+    std::vector<Counter> Top(std::size_t k) const;
+
+private:
+    const std::size_t _capacity;
+
+    std::vector<Counter> _counters;
+
+    // Position of each tracked key in _counters
+    std::unordered_map<std::string, std::size_t> _index;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SPACE_SAVING_H
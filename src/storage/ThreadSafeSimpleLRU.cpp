@@ -0,0 +1,77 @@
+#include "ThreadSafeSimpleLRU.h"
+
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+const std::size_t ThreadSafeSimplLRU::evict_batch;
+
+// See ThreadSafeSimpleLRU.h
+void ThreadSafeSimplLRU::EvictAhead(unsigned low, unsigned high) {
+    if (low >= high || high > 100) {
+        throw std::invalid_argument("Eviction watermarks must satisfy low < high <= 100");
+    }
+    _low = Capacity() / 100 * low + Capacity() % 100 * low / 100;
+    _high = Capacity() / 100 * high + Capacity() % 100 * high / 100;
+}
+
+// See ThreadSafeSimpleLRU.h
+void ThreadSafeSimplLRU::Start() {
+    if (_high > 0 && !_maintainer.joinable()) {
+        _stop = false;
+        _maintainer = std::thread(&ThreadSafeSimplLRU::Maintain, this);
+    }
+}
+
+// See ThreadSafeSimpleLRU.h
+void ThreadSafeSimplLRU::Stop() {
+    if (!_maintainer.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stop = true;
+        _maintain_cv.notify_one();
+    }
+    _maintainer.join();
+}
+
+// See ThreadSafeSimpleLRU.h
+void ThreadSafeSimplLRU::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    std::lock_guard<std::mutex> lock(_lock);
+    SimpleLRU::Stats(stats);
+    if (_high > 0) {
+        stats.emplace_back("evicted_inline", std::to_string(EvictedInline()));
+        stats.emplace_back("evicted_ahead", std::to_string(_evicted_ahead));
+    }
+}
+
+// See ThreadSafeSimpleLRU.h
+void ThreadSafeSimplLRU::Maintain() {
+    std::vector<entry_ptr> victims;
+    victims.reserve(evict_batch);
+
+    std::unique_lock<std::mutex> lock(_lock);
+    while (!_stop) {
+        if (Used() <= _high) {
+            _maintain_cv.wait(lock);
+            continue;
+        }
+
+        // Short batches keep lock hold time bounded, requests get it in between
+        bool done = false;
+        while (!done && !_stop) {
+            done = EvictTo(_low, evict_batch, victims) || victims.empty();
+            _evicted_ahead += victims.size();
+
+            lock.unlock();
+            victims.clear();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -1,9 +1,13 @@
 #ifndef AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 #define AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 
+#include <condition_variable>
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "SimpleLRU.h"
 
@@ -12,46 +16,127 @@ namespace Backend {
 
 /**
  * # SimpleLRU thread safe version
+ * All operations are serialized with the single global lock
  *
- *
+ * Optionally eviction is moved off the write path: once cache is filled over the high watermark, maintenance
+ * thread evicts entries until it is under the low one, a batch per lock acquisition, and frees them without
+ * holding the lock. So writes usually find room ready, inline eviction happens only if writes outrun the thread
  */
 class ThreadSafeSimplLRU : public SimpleLRU {
 public:
-    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
-    ~ThreadSafeSimplLRU() {}
+    // Number of entries maintenance thread evicts per lock acquisition
+    static const std::size_t evict_batch = 64;
+
+    ThreadSafeSimplLRU(size_t max_size = 1024, std::unique_ptr<EvictionPolicy> policy = nullptr)
+        : SimpleLRU(max_size, std::move(policy)), _low(0), _high(0), _stop(false), _evicted_ahead(0) {}
+    ~ThreadSafeSimplLRU() { Stop(); }
+
+    /**
+     * Enables background eviction with watermarks given in percents of max_size, must be called before Start.
+     * Throws std::invalid_argument unless low < high <= 100
+     */
+    void EvictAhead(unsigned low, unsigned high);
+
+    // Implements Afina::Storage interface
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
 
     // see SimpleLRU.h
     bool Put(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
-        return SimpleLRU::Put(key, value);
+        std::lock_guard<std::mutex> lock(_lock);
+        bool result = SimpleLRU::Put(key, value);
+        Wake();
+        return result;
     }
 
     // see SimpleLRU.h
     bool PutIfAbsent(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
-        return SimpleLRU::PutIfAbsent(key, value);
+        std::lock_guard<std::mutex> lock(_lock);
+        bool result = SimpleLRU::PutIfAbsent(key, value);
+        Wake();
+        return result;
     }
 
     // see SimpleLRU.h
     bool Set(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
-        return SimpleLRU::Set(key, value);
+        std::lock_guard<std::mutex> lock(_lock);
+        bool result = SimpleLRU::Set(key, value);
+        Wake();
+        return result;
     }
 
     // see SimpleLRU.h
     bool Delete(const std::string &key) override {
-        // TODO: sinchronization
+        std::lock_guard<std::mutex> lock(_lock);
         return SimpleLRU::Delete(key);
     }
 
     // see SimpleLRU.h
     bool Get(const std::string &key, std::string &value) override {
-        // TODO: sinchronization
+        std::lock_guard<std::mutex> lock(_lock);
         return SimpleLRU::Get(key, value);
     }
 
+    // see SimpleLRU.h
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override {
+        std::lock_guard<std::mutex> lock(_lock);
+        std::string value;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (SimpleLRU::Get(keys[i], value)) {
+                found(i, value);
+            }
+        }
+    }
+
+    // see SimpleLRU.h
+    void Freeze(const std::function<void()> &func) override {
+        std::lock_guard<std::mutex> lock(_lock);
+        func();
+    }
+
+    // see SimpleLRU.h
+    bool Scan(const std::string &prefix, std::size_t limit, const visit_func &visit) override {
+        std::lock_guard<std::mutex> lock(_lock);
+        return SimpleLRU::Scan(prefix, limit, visit);
+    }
+
+    // see SimpleLRU.h
+    bool DeletePrefix(const std::string &prefix, std::size_t &deleted) override {
+        std::lock_guard<std::mutex> lock(_lock);
+        return SimpleLRU::DeletePrefix(prefix, deleted);
+    }
+
+    // see SimpleLRU.h
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
 private:
-    // TODO: sinchronization primitives
+    // Must be called under lock after each write: wakes up maintenance thread if cache is over high watermark
+    void Wake() {
+        if (_high > 0 && Used() > _high) {
+            _maintain_cv.notify_one();
+        }
+    }
+
+    // Maintenance thread body
+    void Maintain();
+
+    // Global lock, serializes all operations on the cache
+    std::mutex _lock;
+
+    // Watermarks in bytes, zero if background eviction is off
+    std::size_t _low;
+    std::size_t _high;
+
+    std::condition_variable _maintain_cv;
+    std::thread _maintainer;
+    bool _stop;
+
+    uint64_t _evicted_ahead;
 };
 
 } // namespace Backend
@@ -0,0 +1,571 @@
+#include "TieredStorage.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Entry.h"
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Splits record into key and value, returns false if it is malformed
+bool ParseRecord(const char *record, std::size_t size, std::string &key, std::string &value) {
+    uint32_t key_len, value_len;
+    if (size < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+
+    memcpy(&key_len, record, sizeof(key_len));
+    memcpy(&value_len, record + sizeof(key_len), sizeof(value_len));
+    if (2 * sizeof(uint32_t) + uint64_t(key_len) + value_len != size) {
+        return false;
+    }
+
+    const char *data = record + 2 * sizeof(uint32_t);
+    key.assign(data, key_len);
+    value.assign(data + key_len, value_len);
+    return true;
+}
+
+bool ReadAll(int fd, char *data, std::size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+bool WriteAll(int fd, const char *data, std::size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+const std::size_t TieredStorage::record_header;
+const std::size_t TieredStorage::max_promotions;
+
+// See TieredStorage.h
+TieredStorage::TieredStorage(std::shared_ptr<SimpleLRU> memory, const std::string &path, std::size_t disk_size,
+                             std::size_t segment_size)
+    : _memory(memory), _segment_size(segment_size), _fd(-1), _open(-1), _sealed(0), _moved(0), _busy(0), _stop(false),
+      _spills(0), _hits(0), _misses(0), _promoted(0), _compactions(0), _dropped(0) {
+    if (!memory->ThreadSafe()) {
+        throw std::invalid_argument("Memory tier must be thread safe");
+    }
+    if (segment_size > UINT32_MAX || disk_size / segment_size < 2) {
+        throw std::runtime_error("Disk tier must hold at least two segments");
+    }
+
+    // Contents of the previous run is useless without index
+    _fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(strerror(errno)));
+    }
+
+    _segments.resize(disk_size / segment_size);
+    _memory->SetEvictionListener([this](const Entry &entry) { Spill(entry); });
+
+    _writer = std::thread(&TieredStorage::Write, this);
+    _promoter = std::thread(&TieredStorage::Promote, this);
+}
+
+// See TieredStorage.h
+TieredStorage::~TieredStorage() {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stop = true;
+        _write_cv.notify_one();
+        _promote_cv.notify_one();
+    }
+    _writer.join();
+    _promoter.join();
+    _memory->SetEvictionListener(nullptr);
+    close(_fd);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool TieredStorage::Put(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> write_lock(_write_lock);
+    if (!_memory->Put(key, value)) {
+        return false;
+    }
+    Drop(key);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool TieredStorage::PutIfAbsent(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> write_lock(_write_lock);
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (Cold(key)) {
+            return false;
+        }
+    }
+    return _memory->PutIfAbsent(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool TieredStorage::Set(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> write_lock(_write_lock);
+    if (_memory->Set(key, value)) {
+        Drop(key);
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!Cold(key)) {
+            return false;
+        }
+    }
+
+    // New value goes to memory right away, old one is just dropped
+    if (!_memory->Put(key, value)) {
+        return false;
+    }
+    Drop(key);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool TieredStorage::Delete(const std::string &key) {
+    std::lock_guard<std::mutex> write_lock(_write_lock);
+    bool hot = _memory->Delete(key);
+    bool cold = Drop(key);
+    return hot || cold;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool TieredStorage::Get(const std::string &key, std::string &value) {
+    while (true) {
+        uint64_t moved = _moved.load();
+        if (_memory->Get(key, value) || GetCold(key, value)) {
+            return true;
+        } else if (_moved.load() == moved) {
+            return false;
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void TieredStorage::MultiGet(const std::vector<std::string> &keys, const found_func &found) {
+    std::vector<std::string> values(keys.size());
+    std::vector<char> hit(keys.size(), 0);
+    uint64_t moved = _moved.load();
+    _memory->MultiGet(keys, [&values, &hit](std::size_t i, const std::string &value) {
+        values[i] = value;
+        hit[i] = 1;
+    });
+
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (!hit[i]) {
+            hit[i] = GetCold(keys[i], values[i]);
+        }
+    }
+
+    // Some of the missing keys could be promoted between the lookups
+    if (_moved.load() != moved) {
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (!hit[i]) {
+                hit[i] = Get(keys[i], values[i]);
+            }
+        }
+    }
+
+    // Callback gets values in order of keys regardless of the tier they came from
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (hit[i]) {
+            found(i, values[i]);
+        }
+    }
+}
+
+// See TieredStorage.h
+void TieredStorage::Stats(std::vector<std::pair<std::string, std::string>> &stats) {
+    _memory->Stats(stats);
+
+    std::lock_guard<std::mutex> lock(_lock);
+    std::size_t live = 0, used = 0;
+    for (auto &segment : _segments) {
+        live += segment.live;
+        used += (segment.state != Segment::State::Free) ? 1 : 0;
+    }
+
+    stats.emplace_back("tier_items", std::to_string(_index.size()));
+    stats.emplace_back("tier_live_bytes", std::to_string(live));
+    stats.emplace_back("tier_segments_used", std::to_string(used));
+    stats.emplace_back("tier_segments", std::to_string(_segments.size()));
+    stats.emplace_back("tier_spills", std::to_string(_spills));
+    stats.emplace_back("tier_hits", std::to_string(_hits));
+    stats.emplace_back("tier_misses", std::to_string(_misses));
+    stats.emplace_back("tier_promotions", std::to_string(_promoted));
+    stats.emplace_back("tier_compactions", std::to_string(_compactions));
+    stats.emplace_back("tier_dropped", std::to_string(_dropped));
+}
+
+// See MapBasedGlobalLockImpl.h
+void TieredStorage::Freeze(const std::function<void()> &func) {
+    std::lock_guard<std::mutex> write_lock(_write_lock);
+    _memory->Freeze([this, &func]() {
+        std::lock_guard<std::mutex> lock(_lock);
+        func();
+    });
+}
+
+// See MapBasedGlobalLockImpl.h
+bool TieredStorage::ForEach(const visit_func &visit) const {
+    if (!_memory->ForEach(visit)) {
+        return false;
+    }
+
+    // Runs without locks in frozen copy, so segment could be rewritten by the origin process since: records that
+    // don't match index anymore are skipped
+    std::string buffer, key, value;
+    for (auto &it : _index) {
+        const Location &location = it.second;
+        const Segment &segment = _segments[location.segment];
+
+        const char *record = nullptr;
+        if (segment.buffer) {
+            record = segment.buffer.get() + location.offset;
+        } else {
+            buffer.resize(location.size);
+            if (!ReadAll(_fd, &buffer[0], location.size, off_t(location.segment) * _segment_size + location.offset)) {
+                continue;
+            }
+            record = buffer.data();
+        }
+
+        if (ParseRecord(record, location.size, key, value) && HashBytes(key) == it.first) {
+            visit(key, value);
+        }
+    }
+    return true;
+}
+
+// See TieredStorage.h
+void TieredStorage::Drain() {
+    std::unique_lock<std::mutex> lock(_lock);
+    _done_cv.wait(lock, [this]() { return _writes.empty() && _promotions.empty() && _busy == 0; });
+}
+
+// See TieredStorage.h
+void TieredStorage::Spill(const Entry &entry) {
+    if (record_header + entry.size() > _segment_size) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_lock);
+    Append(lock, entry.key(), entry.key_len, entry.value(), entry.value_len);
+    _spills++;
+}
+
+// See TieredStorage.h
+bool TieredStorage::GetCold(const std::string &key, std::string &value) {
+    std::unique_lock<std::mutex> lock(_lock);
+    auto it = _index.find(HashBytes(key));
+    if (it == _index.end()) {
+        _misses++;
+        return false;
+    }
+
+    Location location = it->second;
+    std::string stored_key, stored_value;
+    if (!Read(lock, location, stored_key, stored_value) || stored_key != key) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+
+    if (_promotions.size() < max_promotions) {
+        _promotions.push_back(Promotion{key, stored_value, location});
+        _promote_cv.notify_one();
+    }
+    value.swap(stored_value);
+    return true;
+}
+
+// See TieredStorage.h
+bool TieredStorage::Read(std::unique_lock<std::mutex> &lock, const Location &location, std::string &key,
+                         std::string &value) {
+    Segment &segment = _segments[location.segment];
+    if (segment.buffer) {
+        return ParseRecord(segment.buffer.get() + location.offset, location.size, key, value);
+    }
+
+    // Slot could be reclaimed while we read, generation tells if it was
+    uint64_t generation = segment.generation;
+    std::string record(location.size, '\0');
+
+    lock.unlock();
+    bool ok = ReadAll(_fd, &record[0], record.size(), off_t(location.segment) * _segment_size + location.offset);
+    lock.lock();
+
+    return ok && segment.generation == generation && segment.state == Segment::State::Disk &&
+           ParseRecord(record.data(), record.size(), key, value);
+}
+
+// See TieredStorage.h
+bool TieredStorage::Drop(const std::string &key) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _index.find(HashBytes(key));
+    if (it == _index.end()) {
+        return false;
+    }
+    Forget(it);
+    return true;
+}
+
+// See TieredStorage.h
+bool TieredStorage::Cold(const std::string &key) const { return _index.count(HashBytes(key)) > 0; }
+
+// See TieredStorage.h
+TieredStorage::Location TieredStorage::Append(std::unique_lock<std::mutex> &lock, const char *key,
+                                              std::size_t key_len, const char *value, std::size_t value_len) {
+    std::size_t size = record_header + key_len + value_len;
+    while (_open < 0 || _segments[_open].used + size > _segment_size) {
+        if (_open >= 0) {
+            Segment &full = _segments[_open];
+            full.state = Segment::State::Writing;
+            full.sealed = ++_sealed;
+            _writes.push_back(_open);
+            _write_cv.notify_one();
+            _open = -1;
+        }
+        Open(lock);
+    }
+
+    Segment &segment = _segments[_open];
+    char *record = segment.buffer.get() + segment.used;
+    uint32_t lengths[2] = {uint32_t(key_len), uint32_t(value_len)};
+    memcpy(record, lengths, sizeof(lengths));
+    memcpy(record + record_header, key, key_len);
+    memcpy(record + record_header + key_len, value, value_len);
+
+    Location location{uint32_t(_open), uint32_t(segment.used), uint32_t(size)};
+    segment.used += size;
+    segment.live += size;
+
+    uint64_t hash = HashBytes(key, key_len);
+    auto it = _index.find(hash);
+    if (it != _index.end()) {
+        Forget(it);
+    }
+    _index.emplace(hash, location);
+    return location;
+}
+
+// See TieredStorage.h
+void TieredStorage::Open(std::unique_lock<std::mutex> &lock) {
+    std::vector<std::pair<std::string, std::string>> kept;
+    while (true) {
+        for (std::size_t i = 0; i < _segments.size(); i++) {
+            Segment &segment = _segments[i];
+            if (segment.state != Segment::State::Free) {
+                continue;
+            }
+
+            segment.state = Segment::State::Open;
+            segment.buffer.reset(new char[_segment_size]);
+            _open = i;
+
+            // Kept records take at most half of the segment, so they always fit
+            for (auto &record : kept) {
+                Append(lock, record.first.data(), record.first.size(), record.second.data(), record.second.size());
+            }
+            return;
+        }
+
+        int emptiest = -1, oldest = -1;
+        for (std::size_t i = 0; i < _segments.size(); i++) {
+            Segment &segment = _segments[i];
+            if (segment.state != Segment::State::Disk) {
+                continue;
+            }
+            if (emptiest < 0 || segment.live < _segments[emptiest].live) {
+                emptiest = i;
+            }
+            if (oldest < 0 || segment.sealed < _segments[oldest].sealed) {
+                oldest = i;
+            }
+        }
+
+        if (emptiest < 0) {
+            // Everything is still being written
+            _done_cv.wait(lock);
+            continue;
+        }
+
+        if (_segments[emptiest].live <= _segment_size / 2) {
+            Reclaim(emptiest, true, kept);
+        } else {
+            Reclaim(oldest, false, kept);
+        }
+    }
+}
+
+// See TieredStorage.h
+void TieredStorage::Reclaim(std::size_t victim, bool compact, std::vector<std::pair<std::string, std::string>> &kept) {
+    Segment &segment = _segments[victim];
+
+    std::string data;
+    const char *base = segment.buffer.get();
+    if (base == nullptr) {
+        data.resize(segment.used);
+        if (ReadAll(_fd, &data[0], data.size(), off_t(victim) * _segment_size)) {
+            base = data.data();
+        }
+    }
+
+    std::string key, value;
+    for (std::size_t offset = 0; base != nullptr && offset + record_header <= segment.used;) {
+        uint32_t lengths[2];
+        memcpy(lengths, base + offset, sizeof(lengths));
+        std::size_t size = record_header + lengths[0] + lengths[1];
+        if (offset + size > segment.used || !ParseRecord(base + offset, size, key, value)) {
+            break;
+        }
+
+        auto it = _index.find(HashBytes(key));
+        if (it != _index.end() && it->second.segment == victim && it->second.offset == offset) {
+            _index.erase(it);
+            if (compact) {
+                kept.emplace_back(key, value);
+            } else {
+                _dropped++;
+            }
+        }
+        offset += size;
+    }
+
+    // Segment couldn't be read, whatever index still has there is lost
+    if (base == nullptr) {
+        for (auto it = _index.begin(); it != _index.end();) {
+            if (it->second.segment == victim) {
+                it = _index.erase(it);
+                _dropped++;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    _compactions += compact ? 1 : 0;
+    segment.state = Segment::State::Free;
+    segment.generation++;
+    segment.used = segment.live = 0;
+    segment.buffer.reset();
+}
+
+// See TieredStorage.h
+void TieredStorage::Forget(std::unordered_map<uint64_t, Location>::iterator it) {
+    _segments[it->second.segment].live -= it->second.size;
+    _index.erase(it);
+}
+
+// See TieredStorage.h
+void TieredStorage::Write() {
+    std::unique_lock<std::mutex> lock(_lock);
+    while (true) {
+        _write_cv.wait(lock, [this]() { return !_writes.empty() || _stop; });
+        if (_writes.empty()) {
+            break;
+        }
+
+        std::size_t i = _writes.front();
+        _writes.pop_front();
+        _busy++;
+
+        // Buffer is released by this thread only, so it stays valid without lock
+        Segment &segment = _segments[i];
+        const char *data = segment.buffer.get();
+        std::size_t size = segment.used;
+
+        lock.unlock();
+        bool ok = WriteAll(_fd, data, size, off_t(i) * _segment_size);
+        lock.lock();
+
+        if (ok) {
+            segment.state = Segment::State::Disk;
+            segment.buffer.reset();
+        } else {
+            std::vector<std::pair<std::string, std::string>> unused;
+            Reclaim(i, false, unused);
+        }
+        _busy--;
+        _done_cv.notify_all();
+    }
+}
+
+// See TieredStorage.h
+void TieredStorage::Promote() {
+    std::unique_lock<std::mutex> lock(_lock);
+    while (true) {
+        _promote_cv.wait(lock, [this]() { return !_promotions.empty() || _stop; });
+        if (_stop) {
+            break;
+        }
+
+        Promotion promotion = std::move(_promotions.front());
+        _promotions.pop_front();
+        _busy++;
+        lock.unlock();
+
+        bool promoted = false;
+        {
+            // Writes can't sneak in between the check and the insert, so the value is still current once inserted
+            std::lock_guard<std::mutex> write_lock(_write_lock);
+            bool current = false;
+            {
+                std::lock_guard<std::mutex> index_lock(_lock);
+                auto it = _index.find(HashBytes(promotion.key));
+                current = it != _index.end() && it->second == promotion.location;
+            }
+
+            // Disk copy is dropped only once memory has the entry, so readers always find it in one of the tiers.
+            // Insert could spill other entries and move records around, so location is checked again
+            promoted = current && _memory->PutIfAbsent(promotion.key, promotion.value);
+            if (promoted) {
+                std::lock_guard<std::mutex> index_lock(_lock);
+                auto it = _index.find(HashBytes(promotion.key));
+                if (it != _index.end() && it->second == promotion.location) {
+                    Forget(it);
+                    _moved++;
+                }
+            }
+        }
+
+        lock.lock();
+        _promoted += promoted ? 1 : 0;
+        _busy--;
+        _done_cv.notify_all();
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,227 @@
+#ifndef AFINA_STORAGE_TIERED_STORAGE_H
+#define AFINA_STORAGE_TIERED_STORAGE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <afina/Storage.h>
+
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Two tier storage: LRU in memory, evicted entries in a local file
+ * Entries evicted from the memory tier are not lost but appended to the open segment buffer. Once segment is full
+ * it is written to the file by background thread with a single large write. Memory keeps only compact index:
+ * key hash to segment, offset and size, so disk tier could be much larger than RAM.
+ *
+ * Read missing memory tier is served from segment (buffer or file) and the entry is queued for promotion: background
+ * thread moves it back into memory unless it was changed meanwhile. Writes go to memory and drop disk copy. Entry
+ * always enters the other tier before it leaves one, reader which missed both because entry was promoted between
+ * the lookups sees the promotion counter changed and looks again.
+ *
+ * File is split into fixed segment slots. Once all are taken, the slot with the least live data is reclaimed:
+ * if it is mostly garbage live entries are moved into the new open segment, otherwise the oldest segment is
+ * dropped as a whole, disk tier is a cache too.
+ *
+ * Disk entries are found by 64 bit hash and checked against the key stored in the record, two keys with the same
+ * hash can't be both on disk, the later one wins.
+ *
+ * Lock order: writes and promotions lock, memory tier locks, disk tier lock
+ */
+class TieredStorage : public Afina::Storage {
+public:
+    /**
+     * memory must not be used directly once given here. It must be thread safe, background promoter writes into
+     * it while clients read, throws std::invalid_argument otherwise. Throws std::runtime_error if file can't be
+     * opened or is too small to hold two segments
+     */
+    TieredStorage(std::shared_ptr<SimpleLRU> memory, const std::string &path, std::size_t disk_size,
+                  std::size_t segment_size = 4 << 20);
+    ~TieredStorage();
+
+    TieredStorage(const TieredStorage &) = delete;
+    TieredStorage &operator=(const TieredStorage &) = delete;
+
+    // Implements Afina::Storage interface
+    void Start() override { _memory->Start(); }
+
+    // Implements Afina::Storage interface
+    void Stop() override { _memory->Stop(); }
+
+    // Implements Afina::Storage interface
+    bool ThreadSafe() const override { return true; }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void MultiGet(const std::vector<std::string> &keys, const found_func &found) override;
+
+    // Implements Afina::Storage interface
+    void Stats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+    // Implements Afina::Storage interface
+    void Freeze(const std::function<void()> &func) override;
+
+    // Implements Afina::Storage interface
+    bool ForEach(const visit_func &visit) const override;
+
+    /**
+     * Waits until all queued segment writes and promotions are done
+     */
+    void Drain();
+
+private:
+    // Size of record header: key and value lengths
+    static const std::size_t record_header = 8;
+
+    // Promotions queued above that are dropped
+    static const std::size_t max_promotions = 1024;
+
+    struct Location {
+        uint32_t segment;
+        uint32_t offset;
+        uint32_t size;
+
+        bool operator==(const Location &other) const {
+            return segment == other.segment && offset == other.offset && size == other.size;
+        }
+    };
+
+    struct Segment {
+        enum class State { Free, Open, Writing, Disk };
+
+        Segment() : state(State::Free), generation(0), sealed(0), used(0), live(0) {}
+
+        State state;
+
+        // Incremented each time slot is reused, so that reader could detect it
+        uint64_t generation;
+
+        // Order in which segments were filled, the lowest is the oldest
+        uint64_t sealed;
+
+        // Bytes appended and bytes still referenced by index
+        std::size_t used;
+        std::size_t live;
+
+        // Contents while segment is open or being written
+        std::unique_ptr<char[]> buffer;
+    };
+
+    struct Promotion {
+        std::string key;
+        std::string value;
+        Location location;
+    };
+
+    // Eviction listener of the memory tier
+    void Spill(const Entry &entry);
+
+    // Copies value of the key from disk tier and queues promotion. Doesn't look into memory tier
+    bool GetCold(const std::string &key, std::string &value);
+
+    // Reads key and value of the record at location. Must be called under lock, releases
+    // it for the time of disk read. Returns false if record has gone meanwhile
+    bool Read(std::unique_lock<std::mutex> &lock, const Location &location, std::string &key, std::string &value);
+
+    // Drops disk copy of the key if any, returns true if there was one
+    bool Drop(const std::string &key);
+
+    // Methods below must be called under lock
+
+    // Returns true if disk tier has record for the key hash
+    bool Cold(const std::string &key) const;
+
+    // Appends record into the open segment, switching segments if needed. Returns location of the record
+    Location Append(std::unique_lock<std::mutex> &lock, const char *key, std::size_t key_len, const char *value,
+                    std::size_t value_len);
+
+    // Makes free slot the open segment, reclaiming one if there is no free slot
+    void Open(std::unique_lock<std::mutex> &lock);
+
+    // Frees the segment: moves its live records into kept, or just forgets them if compact is false
+    void Reclaim(std::size_t victim, bool compact, std::vector<std::pair<std::string, std::string>> &kept);
+
+    // Removes index element and accounts its record as garbage
+    void Forget(std::unordered_map<uint64_t, Location>::iterator it);
+
+    // Background threads bodies
+    void Write();
+    void Promote();
+
+    std::shared_ptr<SimpleLRU> _memory;
+
+    const std::size_t _segment_size;
+
+    int _fd;
+
+    // Serializes writes with promotions, so that promotion never brings back a value changed meanwhile
+    std::mutex _write_lock;
+
+    // Protects everything below
+    mutable std::mutex _lock;
+
+    // Signals writer and promoter about queued work and everybody else about completed one
+    std::condition_variable _write_cv;
+    std::condition_variable _promote_cv;
+    std::condition_variable _done_cv;
+
+    std::vector<Segment> _segments;
+    std::unordered_map<uint64_t, Location> _index;
+
+    // Segment being filled, -1 if none
+    int _open;
+    uint64_t _sealed;
+
+    // Segments waiting to be written and entries waiting to be promoted
+    std::deque<std::size_t> _writes;
+    std::deque<Promotion> _promotions;
+
+    // Number of disk copies removed by promotions, changed under lock
+    std::atomic<uint64_t> _moved;
+
+    // Number of tasks taken by background threads but not completed yet
+    int _busy;
+    bool _stop;
+
+    // Statistics
+    uint64_t _spills;
+    uint64_t _hits;
+    uint64_t _misses;
+    uint64_t _promoted;
+    uint64_t _compactions;
+    uint64_t _dropped;
+
+    std::thread _writer;
+    std::thread _promoter;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_TIERED_STORAGE_H
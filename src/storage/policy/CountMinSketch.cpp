@@ -0,0 +1,64 @@
+#include "CountMinSketch.h"
+
+#include <algorithm>
+
+namespace Afina {
+namespace Backend {
+
+// See CountMinSketch.h
+CountMinSketch::CountMinSketch(std::size_t width) : _additions(0) {
+    std::size_t w = 1;
+    while (w < width) {
+        w <<= 1;
+    }
+
+    _mask = w - 1;
+    _sample_size = 10 * w;
+    _table.assign(depth * w, 0);
+}
+
+// See CountMinSketch.h
+void CountMinSketch::Increment(std::size_t hash) {
+    bool added = false;
+    for (std::size_t row = 0; row < depth; row++) {
+        uint8_t &counter = _table[row * (_mask + 1) + Index(hash, row)];
+        if (counter < max_count) {
+            counter++;
+            added = true;
+        }
+    }
+
+    if (added && ++_additions >= _sample_size) {
+        Reset();
+    }
+}
+
+// See CountMinSketch.h
+uint8_t CountMinSketch::Estimate(std::size_t hash) const {
+    uint8_t result = max_count;
+    for (std::size_t row = 0; row < depth; row++) {
+        result = std::min(result, _table[row * (_mask + 1) + Index(hash, row)]);
+    }
+    return result;
+}
+
+// See CountMinSketch.h
+std::size_t CountMinSketch::Index(std::size_t hash, std::size_t row) const {
+    // Each row needs an independent hash, derive them by mixing the original one with a per row seed
+    static const uint64_t seeds[depth] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+                                          0x27D4EB2F165667C5ULL};
+    uint64_t h = (static_cast<uint64_t>(hash) + seeds[row]) * 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 31;
+    return static_cast<std::size_t>(h) & _mask;
+}
+
+// See CountMinSketch.h
+void CountMinSketch::Reset() {
+    for (uint8_t &counter : _table) {
+        counter >>= 1;
+    }
+    _additions /= 2;
+}
+
+} // namespace Backend
+} // namespace Afina
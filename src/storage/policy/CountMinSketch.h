@@ -0,0 +1,51 @@
+#ifndef AFINA_STORAGE_POLICY_COUNT_MIN_SKETCH_H
+#define AFINA_STORAGE_POLICY_COUNT_MIN_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Count-min sketch
+ * Approximate frequency counter with a fixed memory footprint: each key maps onto one small counter in each of the
+ * rows, estimation is the minimum over them. Counters saturate at 15 and are halved once the number of increments
+ * reaches the sample size, so that old popularity fades away.
+ */
+class CountMinSketch {
+public:
+    static const std::size_t depth = 4;
+    static const uint8_t max_count = 15;
+
+    /**
+     * width is rounded up to the power of two, number of increments between resets is ten times width
+     */
+    CountMinSketch(std::size_t width);
+
+    // Counts one more occurrence of the key with the given hash
+    void Increment(std::size_t hash);
+
+    // Returns estimated number of occurrences of the key with the given hash
+    uint8_t Estimate(std::size_t hash) const;
+
+private:
+    // Position of key in the given row
+    std::size_t Index(std::size_t hash, std::size_t row) const;
+
+    // Halves all counters
+    void Reset();
+
+    std::size_t _mask;
+    std::size_t _sample_size;
+    std::size_t _additions;
+
+    // depth rows of width counters
+    std::vector<uint8_t> _table;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_POLICY_COUNT_MIN_SKETCH_H
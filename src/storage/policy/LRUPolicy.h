@@ -0,0 +1,37 @@
+#ifndef AFINA_STORAGE_POLICY_LRU_POLICY_H
+#define AFINA_STORAGE_POLICY_LRU_POLICY_H
+
+#include "../EvictionPolicy.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Strict LRU
+ * Single queue ordered by last access, the least recently used entry leaves first
+ */
+class LRUPolicy : public EvictionPolicy {
+public:
+    // See EvictionPolicy.h
+    void Insert(Entry &e) override { _queue.push_back(e); }
+
+    // See EvictionPolicy.h
+    void Access(Entry &e) override { _queue.move_back(e); }
+
+    // See EvictionPolicy.h
+    void Erase(Entry &e, bool evicted) override { _queue.remove(e); }
+
+    // See EvictionPolicy.h
+    void Reinsert(Entry &e) override { _queue.push_back(e); }
+
+    // See EvictionPolicy.h
+    Entry *Victim() override { return _queue.front(); }
+
+private:
+    EntryList _queue;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_POLICY_LRU_POLICY_H
@@ -0,0 +1,57 @@
+#include "SLRUPolicy.h"
+
+namespace Afina {
+namespace Backend {
+
+// See SLRUPolicy.h
+SLRUPolicy::SLRUPolicy(std::size_t max_size, double protected_ratio)
+    : _protected_size(static_cast<std::size_t>(max_size * protected_ratio)) {}
+
+// See EvictionPolicy.h
+void SLRUPolicy::Insert(Entry &e) {
+    e.queue = Probation;
+    _probation.push_back(e);
+}
+
+// See EvictionPolicy.h
+void SLRUPolicy::Access(Entry &e) {
+    if (e.queue == Protected) {
+        _protected.move_back(e);
+    } else {
+        _probation.remove(e);
+        e.queue = Protected;
+        _protected.push_back(e);
+    }
+    Demote(e);
+}
+
+// See EvictionPolicy.h
+void SLRUPolicy::Erase(Entry &e, bool evicted) { QueueOf(e).remove(e); }
+
+// See EvictionPolicy.h
+void SLRUPolicy::Reinsert(Entry &e) { QueueOf(e).push_back(e); }
+
+// See EvictionPolicy.h
+Entry *SLRUPolicy::Victim() {
+    if (!_probation.empty()) {
+        return _probation.front();
+    }
+    return _protected.front();
+}
+
+// See SLRUPolicy.h
+EntryList &SLRUPolicy::QueueOf(const Entry &e) { return e.queue == Protected ? _protected : _probation; }
+
+// See SLRUPolicy.h
+void SLRUPolicy::Demote(const Entry &keep) {
+    // Demoted entries get one more chance in probation instead of being evicted right away
+    while (_protected.bytes() > _protected_size && _protected.front() != &keep) {
+        Entry &old = *_protected.front();
+        _protected.remove(old);
+        old.queue = Probation;
+        _probation.push_back(old);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,56 @@
+#ifndef AFINA_STORAGE_POLICY_SLRU_POLICY_H
+#define AFINA_STORAGE_POLICY_SLRU_POLICY_H
+
+#include "../EvictionPolicy.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Segmented LRU
+ * New entries go to the probation segment and get promoted to the protected one on the second access. Protected
+ * segment is limited, its least recently used entries are demoted back to probation. Victims are taken from the
+ * probation segment, so a scan over many one-off keys is never able to flush entries that were accessed twice.
+ */
+class SLRUPolicy : public EvictionPolicy {
+public:
+    /**
+     * max_size is the capacity of the cache in bytes, protected_ratio is the share of it protected segment
+     * could occupy
+     */
+    SLRUPolicy(std::size_t max_size, double protected_ratio = 0.8);
+
+    // See EvictionPolicy.h
+    void Insert(Entry &e) override;
+
+    // See EvictionPolicy.h
+    void Access(Entry &e) override;
+
+    // See EvictionPolicy.h
+    void Erase(Entry &e, bool evicted) override;
+
+    // See EvictionPolicy.h
+    void Reinsert(Entry &e) override;
+
+    // See EvictionPolicy.h
+    Entry *Victim() override;
+
+private:
+    enum Segment : uint8_t { Probation = 0, Protected = 1 };
+
+    // Returns segment entry sits in
+    EntryList &QueueOf(const Entry &e);
+
+    // Moves the least recently used protected entries to probation until segment fits its limit
+    void Demote(const Entry &keep);
+
+    const std::size_t _protected_size;
+
+    EntryList _probation;
+    EntryList _protected;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_POLICY_SLRU_POLICY_H
@@ -0,0 +1,113 @@
+#include "TinyLFUPolicy.h"
+
+#include <algorithm>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Sketch is sized by the expected number of entries, that is unknown upfront for a cache limited by bytes
+std::size_t SketchWidth(std::size_t max_size) {
+    const std::size_t average_entry = 64;
+    return std::min<std::size_t>(std::max<std::size_t>(max_size / average_entry, 256), 1 << 22);
+}
+
+} // namespace
+
+// See TinyLFUPolicy.h
+TinyLFUPolicy::TinyLFUPolicy(std::size_t max_size, double window_ratio, double protected_ratio)
+    : _window_size(static_cast<std::size_t>(max_size * window_ratio)),
+      _main_size(max_size - _window_size), _protected_size(static_cast<std::size_t>(_main_size * protected_ratio)),
+      _sketch(SketchWidth(max_size)) {}
+
+// See EvictionPolicy.h
+void TinyLFUPolicy::Insert(Entry &e) {
+    _sketch.Increment(HashBytes(e.key(), e.key_len));
+    e.queue = Window;
+    _window.push_back(e);
+    Balance();
+}
+
+// See EvictionPolicy.h
+void TinyLFUPolicy::Access(Entry &e) {
+    _sketch.Increment(HashBytes(e.key(), e.key_len));
+    if (e.queue != Probation) {
+        QueueOf(e).move_back(e);
+    } else {
+        // Second access in main segment, entry becomes protected
+        _probation.remove(e);
+        e.queue = Protected;
+        _protected.push_back(e);
+    }
+
+    // Protected overflow is demoted back to probation
+    while (_protected.bytes() > _protected_size && _protected.front() != &e) {
+        Entry &old = *_protected.front();
+        _protected.remove(old);
+        old.queue = Probation;
+        _probation.push_back(old);
+    }
+}
+
+// See EvictionPolicy.h
+void TinyLFUPolicy::Miss(std::size_t hash) { _sketch.Increment(hash); }
+
+// See EvictionPolicy.h
+void TinyLFUPolicy::Erase(Entry &e, bool evicted) { QueueOf(e).remove(e); }
+
+// See EvictionPolicy.h
+void TinyLFUPolicy::Reinsert(Entry &e) { QueueOf(e).push_back(e); }
+
+// See EvictionPolicy.h
+Entry *TinyLFUPolicy::Victim() {
+    Entry *victim = _probation.empty() ? _protected.front() : _probation.front();
+    if (_window.bytes() <= _window_size && victim != nullptr) {
+        return victim;
+    }
+
+    // Window is over its limit: its oldest entry competes with main victim for the place in cache
+    Entry *candidate = _window.front();
+    if (candidate == nullptr || victim == nullptr) {
+        return candidate != nullptr ? candidate : victim;
+    }
+
+    uint8_t candidate_freq = _sketch.Estimate(HashBytes(candidate->key(), candidate->key_len));
+    if (candidate_freq > _sketch.Estimate(HashBytes(victim->key(), victim->key_len))) {
+        _window.remove(*candidate);
+        candidate->queue = Probation;
+        _probation.push_back(*candidate);
+        return victim;
+    }
+    return candidate;
+}
+
+// See TinyLFUPolicy.h
+void TinyLFUPolicy::Balance() {
+    // Until main segment is full there is nobody to compete with, so window overflow is admitted as is
+    while (_window.bytes() > _window_size) {
+        Entry &oldest = *_window.front();
+        if (_probation.bytes() + _protected.bytes() + oldest.size() > _main_size) {
+            return;
+        }
+
+        _window.remove(oldest);
+        oldest.queue = Probation;
+        _probation.push_back(oldest);
+    }
+}
+
+// See TinyLFUPolicy.h
+EntryList &TinyLFUPolicy::QueueOf(const Entry &e) {
+    switch (e.queue) {
+    case Window:
+        return _window;
+    case Probation:
+        return _probation;
+    default:
+        return _protected;
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
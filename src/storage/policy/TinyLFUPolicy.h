@@ -0,0 +1,69 @@
+#ifndef AFINA_STORAGE_POLICY_TINY_LFU_POLICY_H
+#define AFINA_STORAGE_POLICY_TINY_LFU_POLICY_H
+
+#include <string>
+
+#include "../EvictionPolicy.h"
+#include "CountMinSketch.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # W-TinyLFU
+ * New entries land in a small window LRU. Once the window overflows its oldest entry becomes a candidate to join
+ * the main segmented LRU, and it is admitted only if its estimated access frequency is higher than the one of main
+ * victim. Otherwise candidate is evicted. Frequencies of all keys, including missing ones, are tracked by
+ * count-min sketch, so keys accessed just once rarely displace popular ones, while the window still gives a chance
+ * to bursts of fresh keys.
+ */
+class TinyLFUPolicy : public EvictionPolicy {
+public:
+    /**
+     * max_size is the capacity of the cache in bytes, window_ratio is the share of it window could occupy.
+     * Remaining part is the main segment, protected_ratio of which is given to protected entries
+     */
+    TinyLFUPolicy(std::size_t max_size, double window_ratio = 0.01, double protected_ratio = 0.8);
+
+    // See EvictionPolicy.h
+    void Insert(Entry &e) override;
+
+    // See EvictionPolicy.h
+    void Access(Entry &e) override;
+
+    // See EvictionPolicy.h
+    void Miss(std::size_t hash) override;
+
+    // See EvictionPolicy.h
+    void Erase(Entry &e, bool evicted) override;
+
+    // See EvictionPolicy.h
+    void Reinsert(Entry &e) override;
+
+    // See EvictionPolicy.h
+    Entry *Victim() override;
+
+private:
+    enum Queue : uint8_t { Window = 0, Probation = 1, Protected = 2 };
+
+    // Returns queue entry sits in
+    EntryList &QueueOf(const Entry &e);
+
+    // Moves window overflow into main segment for as long as it has free room
+    void Balance();
+
+    const std::size_t _window_size;
+    const std::size_t _main_size;
+    const std::size_t _protected_size;
+
+    EntryList _window;
+    EntryList _probation;
+    EntryList _protected;
+
+    CountMinSketch _sketch;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_POLICY_TINY_LFU_POLICY_H
@@ -0,0 +1,93 @@
+#include "TwoQueuePolicy.h"
+
+namespace Afina {
+namespace Backend {
+
+// See TwoQueuePolicy.h
+TwoQueuePolicy::TwoQueuePolicy(std::size_t max_size, double in_ratio, double out_ratio)
+    : _in_size(static_cast<std::size_t>(max_size * in_ratio)),
+      _out_size(static_cast<std::size_t>(max_size * out_ratio)), _out_bytes(0) {}
+
+// See EvictionPolicy.h
+void TwoQueuePolicy::Insert(Entry &e) {
+    auto it = _out_index.find(HashBytes(e.key(), e.key_len));
+    if (it == _out_index.end()) {
+        e.queue = In;
+        _in.push_back(e);
+        return;
+    }
+
+    // Key was seen recently enough, so it is not a one-off
+    _out_bytes -= it->second->size;
+    _out.erase(it->second);
+    _out_index.erase(it);
+
+    e.queue = Main;
+    _main.push_back(e);
+}
+
+// See EvictionPolicy.h
+void TwoQueuePolicy::Access(Entry &e) {
+    // Accesses in A1in are considered correlated and don't change anything
+    if (e.queue == Main) {
+        _main.move_back(e);
+    }
+}
+
+// See EvictionPolicy.h
+void TwoQueuePolicy::Erase(Entry &e, bool evicted) {
+    if (e.queue == Main) {
+        _main.remove(e);
+        return;
+    }
+
+    _in.remove(e);
+    if (evicted) {
+        Remember(e);
+    }
+}
+
+// See EvictionPolicy.h
+void TwoQueuePolicy::Reinsert(Entry &e) {
+    if (e.queue == Main) {
+        _main.push_back(e);
+    } else {
+        _in.push_back(e);
+    }
+}
+
+// See EvictionPolicy.h
+Entry *TwoQueuePolicy::Victim() {
+    if (!_in.empty() && (_in.bytes() > _in_size || _main.empty())) {
+        return _in.front();
+    }
+    return _main.front();
+}
+
+// See TwoQueuePolicy.h
+void TwoQueuePolicy::Remember(const Entry &e) {
+    if (e.size() > _out_size) {
+        return;
+    }
+
+    std::size_t hash = HashBytes(e.key(), e.key_len);
+    auto it = _out_index.find(hash);
+    if (it != _out_index.end()) {
+        _out_bytes -= it->second->size;
+        _out.erase(it->second);
+    }
+
+    _out.push_back(Ghost{hash, e.size()});
+    _out_index[hash] = std::prev(_out.end());
+    _out_bytes += e.size();
+
+    while (_out_bytes > _out_size) {
+        Ghost &old = _out.front();
+        _out_bytes -= old.size;
+        _out_index.erase(old.hash);
+        _out.pop_front();
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,69 @@
+#ifndef AFINA_STORAGE_POLICY_TWO_QUEUE_POLICY_H
+#define AFINA_STORAGE_POLICY_TWO_QUEUE_POLICY_H
+
+#include <list>
+#include <unordered_map>
+
+#include "../EvictionPolicy.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # 2Q
+ * New entries go to the FIFO queue A1in, repeated accesses while being there are ignored. Keys evicted from A1in
+ * are remembered in the ghost queue A1out (key hashes only, no values). Entry inserted again while its key is in A1out
+ * goes straight into the main LRU queue Am. One-off keys never leave A1in, so scans don't disturb Am.
+ */
+class TwoQueuePolicy : public EvictionPolicy {
+public:
+    /**
+     * max_size is the capacity of the cache in bytes. in_ratio is the share of it A1in could occupy before
+     * eviction switches to it, out_ratio limits the total size of entries remembered by A1out
+     */
+    TwoQueuePolicy(std::size_t max_size, double in_ratio = 0.25, double out_ratio = 0.5);
+
+    // See EvictionPolicy.h
+    void Insert(Entry &e) override;
+
+    // See EvictionPolicy.h
+    void Access(Entry &e) override;
+
+    // See EvictionPolicy.h
+    void Erase(Entry &e, bool evicted) override;
+
+    // See EvictionPolicy.h
+    void Reinsert(Entry &e) override;
+
+    // See EvictionPolicy.h
+    Entry *Victim() override;
+
+private:
+    enum Queue : uint8_t { In = 0, Main = 1 };
+
+    // Ghost entry: hash of the key and size of entry it used to be. Hash collision just promotes
+    // some key to Am a bit early
+    struct Ghost {
+        std::size_t hash;
+        std::size_t size;
+    };
+
+    // Remembers key of the entry evicted from A1in, forgets the oldest ghosts if A1out gets too big
+    void Remember(const Entry &e);
+
+    const std::size_t _in_size;
+    const std::size_t _out_size;
+
+    EntryList _in;
+    EntryList _main;
+
+    // A1out, oldest ghost first, and index over it
+    std::list<Ghost> _out;
+    std::unordered_map<std::size_t, std::list<Ghost>::iterator> _out_index;
+    std::size_t _out_bytes;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_POLICY_TWO_QUEUE_POLICY_H
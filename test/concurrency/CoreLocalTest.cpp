@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/CoreLocal.h>
+
+using namespace Afina::Concurrency;
+
+TEST(CoreLocalTest, CurrentCpuInRange) {
+    ASSERT_GT(cpu_count(), 0);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_LT(current_cpu(), cpu_count());
+    }
+}
+
+TEST(CoreLocalTest, SlotsDoNotShareCacheLine) {
+    CoreLocal<int> local(7);
+
+    ASSERT_EQ(cpu_count(), local.size());
+    for (std::size_t i = 0; i < local.size(); i++) {
+        EXPECT_EQ(7, local[i]);
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(&local[i]) % CoreLocal<int>::cache_line);
+    }
+}
+
+TEST(CoreLocalTest, ConcurrentCounters) {
+    CoreLocal<std::atomic<long>> counters;
+    counters.visit([](std::atomic<long> &c) { c.store(0); });
+
+    const int threads = 8, increments = 100000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&counters]() {
+            for (int i = 0; i < increments; i++) {
+                counters.local().fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    long total = counters.aggregate(0L, [](long acc, const std::atomic<long> &c) { return acc + c.load(); });
+    ASSERT_EQ(long(threads) * increments, total);
+}
@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Epoch.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+struct Counted {
+    Counted(std::atomic<int> &c) : freed(c) {}
+    ~Counted() { freed++; }
+    std::atomic<int> &freed;
+};
+
+} // namespace
+
+TEST(EpochTest, ReaderBlocksReclamation) {
+    std::atomic<int> freed(0);
+    EpochManager epoch(1);
+
+    std::atomic<int> stage(0);
+    std::thread reader([&]() {
+        EpochManager::Guard guard(epoch);
+        stage = 1;
+        while (stage != 2) {
+            std::this_thread::yield();
+        }
+    });
+
+    while (stage != 1) {
+        std::this_thread::yield();
+    }
+
+    // Node retired while reader is inside could be still in use by it
+    epoch.retire(new Counted(freed));
+    epoch.collect();
+    EXPECT_EQ(0, freed);
+
+    stage = 2;
+    reader.join();
+
+    epoch.collect();
+    EXPECT_EQ(1, freed);
+}
+
+TEST(EpochTest, NestedGuards) {
+    std::atomic<int> freed(0);
+    EpochManager epoch(1);
+    {
+        EpochManager::Guard outer(epoch);
+        {
+            EpochManager::Guard inner(epoch);
+        }
+
+        // Still inside outer guard
+        epoch.retire(new Counted(freed));
+        epoch.collect();
+        EXPECT_EQ(0, freed);
+    }
+
+    epoch.collect();
+    EXPECT_EQ(1, freed);
+}
+
+TEST(EpochTest, ExitedThreadsLeftovers) {
+    std::atomic<int> freed(0);
+    {
+        EpochManager epoch(1000);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 100; i++) {
+                    EpochManager::Guard guard(epoch);
+                    epoch.retire(new Counted(freed));
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        // Batch is never reached by the threads, their nodes are collected by somebody else
+        epoch.collect();
+        EXPECT_EQ(400, freed);
+
+        epoch.retire(new Counted(freed));
+    }
+
+    // The rest is freed on destruction
+    EXPECT_EQ(401, freed);
+}
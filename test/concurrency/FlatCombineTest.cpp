@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/FlatCombine.h>
+
+using namespace Afina::Concurrency;
+
+struct AddOp {
+    long delta;
+    long result;
+};
+
+TEST(FlatCombineTest, SingleThread) {
+    long value = 0;
+    FlatCombine<AddOp> fc([&value](AddOp *const *ops, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            value += ops[i]->delta;
+            ops[i]->result = value;
+        }
+    });
+
+    AddOp op{5, 0};
+    fc.execute(op);
+    ASSERT_EQ(5, op.result);
+
+    op.delta = 2;
+    fc.execute(op);
+    ASSERT_EQ(7, op.result);
+}
+
+TEST(FlatCombineTest, ConcurrentBatches) {
+    // Plain fields are fine: combiner has exclusive access
+    long value = 0, batches = 0, max_batch = 0;
+    FlatCombine<AddOp> fc([&](AddOp *const *ops, std::size_t n) {
+        batches++;
+        max_batch = std::max<long>(max_batch, n);
+        for (std::size_t i = 0; i < n; i++) {
+            value += ops[i]->delta;
+            ops[i]->result = value;
+        }
+    });
+
+    const int threads = 8, ops = 20000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&fc]() {
+            long last = 0;
+            for (int i = 0; i < ops; i++) {
+                AddOp op{1, 0};
+                fc.execute(op);
+
+                // Results are published back to the caller
+                ASSERT_GT(op.result, last);
+                last = op.result;
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    ASSERT_EQ(long(threads) * ops, value);
+    ASSERT_LE(batches, long(threads) * ops);
+    ASSERT_LE(max_batch, threads);
+}
+
+TEST(FlatCombineTest, MoreThreadsThanSlots) {
+    long value = 0;
+    FlatCombine<AddOp> fc(
+        [&value](AddOp *const *ops, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                value += ops[i]->delta;
+            }
+        },
+        2);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 6; t++) {
+        workers.emplace_back([&fc]() {
+            for (int i = 0; i < 1000; i++) {
+                AddOp op{1, 0};
+                fc.execute(op);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    ASSERT_EQ(6000, value);
+}
+
+TEST(FlatCombineTest, CombinerThrows) {
+    // Batch with negative delta fails as a whole
+    long value = 0;
+    FlatCombine<AddOp> fc(
+        [&value](AddOp *const *ops, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                if (ops[i]->delta < 0) {
+                    throw std::runtime_error("negative delta");
+                }
+            }
+            for (std::size_t i = 0; i < n; i++) {
+                value += ops[i]->delta;
+            }
+        },
+        4);
+
+    AddOp bad{-1, 0};
+    ASSERT_THROW(fc.execute(bad), std::runtime_error);
+
+    // Lock is released and slot is reusable, including by threads without slots
+    std::atomic<long> failed(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&fc, &failed, t]() {
+            for (int i = 0; i < 1000; i++) {
+                AddOp op{(t == 0 && i % 10 == 0) ? -1 : 1, 0};
+                try {
+                    fc.execute(op);
+                } catch (std::runtime_error &) {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    // Every operation either applied or reported failure
+    ASSERT_LE(100, failed.load());
+    ASSERT_EQ(8000 - failed.load(), value);
+}
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/SharedMutex.h>
+
+using namespace Afina::Concurrency;
+
+TEST(SharedMutexTest, ReadersShare) {
+    SharedMutex m;
+    m.lock_shared();
+
+    // Another reader gets in, writer doesn't
+    std::thread t([&m]() {
+        EXPECT_TRUE(m.try_lock_shared());
+        m.unlock_shared();
+        EXPECT_FALSE(m.try_lock());
+    });
+    t.join();
+    m.unlock_shared();
+
+    EXPECT_TRUE(m.try_lock());
+    std::thread r([&m]() { EXPECT_FALSE(m.try_lock_shared()); });
+    r.join();
+    m.unlock();
+}
+
+TEST(SharedMutexTest, WritersExclusive) {
+    SharedMutex m;
+    long counter = 0;
+    std::atomic<bool> torn(false);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10000; i++) {
+                std::lock_guard<SharedMutex> lock(m);
+                counter++;
+            }
+        });
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10000; i++) {
+                SharedLock<SharedMutex> lock(m);
+                long v = counter;
+                if (v != counter) {
+                    torn = true;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(40000, counter);
+    EXPECT_FALSE(torn);
+}
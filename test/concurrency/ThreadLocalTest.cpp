@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+using namespace Afina::Concurrency;
+
+struct Counters {
+    long hits;
+    long misses;
+};
+
+void merge_counters(Counters &into, const Counters &from) {
+    into.hits += from.hits;
+    into.misses += from.misses;
+}
+
+TEST(ThreadLocalTest, InstancePerThread) {
+    ThreadLocal<int> local;
+    local.get() = 1;
+
+    int other = -1;
+    std::thread t([&local, &other]() {
+        other = local.get();
+        local.get() = 2;
+    });
+    t.join();
+
+    ASSERT_EQ(0, other);
+    ASSERT_EQ(1, local.get());
+}
+
+TEST(ThreadLocalTest, ExitedThreadsAreFolded) {
+    ThreadLocal<Counters> stats(merge_counters);
+
+    const int threads = 8, ops = 10000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&stats]() {
+            Counters &my = stats.get();
+            for (int i = 0; i < ops; i++) {
+                if (i % 4 == 0) {
+                    my.misses++;
+                } else {
+                    my.hits++;
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    stats->hits += 1;
+    Counters total = stats.aggregate(Counters{0, 0}, [](Counters acc, const Counters &c) {
+        merge_counters(acc, c);
+        return acc;
+    });
+    ASSERT_EQ(threads * ops / 4, total.misses);
+    ASSERT_EQ(threads * ops * 3 / 4 + 1, total.hits);
+}
+
+TEST(ThreadLocalTest, VisitLiveThreads) {
+    ThreadLocal<long> local;
+
+    std::mutex m;
+    std::condition_variable cv;
+    int ready = 0;
+    bool done = false;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&, t]() {
+            local.get() = t + 1;
+
+            std::unique_lock<std::mutex> lock(m);
+            ready++;
+            cv.notify_all();
+            cv.wait(lock, [&done]() { return done; });
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&ready]() { return ready == 4; });
+    }
+
+    long sum = local.aggregate(0L, [](long acc, long v) { return acc + v; });
+    ASSERT_EQ(1 + 2 + 3 + 4, sum);
+
+    {
+        std::unique_lock<std::mutex> lock(m);
+        done = true;
+        cv.notify_all();
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    // No merge function, values of exited threads are gone
+    sum = local.aggregate(0L, [](long acc, long v) { return acc + v; });
+    ASSERT_EQ(0, sum);
+}
+
+TEST(ThreadLocalTest, OutlivedByThread) {
+    ThreadLocal<int> *local = new ThreadLocal<int>();
+    local->get() = 5;
+
+    std::mutex m;
+    std::condition_variable cv;
+    int stage = 0;
+    std::thread t([&]() {
+        local->get() = 10;
+
+        std::unique_lock<std::mutex> lock(m);
+        stage = 1;
+        cv.notify_all();
+        cv.wait(lock, [&stage]() { return stage == 2; });
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&stage]() { return stage == 1; });
+    }
+    delete local;
+
+    // New object reuses index, must not see instance of the destroyed one
+    ThreadLocal<int> fresh;
+    ASSERT_EQ(0, fresh.get());
+
+    {
+        std::unique_lock<std::mutex> lock(m);
+        stage = 2;
+        cv.notify_all();
+    }
+    t.join();
+}
@@ -62,3 +62,89 @@ TEST(CoroutineTest, Printer) {
     engine.start(_printer, engine, result);
     ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
 }
+
+void _round_robin_worker(Afina::Coroutine::Engine &pe, std::stringstream &out, char name) {
+    for (int i = 0; i < 3; i++) {
+        out << name << i << " ";
+        pe.yield();
+    }
+}
+
+void _round_robin(Afina::Coroutine::Engine &pe, std::stringstream &out) {
+    pe.run(_round_robin_worker, pe, out, 'A');
+    pe.run(_round_robin_worker, pe, out, 'B');
+    pe.run(_round_robin_worker, pe, out, 'C');
+}
+
+TEST(CoroutineTest, RoundRobin) {
+    Afina::Coroutine::Engine engine;
+
+    std::stringstream out;
+    engine.start(_round_robin, engine, out);
+    ASSERT_EQ("A0 B0 C0 A1 B1 C1 A2 B2 C2 ", out.str());
+}
+
+void _short_lived(int &counter) { counter++; }
+
+void _spawner(Afina::Coroutine::Engine &pe, int &counter) {
+    for (int i = 0; i < 100000; i++) {
+        pe.run(_short_lived, counter);
+        if (i % 100 == 0) {
+            pe.yield();
+        }
+    }
+}
+
+TEST(CoroutineTest, ManyShortLived) {
+    Afina::Coroutine::Engine engine;
+
+    int counter = 0;
+    engine.start(_spawner, engine, counter);
+    ASSERT_EQ(100000, counter);
+}
+
+void _sleeper(Afina::Coroutine::Engine &pe, std::stringstream &out, int id) {
+    pe.block();
+    out << id << " ";
+}
+
+void *_sleepers[4];
+void _batch_waker(Afina::Coroutine::Engine &pe, std::stringstream &out) {
+    for (int i = 0; i < 4; i++) {
+        _sleepers[i] = pe.run(_sleeper, pe, out, std::move(i));
+    }
+
+    // Everybody gets blocked
+    pe.yield();
+
+    pe.unblock(&_sleepers[0], &_sleepers[4]);
+    pe.yield();
+    out << "END";
+}
+
+TEST(CoroutineTest, BatchUnblock) {
+    Afina::Coroutine::Engine engine;
+
+    std::stringstream out;
+    engine.start(_batch_waker, engine, out);
+    ASSERT_EQ("0 1 2 3 END", out.str());
+}
+
+void _unblocker_sleeper(Afina::Coroutine::Engine &pe, int &woken) {
+    pe.block();
+    woken++;
+}
+
+void _unblocker_main(Afina::Coroutine::Engine &pe, int &woken) {
+    for (int i = 0; i < 10; i++) {
+        pe.run(_unblocker_sleeper, pe, woken);
+    }
+}
+
+TEST(CoroutineTest, UnblockerWakesAll) {
+    int woken = 0;
+    Afina::Coroutine::Engine engine([](Afina::Coroutine::Engine &pe) { pe.unblock_all(); });
+
+    engine.start(_unblocker_main, engine, woken);
+    ASSERT_EQ(10, woken);
+}
@@ -0,0 +1,199 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/ConditionVariable.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Mutex.h>
+
+using namespace Afina::Coroutine;
+
+// Note: objects shared between coroutines must live outside of coroutine stacks, as those get copied back and
+// forth on each switch. So everything shared is created in the test body and passed by reference
+
+void _producer(Channel<int> &ch, int from, int to) {
+    for (int i = from; i < to; i++) {
+        ch.send(i);
+    }
+}
+
+void _consumer(Channel<int> &ch, std::vector<int> &out) {
+    int v;
+    while (ch.recv(v)) {
+        out.push_back(v);
+    }
+}
+
+void _pipeline(Engine &e, Channel<int> &ch, std::vector<int> &out) {
+    e.run(_consumer, ch, out);
+    e.run(_producer, ch, 0, 100);
+    e.yield();
+
+    // Let everybody drain channel, then tell consumer there will be no more data
+    while (ch.size() > 0 || out.size() < 100) {
+        e.yield();
+    }
+    ch.close();
+}
+
+TEST(CoroutineSyncTest, ChannelBounded) {
+    Engine engine;
+    Channel<int> ch(engine, 4);
+    std::vector<int> out;
+
+    engine.start(_pipeline, engine, ch, out);
+
+    ASSERT_EQ(100, out.size());
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(i, out[i]);
+    }
+}
+
+void _bounded_writer(Channel<int> &ch, std::stringstream &log) {
+    for (int i = 0; i < 3; i++) {
+        ch.send(i);
+        log << "S" << i << " ";
+    }
+}
+
+void _bounded_reader(Channel<int> &ch, std::stringstream &log) {
+    int v;
+    for (int i = 0; i < 3; i++) {
+        ch.recv(v);
+        log << "R" << v << " ";
+    }
+}
+
+void _bounded_main(Engine &e, Channel<int> &ch, std::stringstream &log) {
+    e.run(_bounded_reader, ch, log);
+    void *w = e.run(_bounded_writer, ch, log);
+
+    // Writer fills channel and gets blocked on the second value, reader gets control then
+    e.sched(w);
+}
+
+TEST(CoroutineSyncTest, ChannelBlocksSender) {
+    Engine engine;
+    Channel<int> ch(engine, 1);
+    std::stringstream log;
+
+    engine.start(_bounded_main, engine, ch, log);
+
+    // Writer must stop after the first value until reader frees some room
+    std::string result = log.str();
+    ASSERT_EQ(0, result.find("S0 R0 "));
+    ASSERT_NE(std::string::npos, result.find("S2"));
+    ASSERT_LT(result.find("R1"), result.find("R2"));
+    ASSERT_EQ(0, ch.size());
+}
+
+TEST(CoroutineSyncTest, ChannelUnbounded) {
+    Engine engine;
+    Channel<int> ch(engine);
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(ch.try_send(i));
+    }
+    ASSERT_FALSE(ch.full());
+
+    int v;
+    ASSERT_TRUE(ch.try_recv(v));
+    ASSERT_EQ(0, v);
+
+    ch.close();
+    ASSERT_FALSE(ch.try_send(1));
+    ASSERT_EQ(999, ch.size());
+}
+
+void _closed_reader(Channel<std::string> &ch, int &got) {
+    std::string v;
+    while (ch.recv(v)) {
+        got++;
+    }
+    got = -got;
+}
+
+void _closed_main(Engine &e, Channel<std::string> &ch, int &got) {
+    e.run(_closed_reader, ch, got);
+    e.yield();
+
+    ch.send("a");
+    ch.send("b");
+    ch.close();
+}
+
+TEST(CoroutineSyncTest, ChannelCloseWakesReceiver) {
+    Engine engine;
+    Channel<std::string> ch(engine);
+    int got = 0;
+
+    engine.start(_closed_main, engine, ch, got);
+    ASSERT_EQ(-2, got);
+}
+
+void _locker(Engine &e, Mutex &m, int &counter, std::stringstream &log, char name) {
+    for (int i = 0; i < 3; i++) {
+        m.lock();
+        int v = counter;
+        log << name;
+
+        // Give up control while holding lock, nobody else should get into critical section
+        e.yield();
+        counter = v + 1;
+        m.unlock();
+        e.yield();
+    }
+}
+
+void _locker_main(Engine &e, Mutex &m, int &counter, std::stringstream &log) {
+    e.run(_locker, e, m, counter, log, 'A');
+    e.run(_locker, e, m, counter, log, 'B');
+    e.run(_locker, e, m, counter, log, 'C');
+}
+
+TEST(CoroutineSyncTest, MutexExclusion) {
+    Engine engine;
+    Mutex m(engine);
+    int counter = 0;
+    std::stringstream log;
+
+    engine.start(_locker_main, engine, m, counter, log);
+    ASSERT_EQ(9, counter);
+    ASSERT_EQ(9, log.str().size());
+    ASSERT_FALSE(m.locked());
+}
+
+void _cv_waiter(Mutex &m, ConditionVariable &cv, int &ready, int &woken) {
+    m.lock();
+    cv.wait(m, [&ready]() { return ready > 0; });
+    woken++;
+    m.unlock();
+}
+
+void _cv_main(Engine &e, Mutex &m, ConditionVariable &cv, int &ready, int &woken) {
+    for (int i = 0; i < 5; i++) {
+        e.run(_cv_waiter, m, cv, ready, woken);
+    }
+
+    // Everybody gets blocked on condition
+    e.yield();
+    e.yield();
+
+    m.lock();
+    ready = 1;
+    cv.notify_all();
+    m.unlock();
+}
+
+TEST(CoroutineSyncTest, ConditionVariableNotifyAll) {
+    Engine engine;
+    Mutex m(engine);
+    ConditionVariable cv(engine);
+    int ready = 0, woken = 0;
+
+    engine.start(_cv_main, engine, m, cv, ready, woken);
+    ASSERT_EQ(5, woken);
+}
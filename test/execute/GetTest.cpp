@@ -0,0 +1,37 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/execute/Get.h>
+
+using namespace Afina;
+using ::testing::_;
+using ::testing::Invoke;
+
+class MockStorage : public Storage {
+public:
+    MOCK_METHOD2(Put, bool(const std::string &key, const std::string &value));
+    MOCK_METHOD2(PutIfAbsent, bool(const std::string &key, const std::string &value));
+    MOCK_METHOD2(Set, bool(const std::string &key, const std::string &value));
+    MOCK_METHOD1(Delete, bool(const std::string &key));
+    MOCK_METHOD2(Get, bool(const std::string &key, std::string &value));
+    MOCK_METHOD2(MultiGet, void(const std::vector<std::string> &keys, const found_func &found));
+};
+
+TEST(GetTest, WholeBatchInOneCall) {
+    MockStorage storage;
+    EXPECT_CALL(storage, Get(_, _)).Times(0);
+    EXPECT_CALL(storage, MultiGet(std::vector<std::string>{"KEY1", "KEY2", "KEY3"}, _))
+        .WillOnce(Invoke([](const std::vector<std::string> &keys, const Storage::found_func &found) {
+            found(0, "val1");
+            found(2, "value3");
+        }));
+
+    std::string out;
+    Execute::Get cmd({"KEY1", "KEY2", "KEY3"});
+    cmd.Execute(storage, "", out);
+    EXPECT_EQ("VALUE KEY1 0 4\r\nval1\r\nVALUE KEY3 0 6\r\nvalue3\r\nEND", out);
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include <afina/metrics/Histogram.h>
+
+using namespace Afina::Metrics;
+
+TEST(HistogramTest, Empty) {
+    Histogram h;
+    ASSERT_EQ(0, h.Count());
+    ASSERT_EQ(0, h.Min());
+    ASSERT_EQ(0, h.Max());
+    ASSERT_EQ(0, h.Percentile(50));
+}
+
+TEST(HistogramTest, SmallValuesAreExact) {
+    Histogram h;
+    for (uint64_t v = 1; v <= 100; v++) {
+        h.Record(v);
+    }
+
+    ASSERT_EQ(100, h.Count());
+    ASSERT_EQ(1, h.Min());
+    ASSERT_EQ(100, h.Max());
+    ASSERT_DOUBLE_EQ(50.5, h.Mean());
+    ASSERT_EQ(1, h.Percentile(0));
+    ASSERT_EQ(50, h.Percentile(50));
+    ASSERT_EQ(99, h.Percentile(99));
+    ASSERT_EQ(100, h.Percentile(100));
+}
+
+TEST(HistogramTest, RelativeError) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> values;
+    Histogram h;
+    for (int i = 0; i < 100000; i++) {
+        // Spread values over many orders of magnitude
+        uint64_t v = rng() >> (rng() % 64);
+        values.push_back(v);
+        h.Record(v);
+    }
+    std::sort(values.begin(), values.end());
+
+    for (double p : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9}) {
+        uint64_t exact = values[std::size_t(p / 100 * values.size() + 0.5) - 1];
+        uint64_t reported = h.Percentile(p);
+        ASSERT_GE(reported, exact) << p;
+        ASSERT_LE(double(reported - exact), exact / 64.0 + 1) << p;
+    }
+    ASSERT_EQ(values.back(), h.Percentile(100));
+}
+
+TEST(HistogramTest, FullRange) {
+    Histogram h;
+    h.Record(0);
+    h.Record(std::numeric_limits<uint64_t>::max());
+
+    ASSERT_EQ(0, h.Percentile(50));
+    ASSERT_EQ(std::numeric_limits<uint64_t>::max(), h.Percentile(100));
+}
+
+TEST(HistogramTest, Merge) {
+    Histogram a, b;
+    a.Record(10, 3);
+    b.Record(1000);
+    b.Record(5);
+
+    a.Merge(b);
+    ASSERT_EQ(5, a.Count());
+    ASSERT_EQ(5, a.Min());
+    ASSERT_EQ(1000, a.Max());
+    ASSERT_EQ(10, a.Percentile(80));
+    ASSERT_EQ(1000, a.Percentile(100));
+
+    a.Clear();
+    ASSERT_EQ(0, a.Count());
+    ASSERT_EQ(0, a.Percentile(100));
+}
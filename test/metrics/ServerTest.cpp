@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <afina/metrics/Server.h>
+
+using namespace Afina::Metrics;
+
+namespace {
+
+std::string Stat(bool latency, const std::string &name) {
+    std::vector<std::pair<std::string, std::string>> stats;
+    if (latency) {
+        LatencyStats(stats);
+    } else {
+        ServerStats(stats);
+    }
+
+    for (auto &stat : stats) {
+        if (stat.first == name) {
+            return stat.second;
+        }
+    }
+    return std::string();
+}
+
+uint64_t Counter(const std::string &name) { return std::stoull(Stat(false, name)); }
+
+} // namespace
+
+TEST(ServerMetricsTest, CountersOfAllThreads) {
+    uint64_t hits = Counter("get_hits"), misses = Counter("get_misses");
+    uint64_t in = Counter("bytes_read"), out = Counter("bytes_written");
+    uint64_t total = Counter("total_connections"), current = Counter("curr_connections");
+
+    // One thread keeps connection open, others are gone by the time stats are read
+    ConnectionOpened();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([]() {
+            ConnectionOpened();
+            RecordHits(3, 1);
+            RecordTraffic(100, 10);
+            ConnectionClosed();
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(hits + 12, Counter("get_hits"));
+    EXPECT_EQ(misses + 4, Counter("get_misses"));
+    EXPECT_EQ(in + 400, Counter("bytes_read"));
+    EXPECT_EQ(out + 40, Counter("bytes_written"));
+    EXPECT_EQ(total + 5, Counter("total_connections"));
+    EXPECT_EQ(current + 1, Counter("curr_connections"));
+    ConnectionClosed();
+    EXPECT_EQ(current, Counter("curr_connections"));
+}
+
+TEST(ServerMetricsTest, LatencyPerCommand) {
+    uint64_t gets = Counter("cmd_get"), others = Counter("cmd_other");
+
+    std::thread worker([]() {
+        for (uint64_t i = 1; i <= 100; i++) {
+            RecordCommand("get", i * 1000);
+        }
+        RecordCommand("no_such_command", 5000);
+    });
+    worker.join();
+    RecordCommand("get", 1000000);
+
+    EXPECT_EQ(gets + 101, Counter("cmd_get"));
+    EXPECT_EQ(others + 1, Counter("cmd_other"));
+
+    // Latency is reported in microseconds
+    EXPECT_EQ(std::to_string(gets + 101), Stat(true, "get:count"));
+    EXPECT_EQ("1000.0", Stat(true, "get:max_us"));
+    if (gets == 0) {
+        // Percentiles are bucket bounds, precise within 2%
+        EXPECT_NEAR(51, std::stod(Stat(true, "get:p50_us")), 1);
+        EXPECT_NEAR(100, std::stod(Stat(true, "get:p99_us")), 2);
+    }
+
+    // Commands never executed are not reported
+    EXPECT_EQ("", Stat(true, "snapshot:count"));
+}
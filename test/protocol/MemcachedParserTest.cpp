@@ -4,8 +4,11 @@
 #include <string>
 
 #include <afina/execute/Add.h>
+#include <afina/execute/DeletePrefix.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Scan.h>
 #include <afina/execute/Set.h>
+#include <afina/execute/Snapshot.h>
 #include <afina/execute/Stats.h>
 
 #include <protocol/Parser.h>
@@ -97,4 +100,67 @@ TEST(MemcachedParserTest, Stats) {
 
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
+    ASSERT_EQ("", tmp->group());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("stats latency\r\n", consumed));
+    ASSERT_EQ(15, consumed);
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ("latency", reinterpret_cast<Execute::Stats *>(cmd.get())->group());
+}
+
+TEST(MemcachedParserTest, Snapshot) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("snapshot afina.snap\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(21, consumed);
+    ASSERT_EQ("snapshot", parser.Name());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+
+    Execute::Snapshot *tmp = reinterpret_cast<Execute::Snapshot *>(cmd.get());
+    ASSERT_EQ("afina.snap", tmp->name());
+
+    // No name is reported by command itself
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("snapshot\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ("", reinterpret_cast<Execute::Snapshot *>(cmd.get())->name());
+}
+
+TEST(MemcachedParserTest, PrefixCommands) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0, value_size;
+    ASSERT_TRUE(parser.Parse("scan user:1: 10\r\n", consumed));
+    ASSERT_EQ("scan", parser.Name());
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+    ASSERT_EQ("user:1:", reinterpret_cast<Execute::Scan *>(cmd.get())->prefix());
+    ASSERT_EQ(10, reinterpret_cast<Execute::Scan *>(cmd.get())->limit());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("scan\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_EQ("", reinterpret_cast<Execute::Scan *>(cmd.get())->prefix());
+    ASSERT_EQ(Execute::Scan::default_limit, reinterpret_cast<Execute::Scan *>(cmd.get())->limit());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("scan a x\r\n", consumed));
+    ASSERT_THROW(parser.Build(value_size), std::runtime_error);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("delete_prefix user:1:\r\n", consumed));
+    ASSERT_EQ("delete_prefix", parser.Name());
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ("user:1:", reinterpret_cast<Execute::DeletePrefix *>(cmd.get())->prefix());
 }
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include <protocol/ValueBuffer.h>
+
+using namespace Afina::Protocol;
+
+TEST(ValueBufferTest, AppendAcrossChunks) {
+    ValueBuffer buffer(16);
+    std::string expected;
+    for (int i = 0; i < 20; i++) {
+        std::string piece(i, 'a' + i);
+        buffer.Append(piece.data(), piece.size());
+        expected += piece;
+    }
+    ASSERT_EQ(expected.size(), buffer.Size());
+
+    std::string out;
+    buffer.CopyTo(out, buffer.Size());
+    EXPECT_EQ(expected, out);
+
+    buffer.CopyTo(out, 17);
+    EXPECT_EQ(expected.substr(0, 17), out);
+
+    buffer.CopyTo(out, 1000);
+    EXPECT_EQ(expected, out);
+}
+
+TEST(ValueBufferTest, ReserveCommit) {
+    ValueBuffer buffer(16);
+
+    // Space never crosses chunk boundary and never exceeds limit
+    std::size_t space;
+    char *tail = buffer.Reserve(100, space);
+    ASSERT_EQ(16, space);
+    memcpy(tail, "0123456789", 10);
+    buffer.Commit(10);
+
+    tail = buffer.Reserve(100, space);
+    ASSERT_EQ(6, space);
+    memcpy(tail, "abcdef", 6);
+    buffer.Commit(6);
+
+    tail = buffer.Reserve(3, space);
+    ASSERT_EQ(3, space);
+    memcpy(tail, "xyz", 3);
+    buffer.Commit(3);
+
+    std::string out;
+    buffer.CopyTo(out, buffer.Size());
+    EXPECT_EQ("0123456789abcdefxyz", out);
+}
+
+TEST(ValueBufferTest, Clear) {
+    ValueBuffer buffer(16);
+    std::string value(100, 'x');
+    buffer.Append(value.data(), value.size());
+    buffer.Clear();
+    EXPECT_EQ(0, buffer.Size());
+
+    buffer.Append("abc", 3);
+    std::string out("garbage");
+    buffer.CopyTo(out, buffer.Size());
+    EXPECT_EQ("abc", out);
+
+    buffer.Clear();
+    buffer.CopyTo(out, 0);
+    EXPECT_EQ("", out);
+}
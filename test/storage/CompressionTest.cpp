@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/CompressedStorage.h"
+#include "storage/LZCodec.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina::Backend;
+
+static std::string RoundTrip(const std::string &data) {
+    std::string packed, unpacked;
+    LZCodec::Compress(data.data(), data.size(), packed);
+    EXPECT_TRUE(LZCodec::Decompress(packed.data(), packed.size(), unpacked));
+    return unpacked;
+}
+
+TEST(CompressionTest, CodecRoundTrip) {
+    EXPECT_EQ("", RoundTrip(""));
+    EXPECT_EQ("a", RoundTrip("a"));
+    EXPECT_EQ("abcdefghijkl", RoundTrip("abcdefghijkl"));
+
+    std::string repeated;
+    for (int i = 0; i < 1000; i++) {
+        repeated += "value " + std::to_string(i % 7) + ";";
+    }
+    EXPECT_EQ(repeated, RoundTrip(repeated));
+
+    std::string same(100000, 'x');
+    EXPECT_EQ(same, RoundTrip(same));
+
+    std::string random;
+    srand(42);
+    for (int i = 0; i < 70000; i++) {
+        random.push_back(char(rand() % 256));
+    }
+    EXPECT_EQ(random, RoundTrip(random));
+
+    // Matches far apart and overlapping ones
+    std::string mixed = random.substr(0, 1000) + same.substr(0, 300) + random.substr(0, 1000) + repeated;
+    EXPECT_EQ(mixed, RoundTrip(mixed));
+}
+
+TEST(CompressionTest, CodecShrinksRepetitive) {
+    std::string data;
+    for (int i = 0; i < 100; i++) {
+        data += "{\"user\":\"somebody\",\"counter\":" + std::to_string(i) + "}";
+    }
+
+    std::string packed;
+    LZCodec::Compress(data.data(), data.size(), packed);
+    EXPECT_LT(packed.size() * 3, data.size());
+}
+
+TEST(CompressionTest, CodecRejectsCorrupted) {
+    std::string data;
+    for (int i = 0; i < 100; i++) {
+        data += "some text " + std::to_string(i % 10);
+    }
+
+    std::string packed, out;
+    LZCodec::Compress(data.data(), data.size(), packed);
+
+    // Truncated at any point
+    for (std::size_t n = 0; n < packed.size(); n++) {
+        EXPECT_FALSE(LZCodec::Decompress(packed.data(), n, out));
+    }
+
+    // Garbage must not crash or overflow anything
+    srand(7);
+    for (int i = 0; i < 1000; i++) {
+        std::string broken = packed;
+        broken[1 + rand() % (broken.size() - 1)] = char(rand() % 256);
+        LZCodec::Decompress(broken.data(), broken.size(), out);
+    }
+}
+
+TEST(CompressionTest, StorageRoundTrip) {
+    std::shared_ptr<SimpleLRU> backend = std::make_shared<SimpleLRU>(1024 * 1024);
+    CompressedStorage storage(backend, 64);
+
+    std::string small = "short";
+    std::string large(1000, 'z');
+    std::string noise;
+    for (int i = 0; i < 100; i++) {
+        noise.push_back(char(i * 37 + 11));
+    }
+
+    ASSERT_TRUE(storage.Put("small", small));
+    ASSERT_TRUE(storage.Put("large", large));
+    ASSERT_TRUE(storage.PutIfAbsent("noise", noise));
+    ASSERT_FALSE(storage.PutIfAbsent("small", large));
+
+    std::string value;
+    ASSERT_TRUE(storage.Get("small", value));
+    EXPECT_EQ(small, value);
+    ASSERT_TRUE(storage.Get("large", value));
+    EXPECT_EQ(large, value);
+    ASSERT_TRUE(storage.Get("noise", value));
+    EXPECT_EQ(noise, value);
+
+    // Backend keeps compressed form
+    ASSERT_TRUE(backend->Get("large", value));
+    EXPECT_LT(value.size(), 100);
+
+    ASSERT_TRUE(storage.Set("large", small));
+    ASSERT_TRUE(storage.Get("large", value));
+    EXPECT_EQ(small, value);
+
+    std::vector<std::string> found(3);
+    storage.MultiGet({"small", "missing", "noise"},
+                     [&found](std::size_t i, const std::string &v) { found[i] = v; });
+    EXPECT_EQ(small, found[0]);
+    EXPECT_EQ("", found[1]);
+    EXPECT_EQ(noise, found[2]);
+
+    ASSERT_TRUE(storage.Delete("small"));
+    EXPECT_FALSE(storage.Get("small", value));
+}
+
+TEST(CompressionTest, StatsReportRatio) {
+    std::shared_ptr<SimpleLRU> backend = std::make_shared<SimpleLRU>(1024 * 1024);
+    CompressedStorage storage(backend, 64);
+    ASSERT_TRUE(storage.Put("key", std::string(4000, 'a')));
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.Stats(stats);
+
+    std::string ratio, items;
+    for (auto &s : stats) {
+        if (s.first == "compress_ratio") {
+            ratio = s.second;
+        } else if (s.first == "compress_items") {
+            items = s.second;
+        }
+    }
+    EXPECT_EQ("1", items);
+    EXPECT_GT(std::stod(ratio), 10.0);
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/Entry.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina::Backend;
+
+TEST(EntryTest, ContiguousLayout) {
+    std::unique_ptr<Entry, Entry::Deleter> e(Entry::Create("key", "value"));
+    ASSERT_TRUE(e != nullptr);
+
+    // Key follows the header and value follows the key
+    EXPECT_EQ(reinterpret_cast<const char *>(e.get()) + sizeof(Entry), e->key());
+    EXPECT_EQ(e->key() + 3, e->value());
+    EXPECT_EQ("key", std::string(e->key(), e->key_len));
+    EXPECT_EQ("value", std::string(e->value(), e->value_len));
+    EXPECT_EQ(8, e->size());
+}
+
+TEST(EntryTest, Limits) {
+    EXPECT_EQ(nullptr, Entry::Create(std::string(Entry::max_key_size + 1, 'k'), "v"));
+
+    std::unique_ptr<Entry, Entry::Deleter> e(Entry::Create(std::string(Entry::max_key_size, 'k'), ""));
+    ASSERT_TRUE(e != nullptr);
+    EXPECT_EQ(Entry::max_key_size, e->key_len);
+
+    SimpleLRU storage(1024);
+    EXPECT_FALSE(storage.Put(std::string(Entry::max_key_size + 1, 'k'), "v"));
+}
+
+TEST(EntryTest, KeyOrderMatchesString) {
+    std::string keys[] = {"", "a", "ab", "b", "ba", std::string("a\0b", 3), "\xff"};
+    for (auto &a : keys) {
+        for (auto &b : keys) {
+            EXPECT_EQ(a < b, KeyRef(a) < KeyRef(b)) << a << " " << b;
+        }
+    }
+}
+
+TEST(EntryTest, HashOfEntryAndString) {
+    std::unique_ptr<Entry, Entry::Deleter> e(Entry::Create("some longer key", "value"));
+    EXPECT_EQ(HashBytes("some longer key"), HashBytes(e->key(), e->key_len));
+    EXPECT_NE(HashBytes("some longer key"), HashBytes("some longer kez"));
+}
+
+TEST(EntryTest, TableFindsAcrossGrowth) {
+    EntryTable table;
+    std::vector<Entry *> entries;
+    for (int i = 0; i < 1000; i++) {
+        std::string key = "key" + std::to_string(i);
+        Entry *e = Entry::Create(key, "value");
+        table.insert(HashBytes(key), *e);
+        entries.push_back(e);
+    }
+    EXPECT_EQ(1000, table.size());
+
+    for (int i = 0; i < 1000; i++) {
+        std::string key = "key" + std::to_string(i);
+        EXPECT_EQ(entries[i], table.find(HashBytes(key), key));
+    }
+    EXPECT_EQ(nullptr, table.find(HashBytes("key1000"), "key1000"));
+
+    std::size_t visited = 0;
+    table.for_each([&visited](const Entry &) { visited++; });
+    EXPECT_EQ(1000, visited);
+}
+
+TEST(EntryTest, TableReplaceAndRemove) {
+    EntryTable table;
+    std::string key = "key";
+    std::size_t hash = HashBytes(key);
+
+    Entry *old = Entry::Create(key, "old");
+    table.insert(hash, *old);
+    Entry *e = Entry::Create(key, "new");
+    table.replace(hash, *old, *e);
+    Entry::Destroy(old);
+    EXPECT_EQ(e, table.find(hash, key));
+    EXPECT_EQ(1, table.size());
+
+    table.remove(hash, *e);
+    std::unique_ptr<Entry, Entry::Deleter> removed(e);
+    EXPECT_EQ(nullptr, table.find(hash, key));
+    EXPECT_EQ(0, table.size());
+}
@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "storage/EvictionPolicy.h"
+#include "storage/SimpleLRU.h"
+#include "storage/policy/CountMinSketch.h"
+
+using namespace Afina::Backend;
+
+namespace {
+
+// All keys are 6 bytes and all values are 4 bytes, so that cache of 1000 bytes holds exactly 100 entries
+std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "k%05d", i);
+    return buf;
+}
+
+// Cache-aside access: value is loaded into cache on miss. Returns true on hit
+bool Access(SimpleLRU &storage, const std::string &key) {
+    std::string value;
+    if (storage.Get(key, value)) {
+        return true;
+    }
+    storage.Put(key, "vvvv");
+    return false;
+}
+
+// Warms cache up with a hot set mixed with cold traffic, runs one long scan and returns
+// number of hot keys survived it
+int HotAfterScan(const std::string &policy) {
+    const std::size_t max_size = 1000;
+    SimpleLRU storage(max_size, MakeEvictionPolicy(policy, max_size));
+
+    const int hot = 20;
+    int cold = 1000;
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < hot; i++) {
+            Access(storage, Key(i));
+        }
+        for (int i = 0; i < 30; i++) {
+            Access(storage, Key(cold++));
+        }
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        Access(storage, Key(cold++));
+    }
+
+    int survived = 0;
+    std::string value;
+    for (int i = 0; i < hot; i++) {
+        survived += storage.Get(Key(i), value) ? 1 : 0;
+    }
+    return survived;
+}
+
+} // namespace
+
+class EvictionPolicyTest : public ::testing::TestWithParam<std::string> {};
+
+TEST_P(EvictionPolicyTest, PutGetDelete) {
+    SimpleLRU storage(1000, MakeEvictionPolicy(GetParam(), 1000));
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY1", "longer value"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("longer value", value);
+
+    EXPECT_TRUE(storage.Delete("KEY2"));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_FALSE(storage.Put("KEY3", std::string(1000, 'x')));
+}
+
+TEST_P(EvictionPolicyTest, SizeLimit) {
+    SimpleLRU storage(1000, MakeEvictionPolicy(GetParam(), 1000));
+
+    // Random-ish mix of inserts, updates and reads of different size
+    for (int i = 0; i < 5000; i++) {
+        std::string value;
+        if (i % 3 == 0) {
+            storage.Get(Key(i % 150), value);
+        } else {
+            storage.Put(Key(i % 150), std::string(i % 37, 'v'));
+        }
+    }
+
+    std::size_t total = 0;
+    int found = 0;
+    for (int i = 0; i < 150; i++) {
+        std::string value;
+        if (storage.Get(Key(i), value)) {
+            total += Key(i).size() + value.size();
+            found++;
+        }
+    }
+    EXPECT_LE(total, 1000);
+    EXPECT_GT(found, 10);
+
+    // The freshest entry is always there
+    std::string value;
+    EXPECT_TRUE(storage.Put(Key(9999), "vvvv"));
+    EXPECT_TRUE(storage.Get(Key(9999), value));
+}
+
+INSTANTIATE_TEST_CASE_P(Policies, EvictionPolicyTest, ::testing::Values("lru", "slru", "2q", "tinylfu"));
+
+TEST(EvictionPolicyTest, LRUFlushedByScan) { EXPECT_EQ(0, HotAfterScan("lru")); }
+
+TEST(EvictionPolicyTest, SLRUScanResistant) { EXPECT_EQ(20, HotAfterScan("slru")); }
+
+TEST(EvictionPolicyTest, TwoQueueScanResistant) { EXPECT_EQ(20, HotAfterScan("2q")); }
+
+TEST(EvictionPolicyTest, TinyLFUScanResistant) { EXPECT_EQ(20, HotAfterScan("tinylfu")); }
+
+TEST(EvictionPolicyTest, UnknownPolicy) { EXPECT_THROW(MakeEvictionPolicy("mru", 1000), std::runtime_error); }
+
+TEST(EvictionPolicyTest, CountMinSketch) {
+    CountMinSketch sketch(64);
+
+    for (int i = 0; i < 10; i++) {
+        sketch.Increment(42);
+    }
+    sketch.Increment(7);
+
+    EXPECT_GE(sketch.Estimate(42), 10);
+    EXPECT_GE(sketch.Estimate(7), 1);
+    EXPECT_LT(sketch.Estimate(7), sketch.Estimate(42));
+
+    // Enough additions to trigger aging, popularity of the old key must fade
+    for (int i = 0; i < 1000; i++) {
+        sketch.Increment(1000 + i);
+    }
+    EXPECT_LT(sketch.Estimate(42), 10);
+}
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/HotKeyStorage.h"
+#include "storage/SpaceSaving.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+
+TEST(HotKeyStorageTest, SpaceSavingFindsHeavyHitters) {
+    SpaceSaving tracker(8);
+
+    // Two keys take 30% and 20% of the stream, the rest is spread over 1000 keys
+    for (int i = 0; i < 10000; i++) {
+        if (i % 10 < 3) {
+            tracker.Add("hot");
+        } else if (i % 10 < 5) {
+            tracker.Add("warm");
+        } else {
+            tracker.Add("cold " + std::to_string(i % 1000));
+        }
+    }
+
+    std::vector<SpaceSaving::Counter> top = tracker.Top(2);
+    ASSERT_EQ(2, top.size());
+    EXPECT_EQ("hot", top[0].key);
+    EXPECT_EQ("warm", top[1].key);
+    EXPECT_GE(top[0].count, 3000);
+    EXPECT_LE(top[0].count - top[0].error, 3000);
+}
+
+TEST(HotKeyStorageTest, StatsReportTopKeys) {
+    HotKeyStorage storage(std::make_shared<ThreadSafeSimplLRU>(1024 * 1024), 2, false, 1);
+    EXPECT_TRUE(storage.Put("hot", "value"));
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        storage.Get("hot", value);
+        storage.Get("other " + std::to_string(i), value);
+    }
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.Stats(stats);
+
+    // Backend stats go first, then hot keys from the hottest one
+    auto top = std::find_if(stats.begin(), stats.end(), [](const std::pair<std::string, std::string> &stat) {
+        return stat.first.compare(0, 4, "hot:") == 0;
+    });
+    ASSERT_NE(stats.end(), top);
+    EXPECT_EQ("hot:hot", top->first);
+    EXPECT_EQ("1000", top->second);
+}
+
+TEST(HotKeyStorageTest, CopiesInvalidatedOnWrite) {
+    HotKeyStorage storage(std::make_shared<ThreadSafeSimplLRU>(1024 * 1024), 4, true, 1);
+    EXPECT_TRUE(storage.Put("hot", "v1"));
+
+    // Make key hot, further reads are served by the thread copy
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(storage.Get("hot", value));
+    }
+    EXPECT_EQ("v1", value);
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.Stats(stats);
+    ASSERT_EQ("hot_copy_hits", stats.back().first);
+    EXPECT_NE("0", stats.back().second);
+
+    // Write from another thread must be visible here right away
+    std::thread writer([&storage]() { EXPECT_TRUE(storage.Set("hot", "v2")); });
+    writer.join();
+    EXPECT_TRUE(storage.Get("hot", value));
+    EXPECT_EQ("v2", value);
+
+    EXPECT_TRUE(storage.Delete("hot"));
+    EXPECT_FALSE(storage.Get("hot", value));
+}
+
+TEST(HotKeyStorageTest, CopiesInvalidatedOnEviction) {
+    HotKeyStorage storage(std::make_shared<ThreadSafeSimplLRU>(64), 4, true, 1);
+    EXPECT_TRUE(storage.Put("hot", "v1"));
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(storage.Get("hot", value));
+    }
+
+    // Fill backend until hot key is evicted, copy must go along with it
+    for (int i = 0; i < 16; i++) {
+        EXPECT_TRUE(storage.Put("cold " + std::to_string(i), "value"));
+    }
+    EXPECT_FALSE(storage.Get("hot", value));
+
+    // Added back with another value
+    EXPECT_TRUE(storage.PutIfAbsent("hot", "v2"));
+    EXPECT_TRUE(storage.Get("hot", value));
+    EXPECT_EQ("v2", value);
+}
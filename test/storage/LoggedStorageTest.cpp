@@ -0,0 +1,224 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "storage/LoggedStorage.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+
+class LoggedStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override { path = "/tmp/afina_wal_" + std::to_string(getpid()); }
+    void TearDown() override { unlink(path.c_str()); }
+
+    std::shared_ptr<ThreadSafeSimplLRU> Backend() { return std::make_shared<ThreadSafeSimplLRU>(16 * 1024 * 1024); }
+
+    off_t FileSize() {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+    }
+
+    static std::string Stat(Afina::Storage &storage, const std::string &name) {
+        std::vector<std::pair<std::string, std::string>> stats;
+        storage.Stats(stats);
+        for (auto &s : stats) {
+            if (s.first == name) {
+                return s.second;
+            }
+        }
+        return "";
+    }
+
+    std::string path;
+};
+
+TEST_F(LoggedStorageTest, Replay) {
+    {
+        LoggedStorage storage(Backend(), path);
+        ASSERT_TRUE(storage.Put("a", "1"));
+        ASSERT_TRUE(storage.Put("b", "2"));
+        ASSERT_TRUE(storage.PutIfAbsent("c", "3"));
+        ASSERT_FALSE(storage.PutIfAbsent("c", "4"));
+        ASSERT_TRUE(storage.Set("a", "5"));
+        ASSERT_FALSE(storage.Set("d", "6"));
+        ASSERT_TRUE(storage.Delete("b"));
+        ASSERT_FALSE(storage.Delete("b"));
+    }
+
+    std::shared_ptr<ThreadSafeSimplLRU> backend = Backend();
+    LoggedStorage storage(backend, path);
+    EXPECT_EQ(5, storage.Replayed());
+
+    std::string value;
+    ASSERT_TRUE(backend->Get("a", value));
+    EXPECT_EQ("5", value);
+    EXPECT_FALSE(backend->Get("b", value));
+    ASSERT_TRUE(backend->Get("c", value));
+    EXPECT_EQ("3", value);
+    EXPECT_FALSE(backend->Get("d", value));
+}
+
+TEST_F(LoggedStorageTest, DeletePrefixReplay) {
+    {
+        LoggedStorage storage(Backend(), path);
+        ASSERT_TRUE(storage.Put("user:1:a", "1"));
+        ASSERT_TRUE(storage.Put("user:1:b", "2"));
+        ASSERT_TRUE(storage.Put("user:2:a", "3"));
+
+        std::size_t deleted;
+        ASSERT_TRUE(storage.DeletePrefix("user:1:", deleted));
+        EXPECT_EQ(2, deleted);
+        ASSERT_TRUE(storage.Put("user:1:c", "4"));
+    }
+
+    std::shared_ptr<ThreadSafeSimplLRU> backend = Backend();
+    LoggedStorage storage(backend, path);
+    EXPECT_EQ(5, storage.Replayed());
+
+    std::string value;
+    EXPECT_FALSE(backend->Get("user:1:a", value));
+    EXPECT_FALSE(backend->Get("user:1:b", value));
+    EXPECT_TRUE(backend->Get("user:1:c", value));
+    EXPECT_TRUE(backend->Get("user:2:a", value));
+}
+
+TEST_F(LoggedStorageTest, TornTailIsDropped) {
+    {
+        LoggedStorage storage(Backend(), path);
+        ASSERT_TRUE(storage.Put("a", "1"));
+        ASSERT_TRUE(storage.Put("b", "2"));
+    }
+
+    // Crash in the middle of the last write
+    off_t size = FileSize();
+    ASSERT_EQ(0, truncate(path.c_str(), size - 2));
+
+    {
+        LoggedStorage storage(Backend(), path);
+        EXPECT_EQ(1, storage.Replayed());
+        ASSERT_TRUE(storage.Put("c", "3"));
+    }
+
+    // Broken record is cut off, so records after it are read fine
+    LoggedStorage storage(Backend(), path);
+    EXPECT_EQ(2, storage.Replayed());
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("a", value));
+    EXPECT_FALSE(storage.Get("b", value));
+    EXPECT_TRUE(storage.Get("c", value));
+}
+
+TEST_F(LoggedStorageTest, GroupCommit) {
+    const int threads = 8;
+    const int writes = 500;
+    {
+        LoggedStorage storage(Backend(), path);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&storage, t]() {
+                for (int i = 0; i < writes; i++) {
+                    ASSERT_TRUE(storage.Put("key" + std::to_string(t) + "_" + std::to_string(i), std::to_string(i)));
+                }
+            });
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+
+        // Concurrent writers share syncs
+        EXPECT_EQ(std::to_string(threads * writes), Stat(storage, "wal_records"));
+        EXPECT_LT(std::stoull(Stat(storage, "wal_batches")), threads * writes);
+    }
+
+    LoggedStorage storage(Backend(), path);
+    EXPECT_EQ(threads * writes, storage.Replayed());
+}
+
+TEST_F(LoggedStorageTest, Rewrite) {
+    {
+        LoggedStorage storage(Backend(), path);
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_TRUE(storage.Put("key" + std::to_string(i % 10), std::to_string(i)));
+        }
+        off_t before = FileSize();
+
+        storage.Rewrite();
+        for (int i = 0; i < 1000 && Stat(storage, "wal_rewrites") == "0"; i++) {
+            // Writes go on while child dumps the storage
+            ASSERT_TRUE(storage.Put("late" + std::to_string(i % 5), std::to_string(i)));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ("1", Stat(storage, "wal_rewrites"));
+        ASSERT_TRUE(storage.Delete("key0"));
+        ASSERT_TRUE(storage.Put("key1", "final"));
+        EXPECT_LT(FileSize(), before);
+    }
+
+    std::shared_ptr<ThreadSafeSimplLRU> backend = Backend();
+    LoggedStorage storage(backend, path);
+
+    std::string value;
+    EXPECT_FALSE(backend->Get("key0", value));
+    ASSERT_TRUE(backend->Get("key1", value));
+    EXPECT_EQ("final", value);
+    ASSERT_TRUE(backend->Get("key9", value));
+    EXPECT_EQ("999", value);
+    EXPECT_TRUE(backend->Get("late0", value));
+}
+
+TEST_F(LoggedStorageTest, WritesRefusedUntilRewrite) {
+    {
+        LoggedStorage storage(Backend(), path);
+        ASSERT_TRUE(storage.Put("a", "1"));
+
+        // Log can't grow anymore, writes past the limit fail with EFBIG instead of killing the process
+        struct rlimit saved, limit;
+        getrlimit(RLIMIT_FSIZE, &saved);
+        limit = saved;
+        limit.rlim_cur = FileSize() + 16;
+        sighandler_t handler = signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &limit);
+
+        EXPECT_FALSE(storage.Put("big", std::string(1024, 'x')));
+        EXPECT_EQ("1", Stat(storage, "wal_failed"));
+        EXPECT_FALSE(storage.Put("b", "2"));
+
+        setrlimit(RLIMIT_FSIZE, &saved);
+        signal(SIGXFSZ, handler);
+
+        // Refused write never reaches backend
+        std::string value;
+        EXPECT_FALSE(storage.Get("b", value));
+
+        storage.Rewrite();
+        for (int i = 0; i < 1000 && Stat(storage, "wal_failed") == "1"; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ("0", Stat(storage, "wal_failed"));
+        EXPECT_TRUE(storage.Put("b", "2"));
+    }
+
+    // Rewritten log has the write which failed to be logged, backend had applied it
+    std::shared_ptr<ThreadSafeSimplLRU> backend = Backend();
+    LoggedStorage storage(backend, path);
+
+    std::string value;
+    ASSERT_TRUE(backend->Get("a", value));
+    EXPECT_EQ("1", value);
+    ASSERT_TRUE(backend->Get("big", value));
+    EXPECT_EQ(1024, value.size());
+    ASSERT_TRUE(backend->Get("b", value));
+    EXPECT_EQ("2", value);
+}
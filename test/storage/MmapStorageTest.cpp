@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "storage/MmapStorage.h"
+
+using namespace Afina::Backend;
+
+static const std::size_t file_size = 4 << 20;
+static const std::size_t page_size = 64 << 10;
+
+class MmapStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char name[] = "/tmp/afina_mmap_XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path = name;
+    }
+
+    void TearDown() override { unlink(path.c_str()); }
+
+    // Fills storage in the child process that dies without any cleanup
+    void Crash(int count) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            MmapStorage storage(path, file_size, page_size);
+            for (int i = 0; i < count; i++) {
+                storage.Put("key" + std::to_string(i), "value" + std::to_string(i));
+            }
+            _exit(0);
+        }
+
+        int status;
+        ASSERT_EQ(pid, waitpid(pid, &status, 0));
+        ASSERT_TRUE(WIFEXITED(status));
+    }
+
+    std::string path;
+};
+
+TEST_F(MmapStorageTest, PutGetDelete) {
+    MmapStorage storage(path, file_size, page_size);
+    EXPECT_EQ(0, storage.Restored());
+
+    std::string value;
+    ASSERT_TRUE(storage.Put("KEY1", "val1"));
+    ASSERT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+
+    ASSERT_FALSE(storage.PutIfAbsent("KEY1", "val2"));
+    ASSERT_TRUE(storage.Set("KEY1", std::string(1000, 'x')));
+    ASSERT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(std::string(1000, 'x'), value);
+
+    ASSERT_FALSE(storage.Set("KEY2", "val2"));
+    ASSERT_TRUE(storage.PutIfAbsent("KEY2", "val2"));
+    ASSERT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+
+    // Doesn't fit any slab class
+    EXPECT_FALSE(storage.Put("KEY3", std::string(page_size, 'x')));
+}
+
+TEST_F(MmapStorageTest, SecondInstanceRefused) {
+    MmapStorage storage(path, file_size, page_size);
+    ASSERT_TRUE(storage.Put("key", "value"));
+    EXPECT_THROW(MmapStorage(path, file_size, page_size), std::runtime_error);
+
+    // Refused instance didn't touch the file
+    std::string value;
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ("value", value);
+}
+
+TEST_F(MmapStorageTest, Eviction) {
+    MmapStorage storage(path, file_size, page_size);
+
+    // Way more than file could hold, the oldest values go away
+    const int count = 100000;
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(storage.Put("key" + std::to_string(i), std::string(100, 'a' + i % 26)));
+    }
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("key0", value));
+    ASSERT_TRUE(storage.Get("key" + std::to_string(count - 1), value));
+    EXPECT_EQ(std::string(100, 'a' + (count - 1) % 26), value);
+}
+
+TEST_F(MmapStorageTest, WarmRestart) {
+    {
+        MmapStorage storage(path, file_size, page_size);
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_TRUE(storage.Put("key" + std::to_string(i), "value" + std::to_string(i)));
+        }
+        storage.Stop();
+    }
+
+    MmapStorage storage(path, file_size, page_size);
+    EXPECT_EQ(1000, storage.Restored());
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(storage.Get("key" + std::to_string(i), value));
+        EXPECT_EQ("value" + std::to_string(i), value);
+    }
+}
+
+TEST_F(MmapStorageTest, GeometryChangeResets) {
+    {
+        MmapStorage storage(path, file_size, page_size);
+        ASSERT_TRUE(storage.Put("key", "value"));
+    }
+
+    MmapStorage storage(path, file_size * 2, page_size);
+    EXPECT_EQ(0, storage.Restored());
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("key", value));
+}
+
+TEST_F(MmapStorageTest, CrashRecovery) {
+    Crash(1000);
+
+    MmapStorage storage(path, file_size, page_size);
+    EXPECT_EQ(1000, storage.Restored());
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(storage.Get("key" + std::to_string(i), value));
+        EXPECT_EQ("value" + std::to_string(i), value);
+    }
+
+    // Recovered lists are usable
+    ASSERT_TRUE(storage.Put("key0", "updated"));
+    ASSERT_TRUE(storage.Delete("key1"));
+    ASSERT_TRUE(storage.Get("key0", value));
+    EXPECT_EQ("updated", value);
+}
+
+TEST_F(MmapStorageTest, CrashRecoveryDropsCorrupted) {
+    Crash(10);
+
+    // Damage one value right in the file
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::size_t pos = contents.find("key5value5");
+    ASSERT_NE(std::string::npos, pos);
+    contents[pos + 9] = '6';
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(contents.data(), contents.size());
+    }
+
+    MmapStorage storage(path, file_size, page_size);
+    EXPECT_EQ(9, storage.Restored());
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("key5", value));
+    ASSERT_TRUE(storage.Get("key6", value));
+    EXPECT_EQ("value6", value);
+}
@@ -0,0 +1,140 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/NamespacedStorage.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+
+namespace {
+
+std::string Stat(Afina::Storage &storage, const std::string &name) {
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.Stats(stats);
+    for (auto &s : stats) {
+        if (s.first == name) {
+            return s.second;
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(NamespacedStorageTest, Routing) {
+    auto fallback = std::make_shared<ThreadSafeSimplLRU>(1024);
+    auto users = std::make_shared<ThreadSafeSimplLRU>(1024);
+    NamespacedStorage storage(fallback);
+    storage.Add("users", users);
+
+    ASSERT_TRUE(storage.Put("users:1", "alice"));
+    ASSERT_TRUE(storage.Put("user:1", "bob"));
+    ASSERT_TRUE(storage.Put("users", "carol"));
+    ASSERT_TRUE(storage.Put("other:1", "dave"));
+
+    std::string value;
+    EXPECT_TRUE(users->Get("users:1", value));
+    EXPECT_FALSE(users->Get("user:1", value));
+    EXPECT_FALSE(users->Get("users", value));
+    EXPECT_TRUE(fallback->Get("user:1", value));
+    EXPECT_TRUE(fallback->Get("users", value));
+    EXPECT_TRUE(fallback->Get("other:1", value));
+
+    ASSERT_TRUE(storage.Get("users:1", value));
+    EXPECT_EQ("alice", value);
+    EXPECT_TRUE(storage.Set("users:1", "eve"));
+    EXPECT_FALSE(storage.PutIfAbsent("users:1", "x"));
+    EXPECT_TRUE(storage.Delete("users:1"));
+    EXPECT_FALSE(storage.Get("users:1", value));
+
+    EXPECT_THROW(storage.Add("users", users), std::invalid_argument);
+    EXPECT_THROW(storage.Add("a:b", users), std::invalid_argument);
+    EXPECT_THROW(storage.Add("", users), std::invalid_argument);
+}
+
+TEST(NamespacedStorageTest, Isolation) {
+    NamespacedStorage storage(std::make_shared<ThreadSafeSimplLRU>(1024));
+    storage.Add("big", std::make_shared<ThreadSafeSimplLRU>(1024));
+    storage.Add("small", std::make_shared<ThreadSafeSimplLRU>(1024));
+
+    ASSERT_TRUE(storage.Put("small:hot", "value"));
+    ASSERT_TRUE(storage.Put("default", "value"));
+
+    // Noisy namespace churns through its own budget only
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(storage.Put("big:" + std::to_string(i), std::string(100, 'x')));
+    }
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("big:0", value));
+    EXPECT_TRUE(storage.Get("small:hot", value));
+    EXPECT_TRUE(storage.Get("default", value));
+}
+
+TEST(NamespacedStorageTest, MultiGet) {
+    NamespacedStorage storage(std::make_shared<ThreadSafeSimplLRU>(1024));
+    storage.Add("a", std::make_shared<ThreadSafeSimplLRU>(1024));
+    storage.Add("b", std::make_shared<ThreadSafeSimplLRU>(1024));
+
+    ASSERT_TRUE(storage.Put("a:1", "a1"));
+    ASSERT_TRUE(storage.Put("b:1", "b1"));
+    ASSERT_TRUE(storage.Put("c:1", "c1"));
+    ASSERT_TRUE(storage.Put("a:2", "a2"));
+
+    std::vector<std::string> keys = {"b:1", "a:1", "missing", "c:1", "a:2", "a:3"};
+    std::vector<std::pair<std::size_t, std::string>> found;
+    storage.MultiGet(keys, [&found](std::size_t i, const std::string &value) { found.emplace_back(i, value); });
+
+    std::vector<std::pair<std::size_t, std::string>> expected = {{0, "b1"}, {1, "a1"}, {3, "c1"}, {4, "a2"}};
+    EXPECT_EQ(expected, found);
+
+    EXPECT_EQ("3", Stat(storage, "ns_a_reads"));
+    EXPECT_EQ("2", Stat(storage, "ns_a_hits"));
+    EXPECT_EQ("1", Stat(storage, "ns_b_hits"));
+    EXPECT_EQ("2", Stat(storage, "ns_a_writes"));
+}
+
+TEST(NamespacedStorageTest, ForEach) {
+    NamespacedStorage storage(std::make_shared<ThreadSafeSimplLRU>(1024));
+    storage.Add("a", std::make_shared<ThreadSafeSimplLRU>(1024));
+
+    ASSERT_TRUE(storage.Put("a:1", "1"));
+    ASSERT_TRUE(storage.Put("b:1", "2"));
+
+    std::vector<std::string> seen;
+    storage.Freeze([&storage, &seen]() {
+        EXPECT_TRUE(storage.ForEach([&seen](const std::string &key, const std::string &) { seen.push_back(key); }));
+    });
+    std::sort(seen.begin(), seen.end());
+    EXPECT_EQ(std::vector<std::string>({"a:1", "b:1"}), seen);
+}
+
+TEST(NamespacedStorageTest, Prefix) {
+    NamespacedStorage storage(std::make_shared<ThreadSafeSimplLRU>(1024));
+    storage.Add("user", std::make_shared<ThreadSafeSimplLRU>(1024));
+
+    ASSERT_TRUE(storage.Put("user:1:a", "1"));
+    ASSERT_TRUE(storage.Put("user:2:a", "2"));
+    ASSERT_TRUE(storage.Put("us", "3"));
+    ASSERT_TRUE(storage.Put("usual", "4"));
+
+    // Prefix matching both default keys and the whole namespace is merged in key order
+    std::vector<std::string> seen;
+    auto collect = [&seen](const std::string &key, const std::string &) { seen.push_back(key); };
+    ASSERT_TRUE(storage.Scan("us", 3, collect));
+    EXPECT_EQ(std::vector<std::string>({"us", "user:1:a", "user:2:a"}), seen);
+
+    std::size_t deleted = 0;
+    ASSERT_TRUE(storage.DeletePrefix("user:1:", deleted));
+    EXPECT_EQ(1, deleted);
+    ASSERT_TRUE(storage.DeletePrefix("us", deleted));
+    EXPECT_EQ(3, deleted);
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("user:2:a", value));
+    EXPECT_FALSE(storage.Get("usual", value));
+}
@@ -0,0 +1,249 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <afina/Snapshot.h>
+
+#include "storage/ClockCache.h"
+#include "storage/CompressedStorage.h"
+#include "storage/EpochHashCache.h"
+#include "storage/FlatCombineLRU.h"
+#include "storage/MmapStorage.h"
+#include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+
+// Throws once given number of entries is stored, like storage running out of memory
+class ThrowingLRU : public ThreadSafeSimplLRU {
+public:
+    ThrowingLRU(int limit) : ThreadSafeSimplLRU(16 * 1024 * 1024), _left(limit) {}
+
+    bool Put(const std::string &key, const std::string &value) override {
+        if (_left-- <= 0) {
+            throw std::bad_alloc();
+        }
+        return ThreadSafeSimplLRU::Put(key, value);
+    }
+
+private:
+    std::atomic<int> _left;
+};
+
+class SnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override { path = "/tmp/afina_snapshot_" + std::to_string(getpid()); }
+    void TearDown() override { unlink(path.c_str()); }
+
+    // Waits until forked snapshot is done, returns false if it failed
+    bool WaitFork() {
+        for (int i = 0; i < 1000; i++) {
+            std::vector<std::pair<std::string, std::string>> stats;
+            SnapshotStats(stats);
+            if (stats[0].second == "0") {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    static std::string Stat(const std::string &name) {
+        std::vector<std::pair<std::string, std::string>> stats;
+        SnapshotStats(stats);
+        for (auto &s : stats) {
+            if (s.first == name) {
+                return s.second;
+            }
+        }
+        return "";
+    }
+
+    std::string path;
+};
+
+TEST_F(SnapshotTest, RoundTrip) {
+    SimpleLRU source(1024 * 1024);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(source.Put("key" + std::to_string(i), std::string(i % 100, 'a' + i % 26)));
+    }
+    ASSERT_TRUE(source.Put("", "empty key"));
+
+    ASSERT_EQ(1001, WriteSnapshot(source, path));
+
+    // Loads into storages of other types in parallel
+    ClockCache clock(1024 * 1024);
+    ASSERT_EQ(1001, LoadSnapshot(clock, path, 4));
+    EpochHashCache epoch(1024 * 1024);
+    ASSERT_EQ(1001, LoadSnapshot(epoch, path, 4));
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(clock.Get("key" + std::to_string(i), value));
+        EXPECT_EQ(std::string(i % 100, 'a' + i % 26), value);
+        ASSERT_TRUE(epoch.Get("key" + std::to_string(i), value));
+        EXPECT_EQ(std::string(i % 100, 'a' + i % 26), value);
+    }
+    ASSERT_TRUE(clock.Get("", value));
+    EXPECT_EQ("empty key", value);
+}
+
+TEST_F(SnapshotTest, DecoratorsDumpPlainValues) {
+    std::shared_ptr<SimpleLRU> backend = std::make_shared<SimpleLRU>(1024 * 1024);
+    CompressedStorage source(backend, 16);
+    ASSERT_TRUE(source.Put("key", std::string(1000, 'x')));
+    ASSERT_EQ(1, WriteSnapshot(source, path));
+
+    SimpleLRU target(1024 * 1024);
+    ASSERT_EQ(1, LoadSnapshot(target, path, 1));
+
+    std::string value;
+    ASSERT_TRUE(target.Get("key", value));
+    EXPECT_EQ(std::string(1000, 'x'), value);
+}
+
+TEST_F(SnapshotTest, SingleThreadedStorageLoadedSerially) {
+    SimpleLRU source(1024 * 1024);
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(source.Put("key" + std::to_string(i), std::to_string(i)));
+    }
+    ASSERT_EQ(10000, WriteSnapshot(source, path));
+
+    // Asking for threads must not make loaders race on storage without locks, directly or under decorator
+    SimpleLRU target(1024 * 1024);
+    EXPECT_FALSE(target.ThreadSafe());
+    ASSERT_EQ(10000, LoadSnapshot(target, path, 8));
+    std::shared_ptr<SimpleLRU> backend = std::make_shared<SimpleLRU>(1024 * 1024);
+    CompressedStorage decorated(backend, 16);
+    EXPECT_FALSE(decorated.ThreadSafe());
+    ASSERT_EQ(10000, LoadSnapshot(decorated, path));
+
+    std::string value;
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(target.Get("key" + std::to_string(i), value));
+        EXPECT_EQ(std::to_string(i), value);
+        ASSERT_TRUE(backend->Get("key" + std::to_string(i), value));
+    }
+}
+
+TEST_F(SnapshotTest, StorageFailureStopsLoad) {
+    SimpleLRU source(1024 * 1024);
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(source.Put("key" + std::to_string(i), std::to_string(i)));
+    }
+    ASSERT_EQ(10000, WriteSnapshot(source, path));
+
+    // Exception is passed from loader thread to the caller instead of terminating process
+    ThrowingLRU target(2000);
+    EXPECT_THROW(LoadSnapshot(target, path, 4), std::runtime_error);
+}
+
+TEST_F(SnapshotTest, RejectsBrokenFiles) {
+    SimpleLRU source(1024 * 1024);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(source.Put("key" + std::to_string(i), "value" + std::to_string(i)));
+    }
+    WriteSnapshot(source, path);
+
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Truncated
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size() - 3);
+    }
+    SimpleLRU target(1024 * 1024);
+    EXPECT_THROW(LoadSnapshot(target, path, 2), std::runtime_error);
+
+    // Garbage after the last entry
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size());
+        out.write("x", 1);
+    }
+    EXPECT_THROW(LoadSnapshot(target, path, 2), std::runtime_error);
+
+    // Not a snapshot at all
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "hello";
+    }
+    EXPECT_THROW(LoadSnapshot(target, path, 2), std::runtime_error);
+    EXPECT_THROW(LoadSnapshot(target, path + ".missing", 2), std::runtime_error);
+}
+
+TEST_F(SnapshotTest, UnsupportedStorage) {
+    MmapStorage storage(path + ".mmap", 4 << 20, 64 << 10);
+    EXPECT_THROW(WriteSnapshot(storage, path), std::runtime_error);
+    unlink((path + ".mmap").c_str());
+
+    // No partial file is left behind
+    EXPECT_NE(0, access(path.c_str(), F_OK));
+    EXPECT_NE(0, access((path + ".tmp").c_str(), F_OK));
+}
+
+TEST_F(SnapshotTest, ClientNamesStayInDirectory) {
+    std::string resolved, error;
+    EXPECT_FALSE(SnapshotPath("dump", resolved, error));
+
+    SetSnapshotDirectory("/var/lib/afina");
+    EXPECT_TRUE(SnapshotPath("dump.snap", resolved, error)) << error;
+    EXPECT_EQ("/var/lib/afina/dump.snap", resolved);
+    for (const char *name : {"", ".", "..", ".hidden", "../etc/passwd", "/etc/passwd", "dir/dump"}) {
+        EXPECT_FALSE(SnapshotPath(name, resolved, error)) << name;
+    }
+    SetSnapshotDirectory("");
+}
+
+TEST_F(SnapshotTest, ForkWhileWriting) {
+    FlatCombineLRU storage(16 * 1024 * 1024);
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(storage.Put("key" + std::to_string(i), "value" + std::to_string(i)));
+    }
+
+    // Writers keep going while snapshot is taken
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.emplace_back([&storage, &stop, t]() {
+            for (int i = 0; !stop.load(); i++) {
+                storage.Put("extra" + std::to_string(t) + "_" + std::to_string(i % 1000), "x");
+            }
+        });
+    }
+
+    std::string done = Stat("snapshots_done");
+    std::string error;
+    ASSERT_TRUE(ForkSnapshot(storage, path, error)) << error;
+    bool finished = WaitFork();
+    stop = true;
+    for (auto &t : writers) {
+        t.join();
+    }
+    ASSERT_TRUE(finished);
+    EXPECT_EQ(std::to_string(std::stoull(done) + 1), Stat("snapshots_done"));
+
+    ThreadSafeSimplLRU target(16 * 1024 * 1024);
+    ASSERT_LE(10000, LoadSnapshot(target, path));
+
+    std::string value;
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(target.Get("key" + std::to_string(i), value));
+        EXPECT_EQ("value" + std::to_string(i), value);
+    }
+}
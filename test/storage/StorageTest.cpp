@@ -1,7 +1,11 @@
 #include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <set>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include <afina/execute/Add.h>
@@ -10,7 +14,12 @@
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
 
+#include "storage/ClockCache.h"
+#include "storage/EpochHashCache.h"
+#include "storage/FlatCombineLRU.h"
+#include "storage/RWLockLRU.h"
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina::Backend;
 using namespace Afina::Execute;
@@ -195,3 +204,402 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+template <typename T> void concurrent_put_get() {
+    const size_t length = 20;
+    const int threads = 8, per_thread = 2000;
+    T storage(2 * threads * per_thread * length);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&storage, t]() {
+            for (int i = 0; i < per_thread; i++) {
+                auto key = pad_space("Key " + std::to_string(t) + " " + std::to_string(i), length);
+                auto val = pad_space("Val " + std::to_string(t) + " " + std::to_string(i), length);
+                EXPECT_TRUE(storage.Put(key, val));
+
+                std::string res;
+                EXPECT_TRUE(storage.Get(key, res));
+                EXPECT_TRUE(val == res);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < per_thread; i++) {
+            auto key = pad_space("Key " + std::to_string(t) + " " + std::to_string(i), length);
+            auto val = pad_space("Val " + std::to_string(t) + " " + std::to_string(i), length);
+
+            std::string res;
+            EXPECT_TRUE(storage.Get(key, res));
+            EXPECT_TRUE(val == res);
+        }
+    }
+}
+
+TEST(StorageTest, ThreadSafeConcurrent) { concurrent_put_get<ThreadSafeSimplLRU>(); }
+
+TEST(StorageTest, FlatCombineConcurrent) { concurrent_put_get<FlatCombineLRU>(); }
+
+TEST(StorageTest, RWLockConcurrent) { concurrent_put_get<RWLockLRU>(); }
+
+TEST(StorageTest, FlatCombineFailureIsolated) {
+    FlatCombineLRU storage(1024 * 1024);
+    ASSERT_TRUE(storage.Put("found", "value"));
+    std::atomic<bool> stop(false);
+
+    // Writers share batches with failing callbacks, but neither see exceptions nor lose writes
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.emplace_back([&storage, &stop, t]() {
+            for (int i = 0; !stop.load() || i < 100; i++) {
+                std::string key = "key " + std::to_string(t) + " " + std::to_string(i % 100);
+                EXPECT_NO_THROW(EXPECT_TRUE(storage.Put(key, std::to_string(i))));
+            }
+        });
+    }
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_THROW(storage.Freeze([]() { throw std::runtime_error("callback failed"); }), std::runtime_error);
+        EXPECT_THROW(storage.MultiGet({"found"}, [](std::size_t, const std::string &) { throw std::logic_error(""); }),
+                     std::logic_error);
+    }
+    stop = true;
+    for (auto &w : writers) {
+        w.join();
+    }
+
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < 100; i++) {
+            EXPECT_TRUE(storage.Get("key " + std::to_string(t) + " " + std::to_string(i), value));
+        }
+    }
+}
+
+TEST(StorageTest, RWLockBumpsReplayed) {
+    // Room for exactly three entries
+    RWLockLRU storage(3 * 8);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    // Enough reads for the buffer to be replayed, KEY1 becomes the freshest one
+    std::string value;
+    for (std::size_t i = 0; i < RWLockLRU::bump_batch; i++) {
+        EXPECT_TRUE(storage.Get("KEY1", value));
+    }
+
+    EXPECT_TRUE(storage.Put("KEY4", "val4"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+}
+
+TEST(StorageTest, RWLockMultiGetBumpsReplayed) {
+    RWLockLRU storage(3 * 8);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    // Single batch is enough to fill the buffer, misses are buffered as well
+    std::vector<std::string> keys(RWLockLRU::bump_batch, "KEY1");
+    keys[0] = "MISSING";
+    std::size_t found = 0;
+    storage.MultiGet(keys, [&found](std::size_t, const std::string &) { found++; });
+    EXPECT_EQ(RWLockLRU::bump_batch - 1, found);
+
+    std::string value;
+    EXPECT_TRUE(storage.Put("KEY4", "val4"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+}
+
+TEST(StorageTest, ClockConcurrent) { concurrent_put_get<ClockCache>(); }
+
+TEST(StorageTest, ClockSecondChance) {
+    // Room for exactly three entries
+    ClockCache storage(3 * 8);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+
+    // KEY1 was referenced, so clock skips it and evicts KEY2
+    EXPECT_TRUE(storage.Put("KEY4", "val4"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+
+    // Updated entry survives eviction it causes
+    EXPECT_TRUE(storage.Set("KEY3", "value3 longer"));
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_EQ("value3 longer", value);
+    EXPECT_FALSE(storage.Put("KEY5", std::string(100, 'x')));
+}
+
+TEST(StorageTest, EpochHashConcurrent) { concurrent_put_get<EpochHashCache>(); }
+
+TEST(StorageTest, EpochHashReadersDuringWrites) {
+    // Writers keep replacing and deleting values, readers must always see one of the complete values
+    EpochHashCache storage(64 * 1024, 4);
+    std::atomic<bool> stop(false);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+        writers.emplace_back([&storage, &stop, t]() {
+            for (int i = 0; !stop; i++) {
+                std::string key = "Key " + std::to_string(i % 50);
+                if (i % 7 == t) {
+                    storage.Delete(key);
+                } else {
+                    storage.Put(key, std::string(10 + i % 100, 'a' + i % 26));
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&storage]() {
+            for (int i = 0; i < 200000; i++) {
+                std::string res;
+                if (storage.Get("Key " + std::to_string(i % 50), res)) {
+                    ASSERT_GE(res.size(), 10);
+                    ASSERT_EQ(std::string(res.size(), res[0]), res);
+                }
+            }
+        });
+    }
+
+    for (auto &r : readers) {
+        r.join();
+    }
+    stop = true;
+    for (auto &w : writers) {
+        w.join();
+    }
+}
+
+TEST(StorageTest, EpochHashEviction) {
+    EpochHashCache storage(2 * 1000 * 20, 1);
+
+    for (long i = 0; i < 2000; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), 20), pad_space("Val " + std::to_string(i), 20)));
+    }
+
+    int found = 0;
+    for (long i = 0; i < 2000; ++i) {
+        std::string res;
+        found += storage.Get(pad_space("Key " + std::to_string(i), 20), res) ? 1 : 0;
+    }
+    EXPECT_EQ(1000, found);
+
+    std::string res;
+    EXPECT_TRUE(storage.Get(pad_space("Key 1999", 20), res));
+    EXPECT_FALSE(storage.Put("big", std::string(40000, 'x')));
+}
+
+template <typename T> void multi_get() {
+    T storage(1024 * 1024);
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    std::vector<std::string> keys{"KEY1", "KEY2", "KEY3", "KEY1"};
+    std::vector<std::pair<std::size_t, std::string>> found;
+    storage.MultiGet(keys, [&found](std::size_t i, const std::string &value) { found.emplace_back(i, value); });
+
+    ASSERT_EQ(3, found.size());
+    EXPECT_EQ(0, found[0].first);
+    EXPECT_EQ("val1", found[0].second);
+    EXPECT_EQ(2, found[1].first);
+    EXPECT_EQ("val3", found[1].second);
+    EXPECT_EQ(3, found[2].first);
+    EXPECT_EQ("val1", found[2].second);
+}
+
+TEST(StorageTest, MultiGet) {
+    multi_get<SimpleLRU>();
+    multi_get<ThreadSafeSimplLRU>();
+    multi_get<FlatCombineLRU>();
+    multi_get<RWLockLRU>();
+    multi_get<ClockCache>();
+    multi_get<EpochHashCache>();
+}
+
+TEST(StorageTest, EpochHashBatchLookup) {
+    // Batch spans many lookup groups, every third key is missing
+    EpochHashCache storage(1024 * 1024, 1);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; i++) {
+        keys.push_back("Key " + std::to_string(i));
+        if (i % 3 != 0) {
+            EXPECT_TRUE(storage.Put(keys.back(), "Val " + std::to_string(i)));
+        }
+    }
+
+    std::size_t found = 0;
+    storage.MultiGet(keys, [&found](std::size_t i, const std::string &value) {
+        EXPECT_NE(0, i % 3);
+        EXPECT_EQ("Val " + std::to_string(i), value);
+        found++;
+    });
+    EXPECT_EQ(3333, found);
+}
+
+template <typename T> void prefix_ops() {
+    T storage(1024 * 1024);
+    EXPECT_TRUE(storage.Put("user:1", "a"));
+    EXPECT_TRUE(storage.Put("user:12:x", "b"));
+    EXPECT_TRUE(storage.Put("user:1:y", "c"));
+    EXPECT_TRUE(storage.Put("user:1:z", "d"));
+    EXPECT_TRUE(storage.Put("user:2:y", "e"));
+    EXPECT_TRUE(storage.Put("user:", "f"));
+
+    std::vector<std::pair<std::string, std::string>> seen;
+    auto collect = [&seen](const std::string &key, const std::string &value) { seen.emplace_back(key, value); };
+    ASSERT_TRUE(storage.Scan("user:1:", 100, collect));
+    std::vector<std::pair<std::string, std::string>> expected{{"user:1:y", "c"}, {"user:1:z", "d"}};
+    EXPECT_EQ(expected, seen);
+
+    seen.clear();
+    ASSERT_TRUE(storage.Scan("user:", 3, collect));
+    expected = {{"user:", "f"}, {"user:1", "a"}, {"user:12:x", "b"}};
+    EXPECT_EQ(expected, seen);
+
+    std::size_t deleted = 0;
+    ASSERT_TRUE(storage.DeletePrefix("user:1:", deleted));
+    EXPECT_EQ(2, deleted);
+    ASSERT_TRUE(storage.DeletePrefix("nothing", deleted));
+    EXPECT_EQ(0, deleted);
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("user:1:y", value));
+    EXPECT_FALSE(storage.Get("user:1:z", value));
+    EXPECT_TRUE(storage.Get("user:1", value));
+    EXPECT_TRUE(storage.Get("user:12:x", value));
+
+    // Space of removed entries is reused
+    for (int i = 0; i < 10000; i++) {
+        EXPECT_TRUE(storage.Put("bulk:" + std::to_string(i), std::string(50, 'x')));
+    }
+    ASSERT_TRUE(storage.DeletePrefix("bulk:", deleted));
+    EXPECT_LT(0, deleted);
+    EXPECT_TRUE(storage.Put("big", std::string(900 * 1024, 'x')));
+}
+
+TEST(StorageTest, PrefixOps) {
+    prefix_ops<SimpleLRU>();
+    prefix_ops<ThreadSafeSimplLRU>();
+    prefix_ops<FlatCombineLRU>();
+    prefix_ops<RWLockLRU>();
+
+    // Hash based storages have no key order
+    std::size_t deleted;
+    ClockCache clock(1024);
+    EXPECT_FALSE(clock.DeletePrefix("a", deleted));
+}
+
+template <typename T> void stats_report_memory() {
+    T storage(100);
+    auto stat = [&storage](const std::string &name) {
+        std::vector<std::pair<std::string, std::string>> stats;
+        storage.Stats(stats);
+        for (auto &s : stats) {
+            if (s.first == name) {
+                return s.second;
+            }
+        }
+        return std::string();
+    };
+
+    EXPECT_EQ("100", stat("limit_maxbytes"));
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(storage.Put("key" + std::to_string(i), std::string(16, 'x')));
+    }
+
+    // Each entry takes 20 bytes, so 5 of them fit
+    EXPECT_EQ("5", stat("curr_items"));
+    EXPECT_EQ("100", stat("bytes"));
+    EXPECT_EQ("5", stat("evictions"));
+
+    // Explicit delete is not an eviction
+    ASSERT_TRUE(storage.Delete("key9"));
+    EXPECT_EQ("4", stat("curr_items"));
+    EXPECT_EQ("80", stat("bytes"));
+    EXPECT_EQ("5", stat("evictions"));
+
+    // Neither is replacing value of an existing key
+    ASSERT_TRUE(storage.Put("key8", std::string(6, 'y')));
+    EXPECT_EQ("4", stat("curr_items"));
+    EXPECT_EQ("70", stat("bytes"));
+    EXPECT_EQ("5", stat("evictions"));
+}
+
+TEST(StorageTest, StatsReportMemory) {
+    stats_report_memory<SimpleLRU>();
+    stats_report_memory<ClockCache>();
+    stats_report_memory<EpochHashCache>();
+}
+
+TEST(StorageTest, EvictAhead) {
+    ThreadSafeSimplLRU storage(100 * 1024);
+    EXPECT_THROW(storage.EvictAhead(90, 80), std::invalid_argument);
+    storage.EvictAhead(50, 75);
+    storage.Start();
+
+    auto stat = [&storage](const std::string &name) {
+        std::vector<std::pair<std::string, std::string>> stats;
+        storage.Stats(stats);
+        for (auto &s : stats) {
+            if (s.first == name) {
+                return std::stoul(s.second);
+            }
+        }
+        return 0ul;
+    };
+
+    // Cross high watermark: about 30 oldest entries are evicted down to low watermark, depending on how far
+    // writes got before thread woke up
+    for (int i = 0; i < 80; i++) {
+        ASSERT_TRUE(storage.Put("key" + std::to_string(i), std::string(1014, 'x')));
+    }
+    for (int i = 0; i < 1000 && stat("evicted_ahead") < 26; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_LE(26, stat("evicted_ahead"));
+    EXPECT_EQ(0, stat("evicted_inline"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("key0", value));
+    EXPECT_TRUE(storage.Get("key79", value));
+
+    // Writes running ahead of the thread still fit, falling back to inline eviction if needed
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.emplace_back([&storage, t]() {
+            for (int i = 0; i < 2000; i++) {
+                EXPECT_TRUE(storage.Put("w" + std::to_string(t) + ":" + std::to_string(i), std::string(1000, 'y')));
+            }
+        });
+    }
+    for (auto &w : writers) {
+        w.join();
+    }
+    storage.Stop();
+
+    // Whoever finished last has the newest entry
+    int found = 0;
+    for (int t = 0; t < 4; t++) {
+        found += storage.Get("w" + std::to_string(t) + ":1999", value) ? 1 : 0;
+    }
+    EXPECT_LT(0, found);
+}
@@ -0,0 +1,248 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/TieredStorage.h"
+
+using namespace Afina::Backend;
+
+class TieredStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override { path = "/tmp/afina_tier_" + std::to_string(getpid()); }
+    void TearDown() override { unlink(path.c_str()); }
+
+    static std::string Stat(Afina::Storage &storage, const std::string &name) {
+        std::vector<std::pair<std::string, std::string>> stats;
+        storage.Stats(stats);
+        for (auto &s : stats) {
+            if (s.first == name) {
+                return s.second;
+            }
+        }
+        return "";
+    }
+
+    static std::string Key(int i) { return "key" + std::to_string(i); }
+    static std::string Value(int i) { return std::string(100, 'a' + i % 26) + std::to_string(i); }
+
+    std::string path;
+};
+
+TEST_F(TieredStorageTest, RequiresThreadSafeMemory) {
+    // Promoter would write into it concurrently with readers
+    auto memory = std::make_shared<SimpleLRU>(4096);
+    EXPECT_THROW(TieredStorage(memory, path, 1 << 20, 64 << 10), std::invalid_argument);
+}
+
+TEST_F(TieredStorageTest, EvictedStayReadable) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 1 << 20, 64 << 10);
+
+    const int count = 500;
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+    storage.Drain();
+    EXPECT_NE("0", Stat(storage, "tier_spills"));
+
+    // Early keys are gone from memory, yet still served
+    std::string value;
+    EXPECT_FALSE(memory->Get(Key(0), value));
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(storage.Get(Key(i), value)) << i;
+        EXPECT_EQ(Value(i), value);
+    }
+    EXPECT_FALSE(storage.Get("missing", value));
+}
+
+TEST_F(TieredStorageTest, Promotion) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 1 << 20, 64 << 10);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+
+    std::string value;
+    ASSERT_FALSE(memory->Get(Key(0), value));
+    ASSERT_TRUE(storage.Get(Key(0), value));
+    storage.Drain();
+
+    EXPECT_EQ("1", Stat(storage, "tier_promotions"));
+    ASSERT_TRUE(memory->Get(Key(0), value));
+    EXPECT_EQ(Value(0), value);
+}
+
+TEST_F(TieredStorageTest, WritesDropDiskCopy) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 1 << 20, 64 << 10);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+
+    std::string value;
+    ASSERT_FALSE(memory->Get(Key(0), value));
+    ASSERT_FALSE(memory->Get(Key(1), value));
+    ASSERT_FALSE(memory->Get(Key(2), value));
+    ASSERT_FALSE(memory->Get(Key(3), value));
+
+    EXPECT_FALSE(storage.PutIfAbsent(Key(0), "x"));
+    EXPECT_TRUE(storage.Set(Key(1), "new"));
+    EXPECT_TRUE(storage.Delete(Key(2)));
+    EXPECT_FALSE(storage.Delete(Key(2)));
+    EXPECT_TRUE(storage.Put(Key(3), "put"));
+
+    EXPECT_TRUE(storage.Get(Key(1), value));
+    EXPECT_EQ("new", value);
+    EXPECT_FALSE(storage.Get(Key(2), value));
+    EXPECT_TRUE(storage.Get(Key(3), value));
+    EXPECT_EQ("put", value);
+    EXPECT_FALSE(storage.Set("missing", "x"));
+}
+
+TEST_F(TieredStorageTest, MultiGet) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 1 << 20, 64 << 10);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+
+    std::vector<std::string> keys = {Key(99), Key(0), "missing", Key(50)};
+    std::vector<std::pair<std::size_t, std::string>> found;
+    storage.MultiGet(keys, [&found](std::size_t i, const std::string &value) { found.emplace_back(i, value); });
+
+    ASSERT_EQ(3, found.size());
+    EXPECT_EQ(0, found[0].first);
+    EXPECT_EQ(Value(99), found[0].second);
+    EXPECT_EQ(1, found[1].first);
+    EXPECT_EQ(Value(0), found[1].second);
+    EXPECT_EQ(3, found[2].first);
+    EXPECT_EQ(Value(50), found[2].second);
+}
+
+TEST_F(TieredStorageTest, Reclaim) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 256 << 10, 64 << 10);
+
+    // Hot set is rewritten over and over, so most of the file is garbage and gets compacted
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 200; i++) {
+            ASSERT_TRUE(storage.Put(Key(i), Value(i + round)));
+        }
+    }
+    storage.Drain();
+    EXPECT_NE("0", Stat(storage, "tier_compactions"));
+    EXPECT_EQ("0", Stat(storage, "tier_dropped"));
+
+    std::string value;
+    for (int i = 0; i < 200; i++) {
+        ASSERT_TRUE(storage.Get(Key(i), value)) << i;
+        EXPECT_EQ(Value(i + 49), value);
+    }
+
+    // Way more unique data than fits: the oldest is dropped, the newest survives
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+    storage.Drain();
+    EXPECT_NE("0", Stat(storage, "tier_dropped"));
+    EXPECT_FALSE(storage.Get(Key(200), value));
+    ASSERT_TRUE(storage.Get(Key(9900), value));
+    EXPECT_EQ(Value(9900), value);
+}
+
+TEST_F(TieredStorageTest, ForEach) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 1 << 20, 64 << 10);
+
+    for (int i = 0; i < 200; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+    storage.Drain();
+
+    std::vector<int> seen(200, 0);
+    storage.Freeze([&storage, &seen]() {
+        storage.ForEach([&seen](const std::string &key, const std::string &value) {
+            int i = std::stoi(key.substr(3));
+            EXPECT_EQ(Value(i), value);
+            seen[i]++;
+        });
+    });
+    for (int i = 0; i < 200; i++) {
+        EXPECT_EQ(1, seen[i]) << i;
+    }
+}
+
+TEST_F(TieredStorageTest, Concurrent) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(8192);
+    TieredStorage storage(memory, path, 512 << 10, 64 << 10);
+
+    const int keys = 1000;
+    for (int i = 0; i < keys; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+
+    // Each key only ever has value derived from it, so any hit must match
+    std::atomic<int> errors(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&storage, &errors, t]() {
+            std::string value;
+            for (int n = 0; n < 5000; n++) {
+                int i = (n * 7919 + t * 104729) % keys;
+                if (t % 2 == 0) {
+                    storage.Put(Key(i), Value(i));
+                } else if (storage.Get(Key(i), value) && value != Value(i)) {
+                    errors++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    storage.Drain();
+    EXPECT_EQ(0, errors.load());
+}
+
+TEST_F(TieredStorageTest, NoMissesWhilePromoting) {
+    auto memory = std::make_shared<ThreadSafeSimplLRU>(4096);
+    TieredStorage storage(memory, path, 1 << 20, 64 << 10);
+
+    // Disk tier is large enough to never drop anything, so each key must be found in one of the tiers
+    const int keys = 200;
+    for (int i = 0; i < keys; i++) {
+        ASSERT_TRUE(storage.Put(Key(i), Value(i)));
+    }
+
+    // Reads keep promoting keys, which spills others to disk
+    std::atomic<int> misses(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&storage, &misses, t]() {
+            std::string value;
+            for (int n = 0; n < 20000; n++) {
+                int i = (n * 7919 + t * 104729) % keys;
+                if (!storage.Get(Key(i), value)) {
+                    misses++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    storage.Drain();
+    EXPECT_EQ(0, misses.load());
+    EXPECT_NE("0", Stat(storage, "tier_promotions"));
+}